@@ -0,0 +1,120 @@
+/*
+ * CLIENT RECORD SCHEMA
+ *
+ * The one definition of the bank account record, shared by tcopab.c,
+ * version1.c, version2.c and version3.c. All four programs read and
+ * write the same fixed-size records (credit.dat, accounts.dat), so they
+ * must agree on the layout byte for byte.
+ *
+ * The fields are listed once, in CLIENT_FIELDS, as an "X-macro": a
+ * macro that takes other macros as arguments and applies them to every
+ * field. Each expansion below generates one thing from the list:
+ *
+ *   struct client_data         the record itself
+ *   CLIENT_RECORD(...)         a designated initializer for it
+ *   CLIENT_OFFSET_<field>      byte offset of each field (compile-time constant)
+ *   CLIENT_PACKED_SIZE         record size without padding
+ *   client_data_pack/unpack    copy a record to/from its packed form
+ *   client_<field>()           typed read accessor
+ *   client_set_<field>()       typed write accessor (text is truncated and terminated)
+ *
+ * Adding a field means adding one line to CLIENT_FIELDS. Code that
+ * builds records with CLIENT_RECORD or the accessors keeps compiling
+ * unchanged. The accessors are static inline functions that the
+ * compiler turns into plain loads and stores.
+ *
+ * The data files address records by position, so the record size is
+ * part of their format. The layout checks at the end stop a change that
+ * would silently make existing files unreadable: a new field has to fit
+ * the existing size (as 'format' and 'version' fit the former padding),
+ * or it goes into an extension record that the 'format' byte points to
+ * (see SCHEMA EVOLUTION in version3.c).
+ */
+
+#ifndef CLIENT_SCHEMA_H
+#define CLIENT_SCHEMA_H
+
+#include <stddef.h>
+#include <string.h>
+
+/*
+ * CLIENT_FIELDS(SCALAR, TEXT)
+ *
+ *   SCALAR(type, name)   a number stored as 'type'
+ *   TEXT(name, size)     a NUL-terminated string in a char[size]
+ */
+#define CLIENT_FIELDS(SCALAR, TEXT) \
+    SCALAR(unsigned int, acct_num)     /* Account number (1-100) */ \
+    TEXT(last_name, 15)                /* Last name (14 chars + \0) */ \
+    TEXT(first_name, 10)               /* First name (9 chars + \0) */ \
+    SCALAR(unsigned char, format)      /* Record format: 0 = base, 1 = has an extension (version3.c); was padding */ \
+    SCALAR(unsigned short, version)    /* Bumped by every update (fills former padding) */ \
+    SCALAR(double, balance)            /* Account balance */
+
+/* The record */
+#define CLIENT_STRUCT_SCALAR(type, name) type name;
+#define CLIENT_STRUCT_TEXT(name, size) char name[size];
+
+struct client_data {
+    CLIENT_FIELDS(CLIENT_STRUCT_SCALAR, CLIENT_STRUCT_TEXT)
+};
+
+/* Initializer naming its fields, so it stays valid when fields are added */
+#define CLIENT_RECORD(acct, last, first, amount) \
+    {.acct_num = (acct), .last_name = last, .first_name = first, .balance = (amount)}
+
+/* Field offsets: CLIENT_OFFSET_acct_num, CLIENT_OFFSET_last_name, ... */
+#define CLIENT_OFFSET_SCALAR(type, name) CLIENT_OFFSET_##name = offsetof(struct client_data, name),
+#define CLIENT_OFFSET_TEXT(name, size) CLIENT_OFFSET_##name = offsetof(struct client_data, name),
+
+enum client_field_offset {
+    CLIENT_FIELDS(CLIENT_OFFSET_SCALAR, CLIENT_OFFSET_TEXT)
+};
+
+/* Packed form: the fields back to back in host byte order, no padding */
+#define CLIENT_SIZE_SCALAR(type, name) + sizeof(type)
+#define CLIENT_SIZE_TEXT(name, size) + (size)
+#define CLIENT_PACKED_SIZE (0 CLIENT_FIELDS(CLIENT_SIZE_SCALAR, CLIENT_SIZE_TEXT))
+
+#define CLIENT_PACK_SCALAR(type, name) memcpy(out, &client->name, sizeof(type)); out += sizeof(type);
+#define CLIENT_PACK_TEXT(name, size) memcpy(out, client->name, (size)); out += (size);
+#define CLIENT_UNPACK_SCALAR(type, name) memcpy(&client->name, in, sizeof(type)); in += sizeof(type);
+#define CLIENT_UNPACK_TEXT(name, size) \
+    memcpy(client->name, in, (size)); client->name[(size) - 1] = '\0'; in += (size);
+
+/*
+ * CLIENT_DATA_PACK / CLIENT_DATA_UNPACK
+ *
+ * Purpose: Copy a record to or from CLIENT_PACKED_SIZE bytes
+ * Returns: the byte after the packed record, for packing several in a row
+ */
+static inline unsigned char* client_data_pack(const struct client_data* client, unsigned char* out) {
+    CLIENT_FIELDS(CLIENT_PACK_SCALAR, CLIENT_PACK_TEXT)
+    return out;
+}
+
+static inline const unsigned char* client_data_unpack(struct client_data* client, const unsigned char* in) {
+    memset(client, 0, sizeof(*client));
+    CLIENT_FIELDS(CLIENT_UNPACK_SCALAR, CLIENT_UNPACK_TEXT)
+    return in;
+}
+
+/* Accessors: client_balance(c), client_set_balance(c, 12.5), client_last_name(c), ... */
+#define CLIENT_ACCESSOR_SCALAR(type, name) \
+    static inline type client_##name(const struct client_data* client) { return client->name; } \
+    static inline void client_set_##name(struct client_data* client, type value) { client->name = value; }
+#define CLIENT_ACCESSOR_TEXT(name, size) \
+    static inline const char* client_##name(const struct client_data* client) { return client->name; } \
+    static inline void client_set_##name(struct client_data* client, const char* value) { \
+        strncpy(client->name, value, (size) - 1); \
+        client->name[(size) - 1] = '\0'; \
+    }
+
+CLIENT_FIELDS(CLIENT_ACCESSOR_SCALAR, CLIENT_ACCESSOR_TEXT)
+
+/* The on-disk layout every existing data file was written with */
+_Static_assert(sizeof(struct client_data) == 40, "client_data must stay 40 bytes");
+_Static_assert(CLIENT_OFFSET_format == 29 && CLIENT_OFFSET_version == 30 && CLIENT_OFFSET_balance == 32,
+               "client_data fields must keep their file offsets");
+
+#endif /* CLIENT_SCHEMA_H */
@@ -1,972 +1,11747 @@
-/*
- * Version 03: CRUD Operations for Bank Account System
- * 
- * Learning Objectives:
- * 1. Implement Create, Read, Update, Delete operations
- * 2. Master interactive user input handling
- * 3. Learn data validation and sanitization techniques
- * 4. Practice error handling and user feedback
- * 5. Understand record management in binary files
- * 
- * New Concepts Covered:
- * - Interactive menu systems
- * - Input validation and sanitization
- * - Record searching and management
- * - User-friendly error messages
- * - Data integrity checks
- * - Transaction-like operations
- * 
- * Prerequisites: Complete Version 01 (Structures) and Version 02 (File Operations)
- */
-
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-
-/* Client data structure (from previous versions) */
-struct client_data {
-    unsigned int acct_num;  // Account number (1-100)
-    char last_name[15];     // Last name (14 chars + \0)
-    char first_name[10];    // First name (9 chars + \0)
-    double balance;         // Account balance
-};
-
-/* Constants */
-#define DATA_FILE "accounts.dat"
-#define MAX_ACCOUNTS 100
-#define RECORD_SIZE sizeof(struct client_data)
-#define MIN_ACCOUNT_NUM 1
-#define MAX_ACCOUNT_NUM 100
-
-/* Function Prototypes */
-/* CRUD Operations */
-int create_account(void);
-int read_account(void);
-int update_account(void);
-int delete_account(void);
-
-/* Core File Operations */
-FILE* open_data_file(const char* mode);
-int close_data_file(FILE* file_ptr);
-int write_client_to_file(FILE* file_ptr, const struct client_data* client, int position);
-int read_client_from_file(FILE* file_ptr, struct client_data* client, int position);
-int account_exists(unsigned int acct_num);
-
-/* Input Validation */
-unsigned int get_account_number(const char* prompt);
-double get_balance_input(const char* prompt);
-void get_name_input(char* buffer, int max_length, const char* prompt);
-void clear_input_buffer(void);
-int validate_account_number(unsigned int acct_num);
-int validate_name(const char* name);
-
-/* Display Functions */
-void display_client(const struct client_data* client);
-void display_all_accounts(void);
-void print_account_header(void);
-void print_account_row(const struct client_data* client);
-
-/* Utility Functions */
-void initialize_client(struct client_data* client, unsigned int acct_num,
-                      const char* last_name, const char* first_name, double balance);
-void initialize_data_file_if_needed(void);
-
-/* Test Functions */
-int test_crud_operations(void);
-int test_input_validation(void);
-int test_account_management(void);
-void run_all_tests(void);
-void demonstrate_crud_operations(void);
-
-/*
- * MAIN FUNCTION
- * Entry point for Version 03 - CRUD Operations
- */
-int main(void) {
-    printf("=== Bank Account System - Version 03: CRUD Operations ===\n\n");
-    
-    // Initialize data file if needed
-    initialize_data_file_if_needed();
-    
-    // Run tests (TDD approach)
-    printf("Running CRUD Tests...\n");
-    run_all_tests();
-    
-    // Demonstrate CRUD operations
-    printf("\n=== CRUD Operations Demonstration ===\n");
-    demonstrate_crud_operations();
-    
-    return 0;
-}
-
-/*
- * CREATE ACCOUNT (C in CRUD)
- * 
- * Purpose: Create a new bank account with user input
- * Returns: 1 on success, 0 on failure
- * 
- * Process:
- * 1. Get and validate account number
- * 2. Check if account already exists
- * 3. Get customer information
- * 4. Validate all inputs
- * 5. Write to file
- * 6. Confirm success
- */
-int create_account(void) {
-    printf("\n=== CREATE NEW ACCOUNT ===\n");
-    
-    // Get account number
-    unsigned int acct_num = get_account_number("Enter new account number (1-100): ");
-    if (acct_num == 0) {
-        printf("Invalid account number. Operation cancelled.\n");
-        return 0;
-    }
-    
-    // Check if account already exists
-    if (account_exists(acct_num)) {
-        printf("Error: Account #%u already exists!\n", acct_num);
-        printf("Use UPDATE operation to modify existing accounts.\n");
-        return 0;
-    }
-    
-    // Get customer information
-    char last_name[15], first_name[10];
-    double initial_balance;
-    
-    get_name_input(last_name, sizeof(last_name), "Enter last name: ");
-    get_name_input(first_name, sizeof(first_name), "Enter first name: ");
-    initial_balance = get_balance_input("Enter initial balance: ");
-    
-    // Validate all inputs
-    if (!validate_name(last_name) || !validate_name(first_name)) {
-        printf("Error: Invalid name format. Names cannot be empty.\n");
-        return 0;
-    }
-    
-    // Create client structure
-    struct client_data new_client;
-    initialize_client(&new_client, acct_num, last_name, first_name, initial_balance);
-    
-    // Write to file
-    FILE* file_ptr = open_data_file("rb");
-    if (file_ptr == NULL) return 0;
-    
-    struct client_data client;
-    int position = acct_num - 1;
-    int success = read_client_from_file(file_ptr, &client, position);
-    close_data_file(file_ptr);
-    
-    return (success && client.acct_num != 0);
-}
-
-/*
- * INPUT VALIDATION FUNCTIONS
- * 
- * These functions handle user input safely and validate data
- */
-
-/*
- * GET_ACCOUNT_NUMBER
- * 
- * Purpose: Get and validate account number from user
- * Parameters: prompt - message to display to user
- * Returns: valid account number (1-100) or 0 on error
- */
-unsigned int get_account_number(const char* prompt) {
-    unsigned int acct_num;
-    
-    printf("%s", prompt);
-    
-    if (scanf("%u", &acct_num) != 1) {
-        printf("Error: Please enter a valid number.\n");
-        clear_input_buffer();
-        return 0;
-    }
-    clear_input_buffer();
-    
-    if (!validate_account_number(acct_num)) {
-        printf("Error: Account number must be between %d and %d.\n", 
-               MIN_ACCOUNT_NUM, MAX_ACCOUNT_NUM);
-        return 0;
-    }
-    
-    return acct_num;
-}
-
-/*
- * GET_BALANCE_INPUT
- * 
- * Purpose: Get and validate balance/transaction amount from user
- * Parameters: prompt - message to display to user
- * Returns: entered balance amount
- */
-double get_balance_input(const char* prompt) {
-    double amount;
-    
-    printf("%s", prompt);
-    
-    if (scanf("%lf", &amount) != 1) {
-        printf("Error: Please enter a valid amount.\n");
-        clear_input_buffer();
-        return 0.0;
-    }
-    clear_input_buffer();
-    
-    return amount;
-}
-
-/*
- * GET_NAME_INPUT
- * 
- * Purpose: Get and validate name input from user
- * Parameters: 
- *   - buffer: where to store the input
- *   - max_length: maximum length of input
- *   - prompt: message to display
- */
-void get_name_input(char* buffer, int max_length, const char* prompt) {
-    printf("%s", prompt);
-    
-    if (fgets(buffer, max_length, stdin) != NULL) {
-        // Remove newline if present
-        size_t len = strlen(buffer);
-        if (len > 0 && buffer[len - 1] == '\n') {
-            buffer[len - 1] = '\0';
-        }
-        
-        // Trim leading and trailing spaces
-        char* start = buffer;
-        while (isspace(*start)) start++;
-        
-        char* end = start + strlen(start) - 1;
-        while (end > start && isspace(*end)) end--;
-        end[1] = '\0';
-        
-        // Move trimmed string to beginning of buffer
-        if (start != buffer) {
-            memmove(buffer, start, strlen(start) + 1);
-        }
-    } else {
-        buffer[0] = '\0';  // Empty string on error
-    }
-}
-
-/*
- * CLEAR_INPUT_BUFFER
- * 
- * Purpose: Clear any remaining characters from input buffer
- * This prevents issues with subsequent input operations
- */
-void clear_input_buffer(void) {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
-}
-
-/*
- * VALIDATE_ACCOUNT_NUMBER
- * 
- * Purpose: Check if account number is in valid range
- * Parameters: acct_num - account number to validate
- * Returns: 1 if valid, 0 if invalid
- */
-int validate_account_number(unsigned int acct_num) {
-    return (acct_num >= MIN_ACCOUNT_NUM && acct_num <= MAX_ACCOUNT_NUM);
-}
-
-/*
- * VALIDATE_NAME
- * 
- * Purpose: Check if name is valid (not empty, reasonable length)
- * Parameters: name - string to validate
- * Returns: 1 if valid, 0 if invalid
- */
-int validate_name(const char* name) {
-    if (name == NULL) return 0;
-    
-    size_t len = strlen(name);
-    
-    // Check if empty or too short
-    if (len == 0) return 0;
-    
-    // Check for valid characters (letters, spaces, hyphens, apostrophes)
-    for (size_t i = 0; i < len; i++) {
-        char c = name[i];
-        if (!isalpha(c) && c != ' ' && c != '-' && c != '\'') {
-            return 0;
-        }
-    }
-    
-    return 1;
-}
-
-/*
- * DISPLAY FUNCTIONS
- * 
- * Functions for formatting and displaying account information
- */
-
-void display_client(const struct client_data* client) {
-    if (client == NULL) {
-        printf("Error: Cannot display null client data.\n");
-        return;
-    }
-    
-    printf("Account Number: %u\n", client->acct_num);
-    printf("Customer Name:  %s, %s\n", client->last_name, client->first_name);
-    printf("Account Balance: $%.2f\n", client->balance);
-    
-    // Additional status information
-    if (client->balance < 0) {
-        printf("Status: OVERDRAWN (%.2f)\n", -client->balance);
-    } else if (client->balance == 0) {
-        printf("Status: ZERO BALANCE\n");
-    } else {
-        printf("Status: ACTIVE\n");
-    }
-    
-    printf("-------------------------------------------\n");
-}
-
-void display_all_accounts(void) {
-    printf("\n=== ALL ACCOUNTS REPORT ===\n");
-    
-    FILE* file_ptr = open_data_file("rb");
-    if (file_ptr == NULL) {
-        printf("Error: Could not open data file for reading.\n");
-        return;
-    }
-    
-    print_account_header();
-    
-    struct client_data client;
-    int total_accounts = 0;
-    double total_balance = 0.0;
-    int overdrawn_accounts = 0;
-    
-    for (int i = 0; i < MAX_ACCOUNTS; i++) {
-        if (read_client_from_file(file_ptr, &client, i) && client.acct_num != 0) {
-            print_account_row(&client);
-            total_accounts++;
-            total_balance += client.balance;
-            if (client.balance < 0) overdrawn_accounts++;
-        }
-    }
-    
-    close_data_file(file_ptr);
-    
-    // Summary statistics
-    printf("=======================================================\n");
-    printf("Total Accounts: %d\n", total_accounts);
-    printf("Total Balance:  $%.2f\n", total_balance);
-    printf("Overdrawn:      %d accounts\n", overdrawn_accounts);
-    if (total_accounts > 0) {
-        printf("Average Balance: $%.2f\n", total_balance / total_accounts);
-    }
-}
-
-void print_account_header(void) {
-    printf("%-6s %-15s %-10s %12s %10s\n", 
-           "Acct#", "Last Name", "First Name", "Balance", "Status");
-    printf("=======================================================\n");
-}
-
-void print_account_row(const struct client_data* client) {
-    if (client == NULL) return;
-    
-    const char* status;
-    if (client->balance < 0) {
-        status = "OVERDRAWN";
-    } else if (client->balance == 0) {
-        status = "ZERO";
-    } else {
-        status = "ACTIVE";
-    }
-    
-    printf("%-6u %-15s %-10s %12.2f %10s\n",
-           client->acct_num, client->last_name, client->first_name,
-           client->balance, status);
-}
-
-/*
- * UTILITY FUNCTIONS
- */
-
-void initialize_client(struct client_data* client, unsigned int acct_num,
-                      const char* last_name, const char* first_name, double balance) {
-    if (client == NULL) return;
-    
-    client->acct_num = acct_num;
-    client->balance = balance;
-    
-    // Safe string copying
-    if (last_name != NULL) {
-        strncpy(client->last_name, last_name, sizeof(client->last_name) - 1);
-        client->last_name[sizeof(client->last_name) - 1] = '\0';
-    } else {
-        client->last_name[0] = '\0';
-    }
-    
-    if (first_name != NULL) {
-        strncpy(client->first_name, first_name, sizeof(client->first_name) - 1);
-        client->first_name[sizeof(client->first_name) - 1] = '\0';
-    } else {
-        client->first_name[0] = '\0';
-    }
-}
-
-void initialize_data_file_if_needed(void) {
-    // Check if file exists
-    FILE* test_file = fopen(DATA_FILE, "rb");
-    if (test_file != NULL) {
-        fclose(test_file);
-        printf("Data file '%s' found.\n", DATA_FILE);
-        return;
-    }
-    
-    // Create new file
-    printf("Creating new data file '%s'...\n", DATA_FILE);
-    FILE* file_ptr = fopen(DATA_FILE, "wb");
-    if (file_ptr == NULL) {
-        printf("Error: Could not create data file.\n");
-        return;
-    }
-    
-    // Initialize with empty records
-    struct client_data empty_client = {0, "", "", 0.0};
-    for (int i = 0; i < MAX_ACCOUNTS; i++) {
-        fwrite(&empty_client, RECORD_SIZE, 1, file_ptr);
-    }
-    
-    fclose(file_ptr);
-    printf("Data file initialized with %d empty slots.\n", MAX_ACCOUNTS);
-}
-
-/*
- * DEMONSTRATION FUNCTION
- * 
- * Purpose: Show CRUD operations in action with sample data
- */
-void demonstrate_crud_operations(void) {
-    printf("\n1. Creating Sample Accounts (CREATE):\n");
-    
-    // Sample data for demonstration
-    struct sample_account {
-        unsigned int acct_num;
-        const char* last_name;
-        const char* first_name;
-        double balance;
-    } samples[] = {
-        {1, "Smith", "John", 1500.75},
-        {5, "Johnson", "Mary", -250.50},
-        {10, "Williams", "Bob", 3200.00},
-        {25, "Davis", "Alice", 0.00}
-    };
-    
-    int num_samples = sizeof(samples) / sizeof(samples[0]);
-    
-    FILE* file_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) return;
-    
-    for (int i = 0; i < num_samples; i++) {
-        struct client_data client;
-        initialize_client(&client, samples[i].acct_num, samples[i].last_name,
-                         samples[i].first_name, samples[i].balance);
-        
-        int position = samples[i].acct_num - 1;
-        if (write_client_to_file(file_ptr, &client, position)) {
-            printf("✅ Created account #%u for %s %s\n", 
-                   client.acct_num, client.first_name, client.last_name);
-        }
-    }
-    
-    close_data_file(file_ptr);
-    
-    printf("\n2. Reading Account Information (READ):\n");
-    file_ptr = open_data_file("rb");
-    if (file_ptr != NULL) {
-        struct client_data client;
-        if (read_client_from_file(file_ptr, &client, 0) && client.acct_num != 0) {
-            printf("Account #1 details:\n");
-            display_client(&client);
-        }
-        close_data_file(file_ptr);
-    }
-    
-    printf("\n3. Updating Account Balance (UPDATE):\n");
-    file_ptr = open_data_file("rb+");
-    if (file_ptr != NULL) {
-        struct client_data client;
-        if (read_client_from_file(file_ptr, &client, 4) && client.acct_num != 0) {
-            printf("Before update:\n");
-            display_client(&client);
-            
-            // Simulate a deposit
-            client.balance += 500.0;
-            
-            if (write_client_to_file(file_ptr, &client, 4)) {
-                printf("After $500 deposit:\n");
-                display_client(&client);
-            }
-        }
-        close_data_file(file_ptr);
-    }
-    
-    printf("\n4. Displaying All Accounts:\n");
-    display_all_accounts();
-    
-    printf("\n5. Account Existence Check:\n");
-    printf("Account #1 exists: %s\n", account_exists(1) ? "Yes" : "No");
-    printf("Account #50 exists: %s\n", account_exists(50) ? "Yes" : "No");
-}
-
-/*
- * TESTING FUNCTIONS
- * Unit tests for CRUD operations
- */
-
-int test_crud_operations(void) {
-    printf("Test 1: CRUD Operations... ");
-    
-    // Test CREATE
-    FILE* file_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) {
-        printf("FAILED - Could not open file\n");
-        return 0;
-    }
-    
-    struct client_data test_client;
-    initialize_client(&test_client, 99, "TestLast", "TestFirst", 100.0);
-    
-    if (!write_client_to_file(file_ptr, &test_client, 98)) {
-        printf("FAILED - Could not create record\n");
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    // Test READ
-    struct client_data read_client;
-    if (!read_client_from_file(file_ptr, &read_client, 98)) {
-        printf("FAILED - Could not read record\n");
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    // Test UPDATE
-    read_client.balance += 50.0;
-    if (!write_client_to_file(file_ptr, &read_client, 98)) {
-        printf("FAILED - Could not update record\n");
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    // Test DELETE (write empty record)
-    struct client_data empty_client = {0, "", "", 0.0};
-    if (!write_client_to_file(file_ptr, &empty_client, 98)) {
-        printf("FAILED - Could not delete record\n");
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    close_data_file(file_ptr);
-    printf("PASSED\n");
-    return 1;
-}
-
-int test_input_validation(void) {
-    printf("Test 2: Input Validation... ");
-    
-    // Test account number validation
-    if (!validate_account_number(50) || validate_account_number(0) || validate_account_number(101)) {
-        printf("FAILED - Account number validation\n");
-        return 0;
-    }
-    
-    // Test name validation
-    if (!validate_name("Smith") || validate_name("") || validate_name("123")) {
-        printf("FAILED - Name validation\n");
-        return 0;
-    }
-    
-    printf("PASSED\n");
-    return 1;
-}
-
-int test_account_management(void) {
-    printf("Test 3: Account Management... ");
-    
-    // Create test account
-    FILE* file_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) {
-        printf("FAILED - Could not open file\n");
-        return 0;
-    }
-    
-    struct client_data test_account = {77, "Manager", "Test", 200.0};
-    write_client_to_file(file_ptr, &test_account, 76);
-    close_data_file(file_ptr);
-    
-    // Test account_exists function
-    if (!account_exists(77)) {
-        printf("FAILED - account_exists returned false for existing account\n");
-        return 0;
-    }
-    
-    if (account_exists(88)) {  // Should not exist
-        printf("FAILED - account_exists returned true for non-existing account\n");
-        return 0;
-    }
-    
-    printf("PASSED\n");
-    return 1;
-}
-
-void run_all_tests(void) {
-    int total_tests = 0;
-    int passed_tests = 0;
-    
-    total_tests++; passed_tests += test_crud_operations();
-    total_tests++; passed_tests += test_input_validation();
-    total_tests++; passed_tests += test_account_management();
-    
-    printf("\nTest Results: %d/%d tests passed\n", passed_tests, total_tests);
-    
-    if (passed_tests == total_tests) {
-        printf("✅ All CRUD tests passed! Ready for Version 04.\n");
-    } else {
-        printf("❌ Some tests failed. Review CRUD operations before proceeding.\n");
-    }
-}
-
-/*
- * LEARNING EXERCISES FOR STUDENTS:
- * 
- * 1. Easy Level:
- *    - Add a search function to find accounts by name
- *    - Implement account number auto-generation
- *    - Add input validation for minimum balance requirements
- * 
- * 2. Medium Level:
- *    - Add transaction history logging
- *    - Implement account transfer functionality
- *    - Create batch operations (create multiple accounts from file)
- * 
- * 3. Advanced Level:
- *    - Add account locking/unlocking features
- *    - Implement data backup and restore
- *    - Create audit trail for all operations
- * 
- * DEBUGGING TIPS:
- * - Always validate input before processing
- * - Check return values of all file operations
- * - Use meaningful error messages for users
- * - Test edge cases (empty names, zero balances, etc.)
- * 
- * NEXT VERSION PREVIEW:
- * In Version 04, we'll learn:
- * - Interactive menu systems
- * - Program flow control
- * - User experience design
- * - Complete application integration
- */_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) {
-        printf("Error: Could not open data file for writing.\n");
-        return 0;
-    }
-    
-    int position = acct_num - 1;  // Convert to 0-based index
-    int success = write_client_to_file(file_ptr, &new_client, position);
-    close_data_file(file_ptr);
-    
-    if (success) {
-        printf("\n✅ Account created successfully!\n");
-        printf("Account Details:\n");
-        display_client(&new_client);
-        return 1;
-    } else {
-        printf("❌ Error: Could not create account. Please try again.\n");
-        return 0;
-    }
-}
-
-/*
- * CORE FILE OPERATIONS
- * (Simplified versions from Version 02)
- */
-
-FILE* open_data_file(const char* mode) {
-    FILE* file_ptr = fopen(DATA_FILE, mode);
-    if (file_ptr == NULL) {
-        printf("Error: Could not open file '%s' in mode '%s'\n", DATA_FILE, mode);
-    }
-    return file_ptr;
-}
-
-int close_data_file(FILE* file_ptr) {
-    if (file_ptr == NULL) return -1;
-    return fclose(file_ptr);
-}
-
-int write_client_to_file(FILE* file_ptr, const struct client_data* client, int position) {
-    if (file_ptr == NULL || client == NULL || position < 0 || position >= MAX_ACCOUNTS) {
-        return 0;
-    }
-    
-    long file_position = position * RECORD_SIZE;
-    if (fseek(file_ptr, file_position, SEEK_SET) != 0) return 0;
-    
-    return (fwrite(client, RECORD_SIZE, 1, file_ptr) == 1);
-}
-
-int read_client_from_file(FILE* file_ptr, struct client_data* client, int position) {
-    if (file_ptr == NULL || client == NULL || position < 0 || position >= MAX_ACCOUNTS) {
-        return 0;
-    }
-    
-    long file_position = position * RECORD_SIZE;
-    if (fseek(file_ptr, file_position, SEEK_SET) != 0) return 0;
-    
-    return (fread(client, RECORD_SIZE, 1, file_ptr) == 1);
-}
-
-/*
- * ACCOUNT_EXISTS
- * 
- * Purpose: Check if an account number is already in use
- * Parameters: acct_num - account number to check
- * Returns: 1 if exists, 0 if not exists or error
- */
-int account_exists(unsigned int acct_num) {
-    if (!validate_account_number(acct_num)) return 0;
-    
-    FILE* file
-
-/*
- * READ ACCOUNT (R in CRUD)
- * 
- * Purpose: Display account information for a specific account
- * Returns: 1 on success, 0 on failure
- */
-int read_account(void) {
-    printf("\n=== READ ACCOUNT INFORMATION ===\n");
-    
-    unsigned int acct_num = get_account_number("Enter account number to view (1-100): ");
-    if (acct_num == 0) {
-        printf("Invalid account number. Operation cancelled.\n");
-        return 0;
-    }
-    
-    FILE* file_ptr = open_data_file("rb");
-    if (file_ptr == NULL) {
-        printf("Error: Could not open data file for reading.\n");
-        return 0;
-    }
-    
-    struct client_data client;
-    int position = acct_num - 1;
-    int success = read_client_from_file(file_ptr, &client, position);
-    close_data_file(file_ptr);
-    
-    if (success && client.acct_num != 0) {
-        printf("\n✅ Account found!\n");
-        display_client(&client);
-        return 1;
-    } else {
-        printf("❌ Account #%u not found or is empty.\n", acct_num);
-        return 0;
-    }
-}
-
-/*
- * UPDATE ACCOUNT (U in CRUD)
- * 
- * Purpose: Modify existing account information
- * Returns: 1 on success, 0 on failure
- * 
- * Update Options:
- * 1. Add/subtract from balance (transactions)
- * 2. Update customer names
- * 3. Complete account information update
- */
-int update_account(void) {
-    printf("\n=== UPDATE ACCOUNT ===\n");
-    
-    unsigned int acct_num = get_account_number("Enter account number to update (1-100): ");
-    if (acct_num == 0) {
-        printf("Invalid account number. Operation cancelled.\n");
-        return 0;
-    }
-    
-    // Read existing account
-    FILE* file_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) {
-        printf("Error: Could not open data file for updating.\n");
-        return 0;
-    }
-    
-    struct client_data client;
-    int position = acct_num - 1;
-    int success = read_client_from_file(file_ptr, &client, position);
-    
-    if (!success || client.acct_num == 0) {
-        printf("❌ Account #%u not found. Use CREATE to add new accounts.\n", acct_num);
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    printf("\nCurrent Account Information:\n");
-    display_client(&client);
-    
-    // Update menu
-    printf("\nUpdate Options:\n");
-    printf("1. Update balance (add/subtract transaction)\n");
-    printf("2. Update customer names\n");
-    printf("3. Update all information\n");
-    printf("Enter choice (1-3): ");
-    
-    int choice;
-    if (scanf("%d", &choice) != 1) {
-        printf("Invalid input. Operation cancelled.\n");
-        clear_input_buffer();
-        close_data_file(file_ptr);
-        return 0;
-    }
-    clear_input_buffer();
-    
-    switch (choice) {
-        case 1: {
-            // Balance update (transaction)
-            double transaction = get_balance_input("Enter transaction amount (+credit/-debit): ");
-            double old_balance = client.balance;
-            client.balance += transaction;
-            
-            printf("\nTransaction Summary:\n");
-            printf("Previous Balance: $%.2f\n", old_balance);
-            printf("Transaction:      $%.2f\n", transaction);
-            printf("New Balance:      $%.2f\n", client.balance);
-            break;
-        }
-        case 2: {
-            // Name update
-            printf("Current: %s, %s\n", client.last_name, client.first_name);
-            get_name_input(client.last_name, sizeof(client.last_name), "Enter new last name: ");
-            get_name_input(client.first_name, sizeof(client.first_name), "Enter new first name: ");
-            
-            if (!validate_name(client.last_name) || !validate_name(client.first_name)) {
-                printf("Error: Invalid name format. Update cancelled.\n");
-                close_data_file(file_ptr);
-                return 0;
-            }
-            break;
-        }
-        case 3: {
-            // Complete update
-            get_name_input(client.last_name, sizeof(client.last_name), "Enter new last name: ");
-            get_name_input(client.first_name, sizeof(client.first_name), "Enter new first name: ");
-            client.balance = get_balance_input("Enter new balance: ");
-            
-            if (!validate_name(client.last_name) || !validate_name(client.first_name)) {
-                printf("Error: Invalid name format. Update cancelled.\n");
-                close_data_file(file_ptr);
-                return 0;
-            }
-            break;
-        }
-        default:
-            printf("Invalid choice. Operation cancelled.\n");
-            close_data_file(file_ptr);
-            return 0;
-    }
-    
-    // Write updated record
-    success = write_client_to_file(file_ptr, &client, position);
-    close_data_file(file_ptr);
-    
-    if (success) {
-        printf("\n✅ Account updated successfully!\n");
-        printf("Updated Account Information:\n");
-        display_client(&client);
-        return 1;
-    } else {
-        printf("❌ Error: Could not update account. Changes not saved.\n");
-        return 0;
-    }
-}
-
-/*
- * DELETE ACCOUNT (D in CRUD)
- * 
- * Purpose: Remove an account from the system
- * Returns: 1 on success, 0 on failure
- * 
- * Safety Features:
- * - Shows account before deletion
- * - Requires confirmation
- * - Warns about balance if non-zero
- */
-int delete_account(void) {
-    printf("\n=== DELETE ACCOUNT ===\n");
-    
-    unsigned int acct_num = get_account_number("Enter account number to delete (1-100): ");
-    if (acct_num == 0) {
-        printf("Invalid account number. Operation cancelled.\n");
-        return 0;
-    }
-    
-    // Read existing account
-    FILE* file_ptr = open_data_file("rb+");
-    if (file_ptr == NULL) {
-        printf("Error: Could not open data file for deletion.\n");
-        return 0;
-    }
-    
-    struct client_data client;
-    int position = acct_num - 1;
-    int success = read_client_from_file(file_ptr, &client, position);
-    
-    if (!success || client.acct_num == 0) {
-        printf("❌ Account #%u not found or already empty.\n", acct_num);
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    printf("\nAccount to be deleted:\n");
-    display_client(&client);
-    
-    // Warning for non-zero balance
-    if (client.balance != 0.0) {
-        printf("⚠️  WARNING: This account has a balance of $%.2f\n", client.balance);
-        printf("Deleting will remove this balance permanently.\n");
-    }
-    
-    // Confirmation
-    printf("\nAre you sure you want to delete this account? (y/N): ");
-    char confirmation;
-    if (scanf(" %c", &confirmation) != 1) {
-        printf("Invalid input. Deletion cancelled.\n");
-        clear_input_buffer();
-        close_data_file(file_ptr);
-        return 0;
-    }
-    clear_input_buffer();
-    
-    if (tolower(confirmation) != 'y') {
-        printf("Deletion cancelled by user.\n");
-        close_data_file(file_ptr);
-        return 0;
-    }
-    
-    // Create empty record for deletion
-    struct client_data empty_client = {0, "", "", 0.0};
-    success = write_client_to_file(file_ptr, &empty_client, position);
-    close_data_file(file_ptr);
-    
-    if (success) {
-        printf("\n✅ Account #%u deleted successfully!\n", acct_num);
-        return 1;
-    } else {
-        printf("❌ Error: Could not delete account. Please try again.\n");
-        return 0;
-    }
-}
\ No newline at end of file
+/*
+ * Version 03: CRUD Operations for Bank Account System
+ * 
+ * Learning Objectives:
+ * 1. Implement Create, Read, Update, Delete operations
+ * 2. Master interactive user input handling
+ * 3. Learn data validation and sanitization techniques
+ * 4. Practice error handling and user feedback
+ * 5. Understand record management in binary files
+ * 
+ * New Concepts Covered:
+ * - Interactive menu systems
+ * - Input validation and sanitization
+ * - Record searching and management
+ * - User-friendly error messages
+ * - Data integrity checks
+ * - Transaction-like operations
+ * - Transaction history and monthly statements
+ * - Multi-threaded batch jobs (pipelines with bounded queues)
+ * - Bulk import from text files (memory mapping, hand-written parsing)
+ * - Lock-free single-producer/single-consumer queues
+ * - Work-stealing thread pools
+ * - Sequence locks for lock-free readers
+ * - Shared memory between processes
+ * - Arena (bump-pointer) allocation
+ * 
+ * Prerequisites: Complete Version 01 (Structures) and Version 02 (File Operations)
+ * 
+ * Compile: gcc -std=c11 -Wall -O2 -pthread version3.c -o version3
+ */
+
+#define _GNU_SOURCE  // POSIX threads, clock_gettime, localtime_r, mmap
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <errno.h>
+#ifdef __SSE2__
+#include <emmintrin.h>  // SSE2 intrinsics for byte scanning
+#endif
+
+/* Client data structure (shared with the previous versions) */
+#include "client_schema.h"
+
+/* Constants */
+#define DATA_FILE "accounts.dat"
+#define MAX_ACCOUNTS 100
+#define RECORD_SIZE sizeof(struct client_data)
+#define MIN_ACCOUNT_NUM 1
+#define MAX_ACCOUNT_NUM 100
+
+/* Result of a compare-on-write (write_client_if_unchanged) */
+#define UPDATE_OK 0
+#define UPDATE_CONFLICT 1             // Record changed since it was read
+#define UPDATE_FAILED 2               // I/O error
+#define UPDATE_RETRY_LIMIT 5          // Automatic retries of a conflicting balance change
+
+/* Record formats (client_data.format) - see SCHEMA EVOLUTION */
+#define RECORD_FORMAT_BASE 0          // The 40-byte record only
+#define RECORD_FORMAT_EXTENDED 1      // Plus a client_extension at the same position in the extension file
+#define EXTENSION_SUFFIX ".ext"       // Extension file name: data file name + this
+#define ACCOUNT_STATUS_ACTIVE 0
+#define ACCOUNT_STATUS_DORMANT 1
+#define ACCOUNT_STATUS_CLOSED 2
+#define MIGRATE_BATCH 64              // Records the migrator upgrades between pauses
+#define MIGRATE_PAUSE_MS 1            // Pause between batches, leaving the file to tellers
+
+/* Fields added after the 40-byte layout was fixed */
+struct client_extension {
+    unsigned int acct_num;            // Same as the base record (a stale extension does not match)
+    unsigned char status;             // ACCOUNT_STATUS_*
+    char currency[3];                 // ISO 4217 code, e.g. "USD" (not NUL-terminated)
+    int open_date;                    // YYYYMMDD, 0 = opened before extensions existed
+    unsigned int reserved;            // Room for a small field without resizing the file
+    long long overdraft_limit_cents;  // How far below zero the balance may go
+};
+
+_Static_assert(sizeof(struct client_extension) == 24, "extension records are 24 bytes on disk");
+
+/* Background migrator: upgrades base records to the extended format */
+struct schema_migrator {
+    const char* data_path;
+    long batch;                       // Records per batch
+    long pause_ms;                    // Pause after each batch
+    pthread_t thread;
+    atomic_int stopping;
+    long migrated;                    // Counters: read them after the migrator has finished
+    long conflicts;                   // Records skipped because a teller changed them first
+    long passes;
+    int ok;                           // 0 if the migrator stopped on an I/O error
+};
+
+/* Amount parsing results (parse_amount_cents) */
+#define AMOUNT_OK 0
+#define AMOUNT_EMPTY 1                // No digits
+#define AMOUNT_BAD_CHARACTER 2        // Anything but sign, digits, one '.' and blanks
+#define AMOUNT_TOO_MANY_DECIMALS 3    // More than two digits after the '.'
+#define AMOUNT_OUT_OF_RANGE 4         // More than MAX_AMOUNT_DIGITS whole digits
+#define MAX_AMOUNT_DIGITS 13          // Up to 9,999,999,999,999.99 - exact as a double
+
+/* Where parse_amounts_batch stopped */
+struct amount_error {
+    int status;             // AMOUNT_OK if every line parsed
+    long line;              // 1-based line of the bad amount
+    size_t position;        // 0-based character within that line
+};
+
+/* Transaction history record (one entry per balance change) */
+struct transaction_record {
+    unsigned int acct_num;  // Account the transaction belongs to
+    long long timestamp;    // Seconds since the epoch
+    double amount;          // Transaction amount (+credit/-debit)
+    double balance_after;   // Balance once the amount was applied
+};
+
+#define HISTORY_FILE "history.dat"
+#define STATEMENT_FILE "statements.txt"
+#define STATEMENT_QUEUE_SIZE 64     // Jobs in flight between two pipeline stages
+#define STATEMENT_READ_BATCH 256    // Records fetched per fread call
+
+/* Result counters shared by all batch jobs */
+struct batch_stats {
+    long records;           // Records (statements, rows, ...) processed
+    long rejected;          // Input rows skipped as invalid
+    double seconds;         // Wall-clock time of the whole job
+    long allocations;       // Arena allocations for temporaries
+    long mallocs;           // malloc calls behind them (arena blocks)
+};
+
+/* Bump-pointer arena for the temporaries of one batch or request */
+#define ARENA_BLOCK_SIZE (64 << 10)   // Default block size
+#define ARENA_ALIGNMENT 16            // Every allocation is aligned to this
+
+/* One malloc'd block; blocks are kept for reuse when the arena is reset */
+struct arena_block {
+    struct arena_block* next;
+    size_t size;            // Bytes in 'data'
+    size_t used;
+    _Alignas(ARENA_ALIGNMENT) char data[];
+};
+
+struct arena {
+    struct arena_block* first;
+    struct arena_block* current;
+    size_t block_size;
+    void* last;             // Newest allocation (can grow in place)
+    long allocations;       // arena_alloc/arena_grow calls since arena_init
+    long mallocs;           // Blocks malloc'd since arena_init
+};
+
+/* Object pools: recycled fixed-size objects, one cache per thread */
+#define POOL_CACHES 64                // Threads (cache indexes) one pool serves
+#define POOL_REFILL 32                // Objects malloc'd together when a cache runs dry
+
+/* Header in front of every pooled object */
+struct pool_object {
+    _Alignas(16) struct pool_object* next;
+    int owner;              // Cache the object goes back to
+};
+
+/* One thread's cache. Only its thread touches the first line; other threads only push onto 'returned'. */
+struct pool_cache {
+    _Alignas(64) struct pool_object* free_list;
+    long gets;
+    long hits;              // Gets served without malloc
+    long puts;
+    long remote_puts;       // Puts of objects owned by another cache
+    _Alignas(64) _Atomic(struct pool_object*) returned;
+};
+
+struct object_pool {
+    size_t object_size;
+    struct pool_cache caches[POOL_CACHES];
+    pthread_mutex_t blocks_lock;
+    void** blocks;          // Every malloc'd block, for object_pool_destroy
+    long block_count;
+    long block_capacity;
+};
+
+/* Totals over all caches (object_pool_stats) */
+struct pool_stats {
+    long gets;
+    long hits;
+    long puts;
+    long remote_puts;
+    long mallocs;
+};
+
+#define MAX_IMPORT_ACCOUNT 100000000  // Highest account number an import row may carry
+#define IMPORT_BATCH 4096             // Records per fwrite during import
+#define IMPORT_CHUNK_BYTES (4 << 20)  // Input bytes parsed by one worker at a time
+#define NAME_BATCH 1024               // Names validated per normalize_names_batch call
+
+/* One parsed input line; client.acct_num is 0 for a malformed row */
+struct import_row {
+    struct client_data client;
+    long line;              // Line index within its chunk (0-based)
+};
+
+/* A slice of the import file parsed by one worker */
+struct import_chunk {
+    const char* start;      // First byte (always the start of a line)
+    const char* end;        // One past the last byte (just after a '\n' or EOF)
+    struct import_row* rows;   // From the parsing worker's arena
+    struct arena* arenas;      // One per pool worker
+    long row_count;
+    long row_capacity;
+    long line_count;        // All lines in the chunk, blank ones included
+    int failed;             // Out of memory while parsing
+};
+
+/* Receives each parsed row in file order (client is NULL for a malformed row) */
+typedef int (*import_row_handler)(void* context, const struct client_data* client, long line_number);
+
+/* Importer state between rows: current run of consecutive positions */
+struct import_writer {
+    FILE* data_ptr;
+    FILE* report_ptr;
+    struct client_data* run;
+    struct client_data* current;  // What the run's slots held before
+    long run_start;         // Position of run[0]
+    int run_length;
+    unsigned char* seen;    // One bit per account number already imported
+    long imported;
+    long rejected;
+};
+
+/* Work-stealing pool shared by the batch jobs */
+#define MAX_POOL_THREADS 64
+#define WORK_DEQUE_SIZE 1024          // Tasks one worker can have queued (power of two)
+#define IMPORT_CHUNKS_PER_THREAD 4    // Chunks per import round, so stealing can even them out
+#define SCAN_GRAIN 4096               // Records one account-scan task handles without splitting
+
+struct work_pool;
+typedef void (*work_function)(struct work_pool* pool, int worker, void* arg);
+
+struct work_task {
+    work_function function;
+    void* arg;
+};
+
+/*
+ * One worker's tasks. The owner pushes and pops at the bottom (newest
+ * first, which keeps its data in cache); thieves take from the top,
+ * the oldest and usually largest piece of work.
+ */
+struct work_deque {
+    pthread_mutex_t lock;
+    struct work_task tasks[WORK_DEQUE_SIZE];
+    size_t top;             // Oldest task
+    size_t bottom;          // One past the newest task
+};
+
+struct work_pool {
+    int threads;                    // Worker 0 is the thread calling work_pool_wait
+    struct work_deque* deques;      // One per worker
+    pthread_t* helpers;             // Workers 1 .. threads-1
+    int helpers_started;
+    atomic_int next_worker;         // Numbers handed to helpers as they start
+    atomic_long pending;            // Submitted but not finished
+    atomic_long queued;             // Sitting in a deque
+    atomic_long steals;             // Tasks run by a worker other than the one that queued them
+    pthread_mutex_t idle_lock;
+    pthread_cond_t work_available;  // Idle helpers sleep here
+    int shutting_down;
+};
+
+/* Receives consecutive records of the data file during a parallel scan */
+typedef void (*account_range_handler)(void* context, int worker, const struct client_data* records,
+                                      long first_position, long count);
+
+struct account_scan {
+    const struct client_data* records;
+    long record_count;
+    account_range_handler handler;
+    void* context;
+    struct account_scan_task* tasks;    // Preallocated, one per possible split
+    atomic_long next_task;
+};
+
+/* Grains [first, first + count) of an account scan (a grain is SCAN_GRAIN records) */
+struct account_scan_task {
+    struct account_scan* scan;
+    long first;
+    long count;
+};
+
+/* Totals reported by "version3 report" */
+struct account_summary {
+    long accounts;
+    long overdrawn;
+    long long total_cents;
+};
+
+/* Interest accrual: tiered rates applied to every positive balance */
+#define INTEREST_MAX_TIERS 4
+#define INTEREST_RATE_UNIT 1000000    // Rates are in millionths of the balance per run
+#define INTEREST_EXACT_LIMIT 9007199254740992.0  // 2^53: larger products are not exact as doubles
+
+/* Tier t pays rate[t] on the part of a balance from floor_cents[t] up to the next floor */
+struct interest_tiers {
+    int count;
+    long long floor_cents[INTEREST_MAX_TIERS];  // Ascending, floor_cents[0] = 0
+    long rate[INTEREST_MAX_TIERS];              // Millionths per run, 0 .. INTEREST_RATE_UNIT
+};
+
+/* One scan worker's buffers and totals (a cache line apart from the others) */
+struct interest_worker {
+    _Alignas(64) struct client_data* records;   // SCAN_GRAIN records read under the range lock
+    double* cents;                              // Their balances in cents
+    double* interest;                           // Interest due on each
+    struct transaction_record* entries;         // History entries of the grain
+    long accounts;                              // Accounts credited
+    long long interest_cents;                   // Interest paid
+    long grains_skipped;                        // Grains with no positive balance (never locked)
+    int ok;
+};
+
+struct interest_job {
+    int fd;                                     // Data file, for range locks and writes
+    FILE* history_ptr;
+    struct account_flags* flags;                // Closed accounts earn nothing (NULL = none closed)
+    struct interest_tiers tiers;
+    long long timestamp;
+    struct interest_worker workers[MAX_POOL_THREADS];
+};
+
+struct interest_summary {
+    long records;                               // Records scanned
+    long accounts;                              // Accounts credited
+    long long interest_cents;
+    long grains_skipped;
+    double seconds;
+};
+
+/* Overdraft fees: a flat fee plus a rate on the amount overdrawn, capped */
+struct overdraft_fees {
+    long long flat_cents;
+    long rate;                                  // Millionths of the amount overdrawn (INTEREST_RATE_UNIT)
+    long long cap_cents;                        // Most one account pays per run, 0 = no cap
+};
+
+struct overdraft_summary {
+    long candidates;                            // Accounts in the overdrawn index
+    long charged;
+    long cleared;                               // No longer overdrawn (or deleted), taken out of the index
+    long skipped;                               // Overdrawn but closed
+    long long fee_cents;
+    long long overdrawn_cents;                  // Owed by the overdrawn accounts after the fees
+    int rebuilt;                                // 1 if the index was rebuilt with a scan first
+    double seconds;
+};
+
+/* Standing orders: recurring transfers kept in "<data file>.orders", one record per order */
+#define ORDERS_SUFFIX ".orders"       // Order file name: data file name + this
+#define ORDER_BATCH 4096              // Due orders made under one range lock
+#define ORDER_UNTIL_CANCELLED -1      // 'remaining' of an order without an end
+
+struct standing_order {
+    unsigned int id;                            // Position in the order file + 1
+    unsigned int from_acct;
+    unsigned int to_acct;
+    int last_status;                            // COMMAND_* of the last run, -1 before the first
+    long long cents;                            // Amount of each transfer
+    long long interval;                         // Seconds between transfers
+    long long next_due;                         // Seconds since the epoch
+    long long remaining;                        // Transfers left: 0 = finished or cancelled
+    long long executed;                         // Transfers made
+    long long refused;                          // Runs refused (funds, frozen, closed, missing account)
+};
+
+/* The order file, locked and mapped while open */
+struct order_file {
+    int fd;
+    struct standing_order* orders;              // NULL if there are none
+    long count;
+};
+
+/* Positions of active orders, earliest next_due at the top */
+struct order_heap {
+    unsigned int* items;
+    long count;
+    const struct standing_order* orders;
+};
+
+/* One run of the due orders */
+struct order_run {
+    int fd;                                     // Data file
+    FILE* history_ptr;
+    struct account_flags* flags;                // NULL if the data file has none
+    struct velocity_tracker* velocity;          // NULL if the data file has no velocity limits
+    struct audit_ring* audit;                   // NULL = not audited
+    FILE* report_ptr;                           // Refused orders (NULL = not reported)
+    struct client_data records[MAX_ACCOUNTS];   // The accounts of the current batch
+    unsigned char changed[MAX_ACCOUNTS];        // Which of them a transfer changed
+    long long debits[MAX_ACCOUNTS];             // Debits the batch made from each, not yet recorded
+    long long debited_cents[MAX_ACCOUNTS];
+    struct transaction_record* entries;         // Two per transfer of the batch
+};
+
+struct order_summary {
+    long orders;                                // Active orders
+    long due;
+    long executed;
+    long refused;
+    long long cents;                            // Moved
+    long batches;
+    long long next_due;                         // Earliest due time left, 0 if none
+    double seconds;
+};
+
+/* Delta coalescing for hot accounts */
+#define HOT_STRIPES 16                // Delta counters per hot account (one per CPU, modulo)
+#define HOT_FOLD_INTERVAL_MS 50       // How often the folder thread writes pending deltas
+#define DEFAULT_OVERDRAFT_LIMIT_CENTS 50000  // $500.00 below zero
+
+#define HOT_OK 0
+#define HOT_OVERDRAFT 1               // Debit would exceed the overdraft limit
+#define HOT_IO_ERROR 2
+#define HOT_REFUSED 3                 // Account is frozen or closed (ACCOUNT STATUS FLAGS)
+
+/* Deltas added on one CPU since the last fold, on a cache line of their own */
+struct delta_stripe {
+    _Alignas(64) atomic_llong credit_cents;
+    atomic_llong debit_cents;         // Zero or negative
+    atomic_long deltas;
+};
+
+/* An account whose updates are accumulated in memory and folded into its record */
+struct hot_account {
+    struct delta_stripe stripes[HOT_STRIPES];
+    _Alignas(64) atomic_llong headroom_cents;  // What may still be debited before a fold
+    unsigned int acct_num;            // Never changes, so it can be read without the fold lock
+    pthread_mutex_t fold_lock;        // One fold at a time; protects 'client'
+    struct client_data client;        // Record as of the last fold
+    long folds;
+};
+
+struct hot_store {
+    FILE* data_ptr;
+    FILE* history_ptr;
+    pthread_mutex_t file_lock;        // Serializes record and history writes
+    struct account_flags* flags;      // Status flags and overdrawn index, NULL if the data file has none
+    long long overdraft_limit_cents;
+    struct hot_account* accounts[MAX_ACCOUNTS];  // Tracked accounts by position
+    pthread_mutex_t track_lock;
+    pthread_t folder;
+    int folder_running;
+    int stopping;
+    pthread_mutex_t folder_lock;
+    pthread_cond_t folder_wake;
+};
+
+/* In-memory copy of every record, read without locks */
+#define TABLE_RECORD_WORDS (sizeof(struct client_data) / sizeof(unsigned long long))
+_Static_assert(sizeof(struct client_data) % sizeof(unsigned long long) == 0,
+               "client_data must copy as whole 64-bit words");
+
+/*
+ * One record guarded by a sequence lock. The record is held as atomic
+ * words so a reader overlapping a writer gets a mix of old and new
+ * words (which it throws away) instead of undefined behaviour.
+ */
+struct table_record {
+    _Alignas(64) atomic_uint sequence;          // Odd while a writer is in the record
+    atomic_ullong words[TABLE_RECORD_WORDS];
+};
+
+struct account_table {
+    _Alignas(64) atomic_ulong generation;       // Odd while a writer is publishing
+    atomic_int owner;                           // Process id of the publishing writer, 0 = none
+    struct table_record records[MAX_ACCOUNTS];  // By position, like the data file
+};
+
+/* Shared-memory view: the account table placed where other processes can map it */
+#define VIEW_MAGIC "ACCTVIEW"
+#define VIEW_NAME_SIZE 64
+
+/* Readers in other processes rely on these atomics being plain loads and stores */
+_Static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+               "the shared view needs lock-free atomics");
+
+struct shared_view {
+    char magic[8];                  // VIEW_MAGIC
+    unsigned int record_size;       // RECORD_SIZE and MAX_ACCOUNTS of the writers,
+    unsigned int max_accounts;      // checked by readers built separately
+    atomic_uint ready;              // 1 once a writer has loaded the table
+    struct account_table table;
+};
+
+/* Account status flags: one bit per account per flag, in a file mapped by every process */
+#define FLAGS_SUFFIX ".flags"         // Flag file name: data file name + this
+#define FLAGS_MAGIC "ACCTFLAG"
+#define ACCOUNT_FROZEN 0              // No update, transfer or delete
+#define ACCOUNT_CLOSED 1              // No update or transfer (may still be deleted)
+#define ACCOUNT_OVERDRAFT 2           // Balance may go below zero (set for every account at first)
+#define ACCOUNT_FLAG_COUNT 3
+#define FLAG_WORDS (MAX_ACCOUNT_NUM / 64 + 1)  // Bit N of a flag is account N
+
+struct account_flags {
+    char magic[8];                  // FLAGS_MAGIC
+    unsigned int max_account;       // MAX_ACCOUNT_NUM and FLAG_WORDS of the creator,
+    unsigned int words;             // checked by every later opener
+    atomic_uint ready;              // 1 once the defaults are in place
+    atomic_uint indexed;            // 1 while 'overdrawn' covers every record (see BATCH JOB: OVERDRAFT FEES)
+    _Alignas(64) atomic_ullong bits[ACCOUNT_FLAG_COUNT][FLAG_WORDS];
+    _Alignas(64) atomic_ullong overdrawn[FLAG_WORDS];  // Accounts that may be below zero
+};
+
+/* Velocity checks: each account's recent debits, against limits kept in "<data file>.velocity" */
+#define VELOCITY_SUFFIX ".velocity"   // Limits file name: data file name + this
+#define VELOCITY_MAGIC "VELOCITY"
+#define DEBITS_SUFFIX ".debits"       // Recent debits file, mapped by every process: data file name + this
+#define DEBITS_MAGIC "DEBITWIN"
+#define VELOCITY_WINDOW_SECONDS 3600  // "The last hour"
+#define VELOCITY_BUCKETS 60           // Ring slots per account: the window moves a minute at a time
+#define VELOCITY_BUCKET_SECONDS (VELOCITY_WINDOW_SECONDS / VELOCITY_BUCKETS)
+
+/* The limits, exactly as stored in the file */
+struct velocity_rules {
+    char magic[8];                    // VELOCITY_MAGIC
+    long long max_debits;             // Most debits per account per window, 0 = no limit
+    long long max_cents;              // Most debited per account per window, 0 = no limit
+};
+
+/* One account's debits: a ring of per-minute buckets, each tagged with its minute */
+struct velocity_window {
+    atomic_llong bucket_number[VELOCITY_BUCKETS];  // seconds / VELOCITY_BUCKET_SECONDS of each slot's minute
+    atomic_uint bucket_debits[VELOCITY_BUCKETS];
+    atomic_llong bucket_cents[VELOCITY_BUCKETS];
+};
+
+/* Every account's window, by position */
+struct velocity_windows {
+    char magic[8];                    // DEBITS_MAGIC
+    unsigned int max_accounts;        // MAX_ACCOUNTS and VELOCITY_BUCKETS of the creator,
+    unsigned int buckets;             // checked by every later opener
+    atomic_uint ready;                // 1 once the header is in place
+    _Alignas(64) struct velocity_window windows[MAX_ACCOUNTS];
+};
+
+struct velocity_tracker {
+    struct velocity_rules rules;
+    struct velocity_windows* shared;  // "<data file>.debits", mapped
+    int fd;                           // Kept open for the window locks
+    long checks;                      // This tracker's own
+    long refusals;
+};
+
+/* Audit trail: every command as a fixed-size binary event in "<data file>.audit" */
+#define AUDIT_SUFFIX ".audit"         // Audit file name: data file name + this
+#define AUDIT_RING_SIZE 8192          // Events a thread can record before waiting for the writer (power of two)
+#define AUDIT_WINDOW_MS 10            // Default loss window: events reach the disk this long after being recorded
+
+struct audit_event {
+    long long time_ns;                // CLOCK_REALTIME when the command finished
+    unsigned short ring;              // Ring (thread) that recorded it, 0 = written directly
+    unsigned char type;               // COMMAND_*
+    unsigned char status;             // COMMAND_OK or the error code
+    unsigned int sequence;            // Per ring, so a gap would show
+    unsigned int acct_num;
+    unsigned int target_acct;         // Transfers only
+    long long cents;                  // Amount of the command
+};
+
+_Static_assert(sizeof(struct audit_event) == 32, "audit events are 32 bytes on disk");
+
+/*
+ * One recording thread's events on their way to the writer thread.
+ * Only the recording thread writes 'tail' and the fields after it;
+ * only the writer writes 'head'.
+ */
+struct audit_ring {
+    _Alignas(64) atomic_size_t head;            // Next event to write out
+    _Alignas(64) atomic_size_t tail;            // Next free slot
+    unsigned int sequence;                      // Of the next event
+    long full_waits;                            // Events that waited for room
+    _Alignas(64) unsigned short id;
+    atomic_int in_use;                          // 1 while attached to a session
+    struct audit_ring* next;                    // Older rings (fixed once published)
+    struct audit_event events[AUDIT_RING_SIZE];
+};
+
+struct audit_stats {
+    long events;                      // Events written
+    long writes;                      // write() calls
+    long syncs;                       // fdatasync() calls
+    long full_waits;                  // Events recorded into a full ring
+    double max_lag_ms;                // Longest time from recording an event to its fdatasync
+};
+
+/* The audit file and its writer thread, shared by every session of a process */
+struct audit_log {
+    int fd;
+    long window_ms;
+    pthread_t writer;
+    atomic_int stopping;
+    _Atomic(struct audit_ring*) rings;          // Every ring attached so far, newest first
+    atomic_uint ring_count;
+    struct audit_stats stats;                   // Kept by the writer
+    int ok;                                     // 0 after a failed write or sync
+};
+
+/* Name dictionary: every distinct name stored once and referred to by a 32-bit id */
+#define NAME_ID_NONE 0xFFFFFFFFu      // "No such name" from name_find
+#define NAME_SLOTS_INITIAL 1024       // Hash slots of a new dictionary (power of two)
+
+struct name_dictionary {
+    char* text;                   // Names back to back, each NUL-terminated
+    size_t text_size;
+    size_t text_capacity;
+    unsigned int* offsets;        // Id -> offset of the name in text
+    unsigned int* hashes;         // Id -> hash of the name, for growing the slots
+    unsigned int count;           // Ids handed out (ids are 0 .. count-1)
+    unsigned int capacity;        // Room in offsets and hashes
+    unsigned int* slots;          // Open-addressing table of id + 1 (0 = empty)
+    unsigned int slot_mask;       // Slot count - 1
+};
+
+/* Dictionary-encoded record: the names are ids, so a record takes 24 bytes instead of 40 */
+struct encoded_client {
+    unsigned int acct_num;
+    unsigned int last_name;       // Id in the store's name dictionary
+    unsigned int first_name;
+    unsigned short version;
+    double balance;
+};
+
+_Static_assert(sizeof(struct encoded_client) == 24, "encoded records must stay packed");
+
+/* Store file: sorted records in pages plus a bottom-up built index */
+#define STORE_FILE "accounts.store"
+#define STORE_MAGIC "ACCTSTOR"
+#define STORE_PAGE_SIZE 4096
+#define STORE_MAX_LEVELS 8
+
+#define STORE_FORMAT_PLAIN 0          // Data pages hold struct client_data
+#define STORE_FORMAT_NAMES 1          // Data pages hold struct encoded_client plus a name dictionary
+
+struct store_header {
+    char magic[8];                   // STORE_MAGIC
+    unsigned int page_size;          // STORE_PAGE_SIZE
+    unsigned int index_levels;       // Index pages above the data pages (0 = empty)
+    unsigned long long record_count;
+    unsigned long long page_count;   // Including this header page
+    unsigned long long root_page;    // Top index page
+    unsigned int record_format;      // STORE_FORMAT_* (0 in stores built before dictionaries)
+    unsigned int name_count;         // Names in the dictionary
+    unsigned long long names_page;   // First dictionary page: name offsets, then the names
+    unsigned long long names_size;   // Bytes of name text
+};
+
+#define STORE_DATA_CAPACITY ((STORE_PAGE_SIZE - 8) / sizeof(struct client_data))
+#define STORE_ENCODED_CAPACITY ((STORE_PAGE_SIZE - 8) / sizeof(struct encoded_client))
+
+struct store_data_page {
+    unsigned int count;              // Records in use
+    unsigned int level;              // Always 0 for data pages
+    struct client_data records[STORE_DATA_CAPACITY];
+};
+
+struct store_encoded_page {
+    unsigned int count;              // Records in use
+    unsigned int level;              // Always 0 for data pages
+    struct encoded_client records[STORE_ENCODED_CAPACITY];
+};
+
+struct store_index_entry {
+    unsigned int first_acct;         // Lowest account in the child page
+    unsigned int page;               // Child page number
+};
+
+#define STORE_INDEX_CAPACITY ((STORE_PAGE_SIZE - 8) / sizeof(struct store_index_entry))
+
+struct store_index_page {
+    unsigned int count;              // Entries in use
+    unsigned int level;              // 1 = children are data pages
+    struct store_index_entry entries[STORE_INDEX_CAPACITY];
+};
+
+union store_page {
+    struct store_data_page data;
+    struct store_encoded_page encoded;
+    struct store_index_page index;
+    unsigned char bytes[STORE_PAGE_SIZE];
+};
+
+/* Rows collected for sorting by the store builder */
+struct store_row_list {
+    struct import_row* rows;
+    long count;
+    long capacity;
+    long rejected;
+    FILE* report_ptr;
+};
+
+/* Store builder state: the page being filled at every level */
+struct store_builder {
+    FILE* store_ptr;
+    struct store_header header;
+    unsigned int next_page;                       // Page number of the next write
+    union store_page data;                        // Data page being filled
+    union store_page levels[STORE_MAX_LEVELS];    // Index page being filled, per level
+    unsigned int pages_at_level[STORE_MAX_LEVELS];  // Pages already written, per level
+    int level_count;
+    struct name_dictionary* names;                // Encodes the data pages (NULL = plain records)
+};
+
+/* A store file mapped for lookups */
+struct store_file {
+    const union store_page* pages;   // Page n is pages[n]
+    size_t size;
+    struct store_header header;
+    struct name_dictionary names;    // Loaded from a dictionary-encoded store
+};
+
+/* Bounded blocking queue connecting two pipeline stages */
+struct bounded_queue {
+    void** items;           // Ring buffer of queued items
+    int capacity;
+    int head;               // Index of the oldest item
+    int count;              // Items currently queued
+    int closed;             // No more items will be pushed
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+};
+
+/* One customer's statement as it moves through the pipeline */
+struct statement_job {
+    struct client_data client;                 // Record from the data file
+    const struct transaction_record* history;  // This month's entries
+    long history_count;
+    char* text;                                // Formatted statement
+    int text_length;
+    int text_capacity;
+};
+
+/* Scripted command mode */
+#define COMMAND_CREATE 1
+#define COMMAND_READ 2
+#define COMMAND_UPDATE 3
+#define COMMAND_DELETE 4
+#define COMMAND_TRANSFER 5
+#define COMMAND_LIST 6
+
+#define COMMAND_OK 0
+#define COMMAND_BAD_SYNTAX 1
+#define COMMAND_BAD_ACCOUNT 2
+#define COMMAND_BAD_NAME 3
+#define COMMAND_BAD_AMOUNT 4
+#define COMMAND_NOT_FOUND 5
+#define COMMAND_EXISTS 6
+#define COMMAND_IO_ERROR 7
+#define COMMAND_CONFLICT 8            // Record kept changing under the command
+#define COMMAND_FROZEN 9              // Account is frozen (ACCOUNT STATUS FLAGS)
+#define COMMAND_CLOSED 10             // Account is closed
+#define COMMAND_NO_OVERDRAFT 11       // Debit would overdraw an account not allowed to
+#define COMMAND_VELOCITY 12           // Debit would exceed the account's velocity limits
+
+#define MAX_COMMAND_LINE 256
+#define MAX_COMMAND_TOKENS 6
+#define COMMAND_OUTPUT_BUFFER (1 << 16)  // stdout buffer while running a script
+#define LISTING_ROW_SIZE 80           // Room per row of a "list" answer
+#define LISTING_SIZE (MAX_ACCOUNTS * LISTING_ROW_SIZE + 1)
+
+/* One parsed command, e.g. "update 17 +25.00" */
+struct command {
+    int type;                   // COMMAND_CREATE ... COMMAND_LIST
+    unsigned int acct_num;
+    unsigned int target_acct;   // Transfer destination
+    char last_name[15];
+    char first_name[10];
+    long long cents;            // Initial balance, change or transfer amount
+};
+
+/* Outcome of one command */
+struct command_result {
+    int status;                 // COMMAND_OK or an error code
+    char detail[80];            // Error description
+    struct client_data client;  // Account after the command
+    struct client_data target;  // Transfer destination after the command
+    char* listing;              // Rows printed by "list" (in 'arena')
+    struct arena* arena;        // Where the command's temporaries go
+};
+
+/* Files a command script works on, opened once for the whole script */
+struct command_session {
+    FILE* data_ptr;
+    FILE* extension_ptr;          // Set once the data file is being migrated: writes upgrade records
+    FILE* history_ptr;
+    FILE* output_ptr;
+    struct arena arena;           // Temporaries of the current command
+    struct account_table* table;  // Serves reads; updated on every write
+    int owns_table;               // 0 once command_session_share_table was called
+    struct shared_view* view;     // Holds 'table' if the session publishes one
+    struct account_flags* flags;  // Status bitmap, NULL if the data file has none
+    struct audit_ring* audit;     // Where commands are recorded, NULL if not audited
+    struct velocity_tracker* velocity;  // Recent debits, NULL if the data file has no limits
+    long executed;
+    long failed;
+};
+
+/* Ingest pipeline: parse -> validate -> apply -> log, one thread each */
+#define INGEST_STAGES 4
+#define INGEST_RING_SIZE 256          // Items in flight between two stages (power of two)
+#define INGEST_ITEMS 1024             // Items circulating through the pipeline
+#define RING_SPIN_LIMIT 64            // Busy polls before a waiting stage yields the CPU
+
+/*
+ * Lock-free single-producer/single-consumer ring of pointers.
+ * Only the producer writes 'tail' and only the consumer writes 'head';
+ * they sit on separate cache lines so the two threads do not keep
+ * stealing the line from each other.
+ */
+struct spsc_ring {
+    void** slots;
+    size_t mask;                                // Capacity - 1
+    _Alignas(64) atomic_size_t head;            // Next slot to pop
+    _Alignas(64) atomic_size_t tail;            // Next slot to push
+};
+
+/* Per-stage counters of the ingest pipeline */
+struct stage_stats {
+    const char* name;
+    long items;             // Commands handled
+    long full_waits;        // Times the next ring was full (backpressure)
+    long empty_waits;       // Times the previous ring was empty
+    double seconds;         // Stage running time
+};
+
+/* One command travelling through the ingest pipeline */
+struct ingest_item {
+    struct command command;
+    struct command_result result;
+    struct arena arena;         // Temporaries, reset once the answer is written
+};
+
+/* Shared state of the ingest pipeline */
+struct ingest_pipeline {
+    FILE* script_ptr;
+    struct command_session session;
+    struct ingest_item* items;
+    struct spsc_ring free_items;        // log      -> parse
+    struct spsc_ring parsed;            // parse    -> validate
+    struct spsc_ring validated;         // validate -> apply
+    struct spsc_ring applied;           // apply    -> log
+    struct stage_stats stats[INGEST_STAGES];
+};
+
+/* Asynchronous client: callers queue requests, one service thread carries them out */
+struct account_request;
+typedef void (*account_callback)(struct account_request* request, void* context);
+
+/*
+ * One queued operation; owned by the caller, who must keep it until it
+ * completes. Requests not taken from the client's pool must be zeroed
+ * before their first use.
+ */
+struct account_request {
+    struct command command;
+    struct command_result result;   // result.status is the outcome
+    account_callback done;          // Called on the service thread; NULL to poll 'finished'
+    void* context;
+    atomic_int finished;            // Set when complete if 'done' is NULL
+    int pooled;                     // From account_client_new_request
+    char* buffer;                   // Pooled request's "list" buffer, kept until freed
+    struct account_request* next;   // Queue link
+};
+
+struct account_client {
+    struct command_session session;
+    struct object_pool requests;    // account_client_new_request
+    struct object_pool buffers;     // "list" answers (LISTING_SIZE)
+    _Atomic(struct account_request*) submitted;  // Newest first
+    atomic_long outstanding;        // Submitted and not yet completed
+    long completed;
+    long batches;                   // Times the service thread took the queue
+    pthread_t service;
+    pthread_mutex_t lock;           // Only for sleeping and waking
+    pthread_cond_t wake;            // Service thread: requests arrived or stopping
+    pthread_cond_t idle;            // account_client_drain: nothing outstanding
+    int stopping;
+};
+
+/* Shared state of the statement pipeline */
+struct statement_pipeline {
+    FILE* data_ptr;
+    FILE* output_ptr;
+    struct transaction_record* history;  // Grouped by account, in time order
+    long* history_offsets;               // Account a owns [offsets[a], offsets[a + 1])
+    unsigned int max_history_acct;
+    struct bounded_queue fetched;        // fetch  -> lookup
+    struct bounded_queue looked_up;      // lookup -> format
+    struct bounded_queue formatted;      // format -> write
+    long written;
+    atomic_int failed;                   // Set by any stage
+};
+
+/* Function Prototypes */
+/* CRUD Operations */
+int create_account(void);
+int read_account(void);
+int update_account(void);
+int delete_account(void);
+
+/* Core File Operations */
+FILE* open_data_file(const char* mode);
+int close_data_file(FILE* file_ptr);
+int write_client_to_file(FILE* file_ptr, const struct client_data* client, int position);
+int read_client_from_file(FILE* file_ptr, struct client_data* client, int position);
+int account_exists(unsigned int acct_num);
+int read_account_snapshot(unsigned int acct_num, struct client_data* client);
+int lock_record(int fd, int position, int lock);
+int lock_record_range(int fd, long first_position, long count, int lock);
+int write_clients_if_unchanged(FILE* file_ptr, struct client_data* clients,
+                               const struct client_data* expected, const int* positions, int count);
+int write_client_if_unchanged(FILE* file_ptr, struct client_data* client, int position,
+                              const struct client_data* expected);
+int write_clients_upgrading(FILE* file_ptr, FILE* extension_ptr, struct client_data* clients,
+                            const struct client_data* expected, const int* positions, int count);
+
+/* Schema Evolution */
+int extension_path(const char* data_path, char* path, size_t size);
+FILE* open_extension_file(const char* data_path, int create);
+void default_extension(const struct client_data* client, int open_date, struct client_extension* extension);
+int today_date(void);
+int read_client_extended(FILE* file_ptr, FILE* extension_ptr, int position,
+                         struct client_data* client, struct client_extension* extension);
+int record_has_extension(FILE* extension_ptr, int position, const struct client_data* client,
+                         struct client_extension* extension);
+int set_client_extension(FILE* file_ptr, FILE* extension_ptr, int position,
+                         const struct client_extension* extension);
+long migrate_records(FILE* file_ptr, FILE* extension_ptr, long first, long count, long* conflicts);
+int schema_migrator_start(struct schema_migrator* migrator, const char* data_path, long batch, long pause_ms);
+void* schema_migrator_run(void* arg);
+void schema_migrator_join(struct schema_migrator* migrator);
+void schema_migrator_stop(struct schema_migrator* migrator);
+
+/* Input Validation */
+unsigned int get_account_number(const char* prompt);
+double get_balance_input(const char* prompt);
+void get_name_input(char* buffer, int max_length, const char* prompt);
+void clear_input_buffer(void);
+int validate_account_number(unsigned int acct_num);
+int validate_name(const char* name);
+unsigned int name_block_masks(const char* block, unsigned int* space_mask, unsigned int* nul_mask);
+int name_chars_valid(const char* text, size_t len);
+size_t trim_name(char* buffer);
+size_t normalize_names_batch(char* names, size_t stride, size_t width, size_t count, unsigned char* valid);
+int parse_amount_cents(const char* text, size_t len, long long* cents, size_t* error_position);
+unsigned long long parse_eight_digits(unsigned long long digits);
+unsigned long long parse_digit_run(const char* text, unsigned int count);
+int parse_amount_line_fast(const char* line, long long* cents);
+long parse_amounts_batch(const char* text, size_t size, long long* cents, long max_count,
+                         struct amount_error* error);
+const char* amount_error_message(int status);
+
+/* Display Functions */
+void display_client(const struct client_data* client);
+void display_all_accounts(void);
+void print_account_header(void);
+void print_account_row(const struct client_data* client);
+
+/* Utility Functions */
+void initialize_client(struct client_data* client, unsigned int acct_num,
+                      const char* last_name, const char* first_name, double balance);
+void initialize_data_file_if_needed(void);
+double elapsed_seconds(const struct timespec* start);
+
+/* Arena Allocator */
+void arena_init(struct arena* arena, size_t block_size);
+void* arena_alloc(struct arena* arena, size_t size);
+void* arena_grow(struct arena* arena, void* ptr, size_t old_size, size_t new_size);
+void arena_reset(struct arena* arena);
+void arena_release(struct arena* arena);
+
+/* Object Pools */
+int object_pool_init(struct object_pool* pool, size_t object_size);
+void object_pool_destroy(struct object_pool* pool);
+void* object_pool_get(struct object_pool* pool, int cache);
+void object_pool_put(struct object_pool* pool, int cache, void* object);
+void object_pool_stats(struct object_pool* pool, struct pool_stats* stats);
+
+/* Name Dictionary */
+int name_dictionary_init(struct name_dictionary* names);
+void name_dictionary_free(struct name_dictionary* names);
+unsigned int name_hash(const char* name, size_t len);
+unsigned int name_intern(struct name_dictionary* names, const char* name);
+unsigned int name_find(const struct name_dictionary* names, const char* name);
+const char* name_text(const struct name_dictionary* names, unsigned int id);
+int encode_client(struct name_dictionary* names, const struct client_data* client, struct encoded_client* encoded);
+void decode_client(const struct name_dictionary* names, const struct encoded_client* encoded,
+                   struct client_data* client);
+
+/* Transaction History */
+int log_transaction(unsigned int acct_num, double amount, double balance_after);
+int append_transaction(FILE* history_ptr, unsigned int acct_num, double amount, double balance_after);
+struct transaction_record* load_history(const char* history_path, long* count);
+
+/* Batch Jobs */
+int run_batch_command(int argc, char* argv[]);
+struct work_pool* work_pool_create(int threads);
+void work_pool_destroy(struct work_pool* pool);
+void work_pool_submit(struct work_pool* pool, int worker, work_function function, void* arg);
+int work_pool_run_one(struct work_pool* pool, int worker, unsigned int* seed);
+void* work_pool_helper(void* arg);
+void work_pool_wait(struct work_pool* pool);
+void account_scan_task(struct work_pool* pool, int worker, void* arg);
+long scan_accounts_parallel(const char* data_path, int threads, account_range_handler handler, void* context);
+void summarize_account_range(void* context, int worker, const struct client_data* records,
+                             long first_position, long count);
+long summarize_accounts(const char* data_path, int threads, struct account_summary* summary);
+long long interest_cents(long long balance_cents, const struct interest_tiers* tiers);
+void accrue_interest_column(const double* cents, double* interest, long count, const struct interest_tiers* tiers);
+void accrue_interest_range(void* context, int worker, const struct client_data* records,
+                           long first_position, long count);
+long accrue_interest(const char* data_path, const char* history_path, int threads,
+                     const struct interest_tiers* tiers, struct interest_summary* summary);
+int parse_interest_tiers(int count, char* arguments[], struct interest_tiers* tiers);
+int parse_rate_percent(const char* text, long* rate);
+void index_overdrawn_range(void* context, int worker, const struct client_data* records,
+                           long first_position, long count);
+long index_overdrawn_accounts(const char* data_path, struct account_flags* flags, int threads);
+long long overdraft_fee_cents(long long overdrawn_cents, const struct overdraft_fees* fees);
+long charge_overdraft_fees(const char* data_path, const char* history_path, const struct overdraft_fees* fees,
+                           int rebuild, FILE* report_ptr, struct overdraft_summary* summary);
+int parse_overdraft_fees(int count, char* arguments[], struct overdraft_fees* fees);
+int order_file_open(struct order_file* file, const char* data_path, int create);
+void order_file_close(struct order_file* file);
+long add_standing_orders(const char* data_path, const struct standing_order* orders, long count);
+int cancel_standing_order(const char* data_path, unsigned int id);
+int order_due_first(const struct standing_order* orders, unsigned int a, unsigned int b);
+void order_heap_sift_down(struct order_heap* heap, long i);
+void order_heap_push(struct order_heap* heap, unsigned int position);
+unsigned int order_heap_pop(struct order_heap* heap);
+int apply_order_batch(struct order_run* run, struct standing_order* orders, const unsigned int* batch,
+                      long count, struct order_summary* summary);
+long run_standing_orders(const char* data_path, const char* history_path, long long now,
+                         struct audit_log* audit, FILE* report_ptr, struct order_summary* summary);
+int parse_order_interval(const char* text, long long* seconds);
+int print_standing_orders(const char* data_path, FILE* output_ptr);
+int queue_init(struct bounded_queue* queue, int capacity);
+int queue_push(struct bounded_queue* queue, void* item);
+void* queue_pop(struct bounded_queue* queue);
+void queue_close(struct bounded_queue* queue);
+void queue_destroy(struct bounded_queue* queue);
+long long statement_period_start(void);
+int group_history_by_account(struct statement_pipeline* pipeline, struct transaction_record* history,
+                             long count, long long since);
+int append_statement_text(struct statement_job* job, const char* format, ...);
+int format_statement(struct statement_job* job);
+void* statement_fetch_stage(void* arg);
+void* statement_lookup_stage(void* arg);
+void* statement_format_stage(void* arg);
+void statement_write_stage(struct statement_pipeline* pipeline);
+long generate_statements(const char* data_path, const char* history_path,
+                         const char* output_path, struct batch_stats* stats);
+const char* map_text_file(const char* path, size_t* size);
+void unmap_text_file(const char* text, size_t size);
+const char* find_newline(const char* start, const char* end);
+const char* skip_field_separator(const char* p, const char* end);
+int parse_client_row(const char* line, const char* end, struct client_data* client);
+int flush_import_run(FILE* data_ptr, struct client_data* run, struct client_data* current,
+                     long first_position, int count);
+void parse_import_chunk(struct work_pool* pool, int worker, void* arg);
+int scan_import_text(const char* text, size_t size, int threads,
+                     import_row_handler handler, void* context, struct batch_stats* stats);
+int import_write_row(void* context, const struct client_data* client, long line_number);
+long import_clients_text(const char* text_path, const char* data_path, int threads,
+                         FILE* report_ptr, struct batch_stats* stats);
+int collect_store_row(void* context, const struct client_data* client, long line_number);
+int sort_row_keys(unsigned long long* keys, long count);
+unsigned int store_write_page(struct store_builder* builder, const union store_page* page);
+int store_add_index_entry(struct store_builder* builder, int level, unsigned int first_acct, unsigned int child);
+int store_flush_data_page(struct store_builder* builder);
+int store_finish(struct store_builder* builder);
+int store_write_names(struct store_builder* builder);
+long build_store_file(const char* text_path, const char* store_path, int threads, int encode_names,
+                      FILE* report_ptr, struct batch_stats* stats);
+int store_file_open(struct store_file* store, const char* store_path);
+int store_file_load_names(struct store_file* store);
+void store_file_close(struct store_file* store);
+int store_file_find(const struct store_file* store, unsigned int acct_num, struct client_data* client);
+long store_file_find_last_name(const struct store_file* store, const char* last_name,
+                               struct client_data* matches, long max_matches);
+long* store_file_group_last_names(const struct store_file* store, struct name_dictionary* groups);
+
+/* Scripted Commands */
+long long balance_to_cents(double balance);
+int command_type(const char* word, size_t len);
+int parse_command_account(const char* token, size_t len, unsigned int* acct_num, struct command_result* result);
+int parse_command_amount(const char* token, size_t len, long long* cents, struct command_result* result);
+int parse_command_name(const char* token, size_t len, char* name, size_t size, struct command_result* result);
+int parse_command(const char* line, size_t len, struct command* command, struct command_result* result);
+int validate_command(const struct command* command, struct command_result* result);
+int read_command_account(struct command_session* session, unsigned int acct_num,
+                         struct client_data* client, struct command_result* result);
+int apply_command(struct command_session* session, const struct command* command, struct command_result* result);
+int apply_command_retrying(struct command_session* session, const struct command* command,
+                           struct command_result* result);
+int command_write_status(int update_status, unsigned int acct_num, struct command_result* result);
+int apply_command_once(struct command_session* session, const struct command* command, struct command_result* result);
+void log_command(struct command_session* session, const struct command* command, struct command_result* result);
+void log_command_history(struct command_session* session, const struct command* command,
+                         const struct command_result* result);
+void write_command_result(FILE* output_ptr, const struct command* command, const struct command_result* result);
+const char* command_status_name(int status);
+const char* command_name(int type);
+int command_session_open(struct command_session* session, const char* data_path,
+                         const char* history_path, FILE* output_ptr);
+void command_session_close(struct command_session* session);
+void command_session_audit(struct command_session* session, struct audit_log* log);
+void command_session_share_table(struct command_session* session, struct account_table* table);
+int command_session_publish_view(struct command_session* session, const char* data_path);
+int execute_command_line(struct command_session* session, const char* line, size_t len);
+int read_command_line(FILE* script_ptr, char* line, size_t size, size_t* len);
+long run_command_script(FILE* script_ptr, const char* data_path, const char* history_path,
+                        FILE* output_ptr, int publish_view, struct audit_log* audit);
+
+/* Hot Accounts */
+int hot_store_open(struct hot_store* store, const char* data_path, const char* history_path,
+                   long long overdraft_limit_cents);
+void hot_store_close(struct hot_store* store);
+struct hot_account* hot_store_track(struct hot_store* store, unsigned int acct_num);
+int hot_account_add(struct hot_store* store, struct hot_account* account, long long cents);
+int hot_account_fold(struct hot_store* store, struct hot_account* account);
+long long hot_account_balance(struct hot_store* store, struct hot_account* account);
+void hot_store_fold_all(struct hot_store* store);
+void* hot_store_folder(void* arg);
+
+/* Account Table */
+struct account_table* account_table_load(FILE* data_ptr);
+void account_table_init(struct account_table* table);
+int account_table_reload(struct account_table* table, FILE* data_ptr);
+int account_table_read(struct account_table* table, int position, struct client_data* client);
+void account_table_publish(struct account_table* table, const struct client_data* clients,
+                           const int* positions, int count, int from_file);
+unsigned long account_table_snapshot(struct account_table* table, struct client_data* clients);
+int account_table_refresh(struct account_table* table, FILE* data_ptr, int position);
+int account_table_recover(struct account_table* table, FILE* data_ptr);
+
+/* Ingest Pipeline */
+int spsc_ring_init(struct spsc_ring* ring, size_t capacity);
+void spsc_ring_destroy(struct spsc_ring* ring);
+int spsc_ring_try_push(struct spsc_ring* ring, void* item);
+int spsc_ring_try_pop(struct spsc_ring* ring, void** item);
+void ring_backoff(unsigned int* attempts);
+void spsc_ring_push(struct spsc_ring* ring, void* item, struct stage_stats* stats);
+void* spsc_ring_pop(struct spsc_ring* ring, struct stage_stats* stats);
+void* ingest_parse_stage(void* arg);
+void* ingest_validate_stage(void* arg);
+void* ingest_apply_stage(void* arg);
+void ingest_log_stage(struct ingest_pipeline* pipeline);
+long run_ingest_pipeline(FILE* script_ptr, const char* data_path, const char* history_path,
+                         FILE* output_ptr, int publish_view, struct audit_log* audit, struct stage_stats* stats);
+
+/* Shared View */
+int shared_view_name(const char* data_path, char* name, size_t size);
+struct shared_view* shared_view_open(const char* data_path, FILE* data_ptr);
+void shared_view_close(struct shared_view* view);
+int shared_view_remove(const char* data_path);
+int print_shared_view(const char* data_path, unsigned int acct_num, FILE* output_ptr);
+
+/* Account Status Flags */
+struct account_flags* account_flags_open(const char* data_path, int create);
+void account_flags_close(struct account_flags* flags);
+int account_flag(const struct account_flags* flags, unsigned int acct_num, int flag);
+long account_flags_set(struct account_flags* flags, int flag, const unsigned int* accounts, long count, int on);
+int account_flags_refusal(const struct account_flags* flags, int command_type, unsigned int acct_num,
+                          unsigned int target_acct, char* detail, size_t size);
+void account_flags_note_balance(struct account_flags* flags, unsigned int acct_num, double balance);
+void account_flags_invalidate_index(const char* data_path);
+const char* account_flag_name(int flag);
+long read_account_list(int count, char* arguments[], unsigned int** accounts);
+int run_flag_command(const char* data_path, int flag, int on, int count, char* arguments[]);
+int print_account_flags(const char* data_path, FILE* output_ptr);
+
+/* Velocity Checks */
+int velocity_rules_read(const char* data_path, struct velocity_rules* rules);
+int velocity_rules_write(const char* data_path, const struct velocity_rules* rules);
+struct velocity_tracker* velocity_tracker_open(const char* data_path);
+void velocity_tracker_close(struct velocity_tracker* tracker);
+long long velocity_now(void);
+long long command_debit_cents(const struct command* command);
+void velocity_window_sums(struct velocity_window* window, long long bucket, long long* debits, long long* cents);
+int velocity_check(struct velocity_tracker* tracker, unsigned int acct_num, long long debits, long long cents,
+                   long long now,
+                   char* detail, size_t size);
+void velocity_record(struct velocity_tracker* tracker, unsigned int acct_num, long long cents, long long now);
+int run_velocity_command(const char* data_path, int count, char* arguments[]);
+
+/* Audit Trail */
+struct audit_log* audit_log_open(const char* data_path, long window_ms);
+int audit_log_close(struct audit_log* log, struct audit_stats* stats);
+struct audit_ring* audit_ring_attach(struct audit_log* log);
+void audit_ring_detach(struct audit_ring* ring);
+void audit_event_fill(struct audit_event* event, const struct command* command, int status);
+void audit_record(struct audit_ring* ring, const struct command* command, int status);
+int audit_append(const char* data_path, const struct command* command, int status);
+long audit_log_drain(struct audit_log* log, long long* oldest_ns);
+void* audit_writer(void* arg);
+int print_audit_trail(const char* data_path, FILE* output_ptr);
+
+/* Asynchronous Client */
+int account_client_open(struct account_client* client, const char* data_path, const char* history_path);
+void account_client_close(struct account_client* client);
+void account_client_submit(struct account_client* client, struct account_request* request);
+void account_client_read(struct account_client* client, struct account_request* request, unsigned int acct_num,
+                         account_callback done, void* context);
+void account_client_update(struct account_client* client, struct account_request* request, unsigned int acct_num,
+                           long long cents, account_callback done, void* context);
+void account_client_transfer(struct account_client* client, struct account_request* request,
+                             unsigned int from_acct, unsigned int to_acct, long long cents,
+                             account_callback done, void* context);
+void account_client_drain(struct account_client* client);
+void* account_client_service(void* arg);
+struct account_request* account_client_new_request(struct account_client* client, int cache);
+void account_client_free_request(struct account_client* client, int cache, struct account_request* request);
+
+/* Test Functions */
+int write_test_data_file(const char* path, const struct client_data* accounts, int count);
+int test_crud_operations(void);
+int test_input_validation(void);
+int test_account_management(void);
+int test_statement_generation(void);
+int test_bulk_import(void);
+int test_store_builder(void);
+int test_name_normalization(void);
+int test_amount_parsing(void);
+int run_test_script(int pipelined);
+int test_command_script(void);
+int test_ingest_pipeline(void);
+void pool_test_task(struct work_pool* pool, int worker, void* arg);
+int test_work_pool(void);
+void* hot_test_worker(void* arg);
+int test_hot_accounts(void);
+void* occ_test_worker(void* arg);
+int test_optimistic_updates(void);
+void* table_test_reader(void* arg);
+int test_account_table(void);
+int test_shared_view(void);
+void async_test_done(struct account_request* request, void* context);
+void async_test_chain(struct account_request* request, void* context);
+int test_async_client(void);
+int test_arena_allocator(void);
+void pool_test_done(struct account_request* request, void* context);
+void* pool_test_caller(void* arg);
+int test_object_pools(void);
+int test_name_dictionary(void);
+int test_record_schema(void);
+void* schema_test_teller(void* arg);
+int test_schema_evolution(void);
+int test_account_flags(void);
+void* audit_test_recorder(void* arg);
+int test_audit_trail(void);
+int test_interest_accrual(void);
+int test_overdraft_fees(void);
+int test_standing_orders(void);
+int test_velocity_checks(void);
+void run_all_tests(void);
+void demonstrate_crud_operations(void);
+
+/*
+ * MAIN FUNCTION
+ * Entry point for Version 03 - CRUD Operations
+ * 
+ * Usage:
+ *   version3                      run tests and the CRUD demonstration
+ *   version3 statements [output]  generate monthly statements ("-" = stdout)
+ *   version3 import <file> [threads]  load "acct last balance" rows (clients.dat
+ *                                     format or comma separated) in parallel
+ *   version3 build-store [--names] <file> [store]  bulk-load rows into a sorted, indexed
+ *                                 store file (--names: dictionary-encoded names)
+ *   version3 last-names [store]   accounts per last name in a store file
+ *   version3 find-name <last> [store]  accounts in a store file with that last name
+ *   version3 report [threads]     account totals from a parallel scan of the data file
+ *   version3 interest <rate%> [<balance>:<rate%>]...  credit tiered interest to every
+ *                                 positive balance, e.g. "interest 0.1 1000.00:0.15"
+ *   version3 fees [--rebuild] <fee> [<rate%> [<cap>]]  charge overdrawn accounts a fee plus
+ *                                 a rate on the amount overdrawn, e.g. "fees 25.00 1.5 40.00"
+ *   version3 order <from> <to> <amount> <every> [<times>]  add a standing order, e.g.
+ *                                 "order 17 42 50.00 1w" (intervals 12h, 1d, 2w...)
+ *   version3 orders               list the standing orders
+ *   version3 cancel-order <id>    stop a standing order
+ *   version3 run-orders           make every standing order that is due
+ *   version3 exec [script]        run one command per line from a script (default stdin)
+ *   version3 ingest [script]      same, on a four-stage pipeline with per-stage counters
+ *   version3 <command> [args]     run a single command, e.g. "version3 update 17 +25.00"
+ *   version3 view [account]       balances from the shared-memory view kept by the three above
+ *   version3 migrate [batch] [pause-ms]  start extended records: upgrade every record in the
+ *                                 background (commands upgrade the records they write)
+ *   version3 details <account>    a record with its extended fields
+ *   version3 freeze <account>...  freeze accounts ("-" reads the numbers from stdin)
+ *   version3 unfreeze <account>...
+ *   version3 flag <frozen|closed|overdraft> <on|off> <account>...  set or clear any status flag
+ *   version3 flags                accounts whose status flags differ from the defaults
+ *   version3 velocity [<debits> <amount> | off]  show, set or remove the limits on debits
+ *                                 per account per hour (0 = no limit), e.g. "velocity 20 5000.00"
+ *   version3 audit                print the audit trail (every command run by exec, ingest,
+ *                                 run-orders or a single command, and changes made in the menus)
+ *   version3 --data <file> ...    any of the above against another data file
+ *                                 (e.g. credit.dat, which uses the same record layout)
+ *   version3 --audit-window <ms> ...  how long audit events may wait in memory before
+ *                                 they are on disk (default AUDIT_WINDOW_MS)
+ */
+int main(int argc, char* argv[]) {
+    // Batch commands skip the tests and the demonstration
+    if (argc > 1) {
+        return run_batch_command(argc, argv);
+    }
+    
+    printf("=== Bank Account System - Version 03: CRUD Operations ===\n\n");
+    
+    // Initialize data file if needed
+    initialize_data_file_if_needed();
+    
+    // Run tests (TDD approach)
+    printf("Running CRUD Tests...\n");
+    run_all_tests();
+    
+    // Demonstrate CRUD operations
+    printf("\n=== CRUD Operations Demonstration ===\n");
+    demonstrate_crud_operations();
+    
+    return 0;
+}
+
+/*
+ * CREATE ACCOUNT (C in CRUD)
+ * 
+ * Purpose: Create a new bank account with user input
+ * Returns: 1 on success, 0 on failure
+ * 
+ * Process:
+ * 1. Get and validate account number
+ * 2. Check if account already exists
+ * 3. Get customer information
+ * 4. Validate all inputs
+ * 5. Write to file, unless someone created the account meanwhile
+ * 6. Confirm success
+ */
+int create_account(void) {
+    printf("\n=== CREATE NEW ACCOUNT ===\n");
+    
+    // Get account number
+    unsigned int acct_num = get_account_number("Enter new account number (1-100): ");
+    if (acct_num == 0) {
+        printf("Invalid account number. Operation cancelled.\n");
+        return 0;
+    }
+    
+    // Check if account already exists (the empty slot is kept to detect a concurrent create)
+    struct client_data slot;
+    if (!read_account_snapshot(acct_num, &slot)) {
+        printf("Error: Could not read data file.\n");
+        return 0;
+    }
+    if (slot.acct_num != 0) {
+        printf("Error: Account #%u already exists!\n", acct_num);
+        printf("Use UPDATE operation to modify existing accounts.\n");
+        return 0;
+    }
+    
+    // Get customer information
+    char last_name[15], first_name[10];
+    double initial_balance;
+    
+    get_name_input(last_name, sizeof(last_name), "Enter last name: ");
+    get_name_input(first_name, sizeof(first_name), "Enter first name: ");
+    initial_balance = get_balance_input("Enter initial balance: ");
+    
+    // Validate all inputs
+    if (!validate_name(last_name) || !validate_name(first_name)) {
+        printf("Error: Invalid name format. Names cannot be empty.\n");
+        return 0;
+    }
+    
+    // Create client structure
+    struct client_data new_client;
+    initialize_client(&new_client, acct_num, last_name, first_name, initial_balance);
+    
+    // Write to file
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) {
+        printf("Error: Could not open data file for writing.\n");
+        return 0;
+    }
+    
+    int position = acct_num - 1;  // Convert to 0-based index
+    int status = write_client_if_unchanged(file_ptr, &new_client, position, &slot);
+    close_data_file(file_ptr);
+    
+    if (status == UPDATE_CONFLICT) {
+        printf("❌ Error: Account #%u was created by someone else while you were typing.\n", acct_num);
+        return 0;
+    }
+    
+    if (status == UPDATE_OK) {
+        struct command audited = {.type = COMMAND_CREATE, .acct_num = acct_num,
+                                  .cents = balance_to_cents(initial_balance)};
+        audit_append(DATA_FILE, &audited, COMMAND_OK);
+        if (initial_balance < 0) {
+            struct account_flags* flags = account_flags_open(DATA_FILE, 0);
+            account_flags_note_balance(flags, acct_num, initial_balance);
+            if (flags != NULL) account_flags_close(flags);
+        }
+        printf("\n✅ Account created successfully!\n");
+        printf("Account Details:\n");
+        display_client(&new_client);
+        return 1;
+    } else {
+        printf("❌ Error: Could not create account. Please try again.\n");
+        return 0;
+    }
+}
+
+/*
+ * CORE FILE OPERATIONS
+ * (Simplified versions from Version 02)
+ */
+
+FILE* open_data_file(const char* mode) {
+    FILE* file_ptr = fopen(DATA_FILE, mode);
+    if (file_ptr == NULL) {
+        printf("Error: Could not open file '%s' in mode '%s'\n", DATA_FILE, mode);
+    }
+    return file_ptr;
+}
+
+int close_data_file(FILE* file_ptr) {
+    if (file_ptr == NULL) return -1;
+    return fclose(file_ptr);
+}
+
+int write_client_to_file(FILE* file_ptr, const struct client_data* client, int position) {
+    if (file_ptr == NULL || client == NULL || position < 0 || position >= MAX_ACCOUNTS) {
+        return 0;
+    }
+    
+    long file_position = position * RECORD_SIZE;
+    if (fseek(file_ptr, file_position, SEEK_SET) != 0) return 0;
+    
+    return (fwrite(client, RECORD_SIZE, 1, file_ptr) == 1);
+}
+
+int read_client_from_file(FILE* file_ptr, struct client_data* client, int position) {
+    if (file_ptr == NULL || client == NULL || position < 0 || position >= MAX_ACCOUNTS) {
+        return 0;
+    }
+    
+    long file_position = position * RECORD_SIZE;
+    if (fseek(file_ptr, file_position, SEEK_SET) != 0) return 0;
+    
+    return (fread(client, RECORD_SIZE, 1, file_ptr) == 1);
+}
+
+/*
+ * ACCOUNT_EXISTS
+ * 
+ * Purpose: Check if an account number is already in use
+ * Parameters: acct_num - account number to check
+ * Returns: 1 if exists, 0 if not exists or error
+ */
+int account_exists(unsigned int acct_num) {
+    if (!validate_account_number(acct_num)) return 0;
+    
+    FILE* file_ptr = open_data_file("rb");
+    if (file_ptr == NULL) return 0;
+    
+    struct client_data client;
+    int position = acct_num - 1;
+    int success = read_client_from_file(file_ptr, &client, position);
+    close_data_file(file_ptr);
+    
+    return (success && client.acct_num != 0);
+}
+
+/*
+ * OPTIMISTIC UPDATES
+ * 
+ * The interactive operations read a record, let the user think and
+ * type, and only then write. Instead of keeping the file open (or
+ * locked) all that time, they keep a snapshot of the record and write
+ * with write_client_if_unchanged: the write only happens if the
+ * record's version stamp is still the one in the snapshot, and it
+ * bumps the stamp. Another program that changed the record in the
+ * meantime turns the write into a conflict instead of being silently
+ * overwritten - provided it bumps the stamp too. Every writer of the
+ * data file does: this program, tcopab's update/new/delete and
+ * version2's write_client_to_file. A program that writes records
+ * without bumping the stamp is invisible to the check.
+ * 
+ * Files written before the stamp existed have padding in its place,
+ * often not zero (credit.dat has garbage there). Whatever is there is
+ * simply taken as the starting version: the check only compares stamps
+ * for equality, so any starting value works.
+ * 
+ * The check and the write are made atomic with a lock on just the
+ * record's bytes, held for a pread and a pwrite - microseconds, never
+ * across a prompt. Open-file-description locks are used where
+ * available so threads with their own FILE exclude each other too.
+ * The 16-bit stamp wraps after 65536 updates; a record would have to
+ * change exactly that often during one edit to be missed.
+ */
+
+/*
+ * READ_ACCOUNT_SNAPSHOT
+ * 
+ * Purpose: Read a record (version stamp included) without keeping the file open
+ * Returns: 1 on success, 0 if it could not be read
+ */
+int read_account_snapshot(unsigned int acct_num, struct client_data* client) {
+    FILE* file_ptr = open_data_file("rb");
+    if (file_ptr == NULL) return 0;
+    
+    int success = read_client_from_file(file_ptr, client, acct_num - 1);
+    close_data_file(file_ptr);
+    return success;
+}
+
+/*
+ * LOCK_RECORD
+ * 
+ * Purpose: Take (lock = 1) or release (lock = 0) a write lock on one
+ * record of an open data file, waiting for other holders
+ * Returns: 1 on success, 0 on failure
+ */
+int lock_record(int fd, int position, int lock) {
+    return lock_record_range(fd, position, 1, lock);
+}
+
+/*
+ * LOCK_RECORD_RANGE
+ * 
+ * Purpose: lock_record for 'count' consecutive records with one call
+ * (batch jobs), excluding writers of any record in the range
+ */
+int lock_record_range(int fd, long first_position, long count, int lock) {
+    struct flock range;
+    memset(&range, 0, sizeof(range));
+    range.l_type = lock ? F_WRLCK : F_UNLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = (off_t)first_position * RECORD_SIZE;
+    range.l_len = (off_t)count * RECORD_SIZE;
+    
+#ifdef F_OFD_SETLKW
+    return (fcntl(fd, F_OFD_SETLKW, &range) == 0);
+#else
+    return (fcntl(fd, F_SETLKW, &range) == 0);  // Process-wide: threads share these locks
+#endif
+}
+
+/*
+ * WRITE_CLIENTS_IF_UNCHANGED
+ * 
+ * Purpose: Compare-on-write for one or more records at once
+ * Parameters:
+ *   - clients: new contents; their version is set to expected + 1
+ *   - expected: the snapshots the new contents were computed from
+ *   - positions: record positions, in any order
+ *   - count: number of records (at most 2)
+ * Returns: UPDATE_OK if every record still matched its snapshot and all
+ * were written, UPDATE_CONFLICT if any had changed (nothing written),
+ * UPDATE_FAILED on an I/O error
+ * 
+ * A record matches when its account number and version are the ones in
+ * the snapshot. Locks are taken in position order so two writers of the
+ * same pair cannot deadlock.
+ */
+int write_clients_if_unchanged(FILE* file_ptr, struct client_data* clients,
+                               const struct client_data* expected, const int* positions, int count) {
+    return write_clients_upgrading(file_ptr, NULL, clients, expected, positions, count);
+}
+
+/*
+ * WRITE_CLIENTS_UPGRADING
+ * 
+ * Purpose: write_clients_if_unchanged that also upgrades base-format
+ * records to the extended format (see SCHEMA EVOLUTION)
+ * Parameters: extension_ptr - the data file's extension file (NULL = no upgrade)
+ * 
+ * An upgraded record gets a default extension, written under the same
+ * record lock before the record itself, so a record never points at an
+ * extension that is not there yet. A record that is being created gets
+ * today's date as its opening date.
+ */
+int write_clients_upgrading(FILE* file_ptr, FILE* extension_ptr, struct client_data* clients,
+                            const struct client_data* expected, const int* positions, int count) {
+    if (file_ptr == NULL || count < 1 || count > 2) return UPDATE_FAILED;
+    for (int i = 0; i < count; i++) {
+        if (positions[i] < 0 || positions[i] >= MAX_ACCOUNTS) return UPDATE_FAILED;
+    }
+    if (count == 2 && positions[0] == positions[1]) return UPDATE_FAILED;
+    
+    // Pending stdio writes must reach the file before it is read behind stdio's back
+    if (fflush(file_ptr) != 0) return UPDATE_FAILED;
+    int fd = fileno(file_ptr);
+    
+    int order[2] = {0, 1};
+    if (count == 2 && positions[1] < positions[0]) {
+        order[0] = 1;
+        order[1] = 0;
+    }
+    
+    int locked = 0;
+    int status = UPDATE_OK;
+    while (locked < count && status == UPDATE_OK) {
+        if (lock_record(fd, positions[order[locked]], 1)) {
+            locked++;
+        } else {
+            status = UPDATE_FAILED;
+        }
+    }
+    
+    for (int i = 0; status == UPDATE_OK && i < count; i++) {
+        struct client_data current;
+        off_t offset = (off_t)positions[i] * RECORD_SIZE;
+        if (pread(fd, &current, RECORD_SIZE, offset) != (ssize_t)RECORD_SIZE) {
+            status = UPDATE_FAILED;
+        } else if (current.acct_num != expected[i].acct_num || current.version != expected[i].version) {
+            status = UPDATE_CONFLICT;
+        }
+    }
+    
+    for (int i = 0; status == UPDATE_OK && extension_ptr != NULL && i < count; i++) {
+        // A new account always starts with a fresh extension
+        if (clients[i].acct_num == 0 ||
+            (expected[i].acct_num != 0 && record_has_extension(extension_ptr, positions[i], &expected[i], NULL))) {
+            continue;
+        }
+        
+        struct client_extension extension;
+        default_extension(&clients[i], expected[i].acct_num == 0 ? today_date() : 0, &extension);
+        off_t offset = (off_t)positions[i] * sizeof(struct client_extension);
+        if (pwrite(fileno(extension_ptr), &extension, sizeof(extension), offset) != (ssize_t)sizeof(extension)) {
+            status = UPDATE_FAILED;
+        }
+        clients[i].format = RECORD_FORMAT_EXTENDED;
+    }
+    
+    for (int i = 0; status == UPDATE_OK && i < count; i++) {
+        clients[i].version = (unsigned short)(expected[i].version + 1);
+        off_t offset = (off_t)positions[i] * RECORD_SIZE;
+        if (pwrite(fd, &clients[i], RECORD_SIZE, offset) != (ssize_t)RECORD_SIZE) status = UPDATE_FAILED;
+    }
+    
+    while (locked > 0) lock_record(fd, positions[order[--locked]], 0);
+    return status;
+}
+
+/*
+ * WRITE_CLIENT_IF_UNCHANGED
+ * 
+ * Purpose: Compare-on-write for a single record (see write_clients_if_unchanged)
+ */
+int write_client_if_unchanged(FILE* file_ptr, struct client_data* client, int position,
+                              const struct client_data* expected) {
+    return write_clients_if_unchanged(file_ptr, client, expected, &position, 1);
+}
+
+/*
+ * SCHEMA EVOLUTION
+ * 
+ * New account fields (status, opening date, overdraft limit, currency)
+ * do not fit the fixed 40-byte record, and making the record bigger
+ * would mean rewriting every data file at once. Instead records come in
+ * two formats, told apart by the record's 'format' byte:
+ * 
+ *   RECORD_FORMAT_BASE      the 40-byte record only; the new fields
+ *                           have their defaults
+ *   RECORD_FORMAT_EXTENDED  plus a client_extension at the same
+ *                           position in "<data file>.ext"
+ * 
+ * Both formats live side by side in the same data file, and reading a
+ * base record costs exactly the read it always did: the format byte
+ * says there is nothing more to fetch.
+ * 
+ * The format byte used to be padding, and older files have whatever
+ * happened to be there (credit.dat has 85 and 86). So a 1 alone does
+ * not make a record extended: its extension must also carry the
+ * record's account number (record_has_extension). Any other record,
+ * whatever its format byte, is read and upgraded as a base record.
+ * 
+ * A data file starts using extensions once "version3 migrate" has
+ * created its extension file. From then on:
+ * 
+ * - every write through a command session upgrades the records it
+ *   writes (write_clients_upgrading), so active accounts move over on
+ *   their own;
+ * - the migrator upgrades the rest in small batches with pauses in
+ *   between, through the same compare-on-write as the tellers. A record
+ *   a teller changes mid-way is skipped and picked up on the next pass.
+ * 
+ * Programs that know nothing about extensions (tcopab, version2, the
+ * interactive menu) copy the format byte along with the rest of the
+ * record, so they keep extended records extended. When they delete an
+ * account they write an empty, base-format record, and its old
+ * extension is ignored from then on.
+ */
+
+/*
+ * EXTENSION_PATH / OPEN_EXTENSION_FILE
+ * 
+ * Purpose: Name and open the extension file of a data file
+ * Parameters: create - 1 to create the file if it does not exist yet
+ * Returns: 1 if the name fits / the open file, or NULL if it does not
+ * exist (and create is 0) or cannot be opened
+ */
+int extension_path(const char* data_path, char* path, size_t size) {
+    int length = snprintf(path, size, "%s%s", data_path, EXTENSION_SUFFIX);
+    return (length > 0 && (size_t)length < size);
+}
+
+FILE* open_extension_file(const char* data_path, int create) {
+    char path[1024];
+    if (!extension_path(data_path, path, sizeof(path))) return NULL;
+    
+    int fd = open(path, O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (fd < 0) return NULL;
+    FILE* extension_ptr = fdopen(fd, "r+b");
+    if (extension_ptr == NULL) close(fd);
+    return extension_ptr;
+}
+
+/*
+ * DEFAULT_EXTENSION
+ * 
+ * Purpose: The extended fields of a record that has no extension yet
+ * Parameters: open_date - YYYYMMDD, or 0 if unknown
+ */
+void default_extension(const struct client_data* client, int open_date, struct client_extension* extension) {
+    memset(extension, 0, sizeof(*extension));
+    extension->acct_num = client->acct_num;
+    extension->status = ACCOUNT_STATUS_ACTIVE;
+    memcpy(extension->currency, "USD", sizeof(extension->currency));
+    extension->open_date = open_date;
+    extension->overdraft_limit_cents = DEFAULT_OVERDRAFT_LIMIT_CENTS;
+}
+
+int today_date(void) {
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    return (local.tm_year + 1900) * 10000 + (local.tm_mon + 1) * 100 + local.tm_mday;
+}
+
+/*
+ * READ_CLIENT_EXTENDED
+ * 
+ * Purpose: Read a record together with its extended fields
+ * Parameters: extension_ptr - the extension file (NULL: defaults for every record)
+ * Returns: 1 on success, 0 if the record could not be read
+ * 
+ * Only an extended record costs a second read. Like read_client_from_file
+ * this takes no lock; a reader racing a writer may pair the new record
+ * with the previous extension. A record whose format byte claims an
+ * extension that is not there comes back as a base record.
+ */
+int read_client_extended(FILE* file_ptr, FILE* extension_ptr, int position,
+                         struct client_data* client, struct client_extension* extension) {
+    if (!read_client_from_file(file_ptr, client, position)) return 0;
+    if (record_has_extension(extension_ptr, position, client, extension)) return 1;
+    
+    if (extension_ptr != NULL) client->format = RECORD_FORMAT_BASE;
+    default_extension(client, 0, extension);
+    return 1;
+}
+
+/*
+ * RECORD_HAS_EXTENSION
+ * 
+ * Purpose: Tell an extended record from one with a stray format byte
+ * Parameters: extension - receives the extension if there is one (may be NULL)
+ * Returns: 1 if the record is marked extended and its extension names
+ * the same account, 0 otherwise
+ */
+int record_has_extension(FILE* extension_ptr, int position, const struct client_data* client,
+                         struct client_extension* extension) {
+    struct client_extension stored;
+    if (client->format != RECORD_FORMAT_EXTENDED || extension_ptr == NULL ||
+        pread(fileno(extension_ptr), &stored, sizeof(stored), (off_t)position * sizeof(stored)) !=
+            (ssize_t)sizeof(stored) ||
+        stored.acct_num != client->acct_num) {
+        return 0;
+    }
+    if (extension != NULL) *extension = stored;
+    return 1;
+}
+
+/*
+ * SET_CLIENT_EXTENSION
+ * 
+ * Purpose: Change the extended fields of an account, upgrading its record if needed
+ * Returns: UPDATE_OK, or UPDATE_FAILED if the account does not exist
+ * (extension->acct_num names it) or on an I/O error
+ * 
+ * The record's version is bumped, so a teller holding an older snapshot
+ * gets a conflict instead of writing the record back as base format.
+ */
+int set_client_extension(FILE* file_ptr, FILE* extension_ptr, int position,
+                         const struct client_extension* extension) {
+    if (file_ptr == NULL || extension_ptr == NULL || position < 0 || position >= MAX_ACCOUNTS) return UPDATE_FAILED;
+    if (fflush(file_ptr) != 0) return UPDATE_FAILED;
+    
+    int fd = fileno(file_ptr);
+    if (!lock_record(fd, position, 1)) return UPDATE_FAILED;
+    
+    struct client_data current;
+    off_t offset = (off_t)position * RECORD_SIZE;
+    int status = UPDATE_FAILED;
+    if (pread(fd, &current, RECORD_SIZE, offset) == (ssize_t)RECORD_SIZE &&
+        current.acct_num != 0 && current.acct_num == extension->acct_num &&
+        pwrite(fileno(extension_ptr), extension, sizeof(*extension),
+               (off_t)position * sizeof(*extension)) == (ssize_t)sizeof(*extension)) {
+        current.format = RECORD_FORMAT_EXTENDED;
+        current.version++;
+        if (pwrite(fd, &current, RECORD_SIZE, offset) == (ssize_t)RECORD_SIZE) status = UPDATE_OK;
+    }
+    
+    lock_record(fd, position, 0);
+    return status;
+}
+
+/*
+ * MIGRATE_RECORDS
+ * 
+ * Purpose: Upgrade the base-format records among 'count' positions from 'first'
+ * Parameters: conflicts - incremented for every record skipped because it changed
+ * Returns: the number of records upgraded, or -1 on an I/O error
+ */
+long migrate_records(FILE* file_ptr, FILE* extension_ptr, long first, long count, long* conflicts) {
+    if (fflush(file_ptr) != 0) return -1;
+    
+    long migrated = 0;
+    for (long position = first; position < first + count && position < MAX_ACCOUNTS; position++) {
+        struct client_data snapshot;
+        if (pread(fileno(file_ptr), &snapshot, RECORD_SIZE, (off_t)position * RECORD_SIZE) != (ssize_t)RECORD_SIZE) {
+            break;  // End of the file
+        }
+        if (snapshot.acct_num == 0 || record_has_extension(extension_ptr, (int)position, &snapshot, NULL)) continue;
+        
+        struct client_data client = snapshot;
+        int target = (int)position;
+        int status = write_clients_upgrading(file_ptr, extension_ptr, &client, &snapshot, &target, 1);
+        if (status == UPDATE_FAILED) return -1;
+        if (status == UPDATE_CONFLICT) {
+            (*conflicts)++;
+        } else {
+            migrated++;
+        }
+    }
+    return migrated;
+}
+
+/*
+ * SCHEMA_MIGRATOR_START
+ * 
+ * Purpose: Start upgrading a data file in the background
+ * Parameters: batch, pause_ms - records per batch and the pause after
+ * each one (0 = MIGRATE_BATCH / MIGRATE_PAUSE_MS)
+ * Returns: 1 if the migrator thread is running, 0 otherwise
+ * 
+ * The migrator finishes by itself after a pass that found nothing left
+ * to upgrade; wait for that with schema_migrator_join, or end it early
+ * with schema_migrator_stop. Either must be called exactly once.
+ */
+int schema_migrator_start(struct schema_migrator* migrator, const char* data_path, long batch, long pause_ms) {
+    memset(migrator, 0, sizeof(*migrator));
+    migrator->data_path = data_path;
+    migrator->batch = (batch > 0) ? batch : MIGRATE_BATCH;
+    migrator->pause_ms = (pause_ms > 0) ? pause_ms : MIGRATE_PAUSE_MS;
+    atomic_init(&migrator->stopping, 0);
+    return (pthread_create(&migrator->thread, NULL, schema_migrator_run, migrator) == 0);
+}
+
+void* schema_migrator_run(void* arg) {
+    struct schema_migrator* migrator = arg;
+    FILE* file_ptr = fopen(migrator->data_path, "rb+");
+    FILE* extension_ptr = (file_ptr != NULL) ? open_extension_file(migrator->data_path, 1) : NULL;
+    migrator->ok = (extension_ptr != NULL);
+    
+    struct timespec pause = {migrator->pause_ms / 1000, (migrator->pause_ms % 1000) * 1000000L};
+    int done = !migrator->ok;
+    while (!done && !atomic_load(&migrator->stopping)) {
+        long conflicts = 0;
+        
+        for (long first = 0; first < MAX_ACCOUNTS && !atomic_load(&migrator->stopping); first += migrator->batch) {
+            long migrated = migrate_records(file_ptr, extension_ptr, first, migrator->batch, &conflicts);
+            if (migrated < 0) {
+                migrator->ok = 0;
+                break;
+            }
+            migrator->migrated += migrated;
+            nanosleep(&pause, NULL);
+        }
+        
+        migrator->conflicts += conflicts;
+        migrator->passes++;
+        // Finished once a whole pass left nothing to retry
+        done = !migrator->ok || conflicts == 0;
+    }
+    
+    if (extension_ptr != NULL) fclose(extension_ptr);
+    if (file_ptr != NULL) fclose(file_ptr);
+    return NULL;
+}
+
+void schema_migrator_join(struct schema_migrator* migrator) {
+    pthread_join(migrator->thread, NULL);
+}
+
+void schema_migrator_stop(struct schema_migrator* migrator) {
+    atomic_store(&migrator->stopping, 1);
+    pthread_join(migrator->thread, NULL);
+}
+
+/*
+ * READ ACCOUNT (R in CRUD)
+ * 
+ * Purpose: Display account information for a specific account
+ * Returns: 1 on success, 0 on failure
+ */
+int read_account(void) {
+    printf("\n=== READ ACCOUNT INFORMATION ===\n");
+    
+    unsigned int acct_num = get_account_number("Enter account number to view (1-100): ");
+    if (acct_num == 0) {
+        printf("Invalid account number. Operation cancelled.\n");
+        return 0;
+    }
+    
+    FILE* file_ptr = open_data_file("rb");
+    if (file_ptr == NULL) {
+        printf("Error: Could not open data file for reading.\n");
+        return 0;
+    }
+    
+    struct client_data client;
+    int position = acct_num - 1;
+    int success = read_client_from_file(file_ptr, &client, position);
+    close_data_file(file_ptr);
+    
+    if (success && client.acct_num != 0) {
+        printf("\n✅ Account found!\n");
+        display_client(&client);
+        return 1;
+    } else {
+        printf("❌ Account #%u not found or is empty.\n", acct_num);
+        return 0;
+    }
+}
+
+/*
+ * UPDATE ACCOUNT (U in CRUD)
+ * 
+ * Purpose: Modify existing account information
+ * Returns: 1 on success, 0 on failure
+ * 
+ * Update Options:
+ * 1. Add/subtract from balance (transactions)
+ * 2. Update customer names
+ * 3. Complete account information update
+ * 
+ * The record is written with a compare-on-write against the copy read
+ * before prompting. A transaction that loses the race is re-applied to
+ * the new balance; a name or full update is refused instead, since it
+ * would overwrite what the other user entered.
+ */
+int update_account(void) {
+    printf("\n=== UPDATE ACCOUNT ===\n");
+    
+    unsigned int acct_num = get_account_number("Enter account number to update (1-100): ");
+    if (acct_num == 0) {
+        printf("Invalid account number. Operation cancelled.\n");
+        return 0;
+    }
+    
+    // Frozen and closed accounts are turned away before the record is read
+    struct account_flags* flags = account_flags_open(DATA_FILE, 0);
+    int refusal = account_flags_refusal(flags, COMMAND_UPDATE, acct_num, 0, NULL, 0);
+    int overdraft_allowed = account_flag(flags, acct_num, ACCOUNT_OVERDRAFT);
+    if (flags != NULL) account_flags_close(flags);
+    if (refusal != COMMAND_OK) {
+        printf("❌ Account #%u is %s. Operation cancelled.\n", acct_num, refusal == COMMAND_FROZEN ? "frozen" : "closed");
+        return 0;
+    }
+    
+    // Read existing account; the file is not kept open while the user types
+    struct client_data snapshot;
+    int position = acct_num - 1;
+    if (!read_account_snapshot(acct_num, &snapshot) || snapshot.acct_num == 0) {
+        printf("❌ Account #%u not found. Use CREATE to add new accounts.\n", acct_num);
+        return 0;
+    }
+    struct client_data client = snapshot;
+    
+    printf("\nCurrent Account Information:\n");
+    display_client(&client);
+    
+    // Update menu
+    printf("\nUpdate Options:\n");
+    printf("1. Update balance (add/subtract transaction)\n");
+    printf("2. Update customer names\n");
+    printf("3. Update all information\n");
+    printf("Enter choice (1-3): ");
+    
+    int choice;
+    double transaction = 0.0;  // Amount recorded in the history (choice 1 only)
+    if (scanf("%d", &choice) != 1) {
+        printf("Invalid input. Operation cancelled.\n");
+        clear_input_buffer();
+        return 0;
+    }
+    clear_input_buffer();
+    
+    switch (choice) {
+        case 1: {
+            // Balance update (transaction)
+            transaction = get_balance_input("Enter transaction amount (+credit/-debit): ");
+            double old_balance = client.balance;
+            client.balance += transaction;
+            
+            printf("\nTransaction Summary:\n");
+            printf("Previous Balance: $%.2f\n", old_balance);
+            printf("Transaction:      $%.2f\n", transaction);
+            printf("New Balance:      $%.2f\n", client.balance);
+            
+            if (transaction < 0 && client.balance < 0 && !overdraft_allowed) {
+                printf("❌ Account #%u may not be overdrawn. Transaction cancelled.\n", acct_num);
+                return 0;
+            }
+            break;
+        }
+        case 2: {
+            // Name update
+            printf("Current: %s, %s\n", client.last_name, client.first_name);
+            get_name_input(client.last_name, sizeof(client.last_name), "Enter new last name: ");
+            get_name_input(client.first_name, sizeof(client.first_name), "Enter new first name: ");
+            
+            if (!validate_name(client.last_name) || !validate_name(client.first_name)) {
+                printf("Error: Invalid name format. Update cancelled.\n");
+                return 0;
+            }
+            break;
+        }
+        case 3: {
+            // Complete update
+            get_name_input(client.last_name, sizeof(client.last_name), "Enter new last name: ");
+            get_name_input(client.first_name, sizeof(client.first_name), "Enter new first name: ");
+            client.balance = get_balance_input("Enter new balance: ");
+            
+            if (!validate_name(client.last_name) || !validate_name(client.first_name)) {
+                printf("Error: Invalid name format. Update cancelled.\n");
+                return 0;
+            }
+            // Lowering the balance below zero is a debit like any other
+            if (client.balance < 0 && client.balance < snapshot.balance && !overdraft_allowed) {
+                printf("❌ Account #%u may not be overdrawn. Update cancelled.\n", acct_num);
+                return 0;
+            }
+            break;
+        }
+        default:
+            printf("Invalid choice. Operation cancelled.\n");
+            return 0;
+    }
+    
+    // A debit beyond the velocity limits is turned away too
+    long long debit = balance_to_cents(snapshot.balance) - balance_to_cents(client.balance);
+    struct velocity_tracker* velocity = (debit > 0) ? velocity_tracker_open(DATA_FILE) : NULL;
+    char detail[128];
+    if (velocity != NULL &&
+        velocity_check(velocity, acct_num, 1, debit, velocity_now(), detail, sizeof(detail)) != COMMAND_OK) {
+        printf("❌ Velocity limit: %s. Update cancelled.\n", detail);
+        velocity_tracker_close(velocity);
+        return 0;
+    }
+    
+    // Write updated record, unless someone else changed it in the meantime
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) {
+        printf("Error: Could not open data file for updating.\n");
+        if (velocity != NULL) velocity_tracker_close(velocity);
+        return 0;
+    }
+    int status = write_client_if_unchanged(file_ptr, &client, position, &snapshot);
+    
+    // A transaction is a change, not a new value, so it can be applied again to the newer balance
+    for (int retry = 0; status == UPDATE_CONFLICT && choice == 1 && retry < UPDATE_RETRY_LIMIT; retry++) {
+        if (!read_client_from_file(file_ptr, &snapshot, position) || snapshot.acct_num != acct_num) break;
+        
+        client = snapshot;
+        client.balance = snapshot.balance + transaction;
+        if (transaction < 0 && client.balance < 0 && !overdraft_allowed) break;
+        printf("Note: The balance changed meanwhile; applying the transaction to $%.2f.\n", snapshot.balance);
+        status = write_client_if_unchanged(file_ptr, &client, position, &snapshot);
+    }
+    close_data_file(file_ptr);
+    if (velocity != NULL) {
+        if (status == UPDATE_OK) velocity_record(velocity, acct_num, debit, velocity_now());
+        velocity_tracker_close(velocity);
+    }
+    
+    if (status == UPDATE_CONFLICT) {
+        printf("❌ Account #%u was changed by someone else while you were editing. Changes not saved.\n", acct_num);
+        return 0;
+    }
+    
+    int success = (status == UPDATE_OK);
+    if (success && choice == 1) {
+        log_transaction(acct_num, transaction, client.balance);
+    }
+    if (success) {
+        struct command audited = {.type = COMMAND_UPDATE, .acct_num = acct_num,
+                                  .cents = balance_to_cents(client.balance) - balance_to_cents(snapshot.balance)};
+        audit_append(DATA_FILE, &audited, COMMAND_OK);
+    }
+    if (success && client.balance < 0) {
+        flags = account_flags_open(DATA_FILE, 0);
+        account_flags_note_balance(flags, acct_num, client.balance);
+        if (flags != NULL) account_flags_close(flags);
+    }
+    
+    if (success) {
+        printf("\n✅ Account updated successfully!\n");
+        printf("Updated Account Information:\n");
+        display_client(&client);
+        return 1;
+    } else {
+        printf("❌ Error: Could not update account. Changes not saved.\n");
+        return 0;
+    }
+}
+
+/*
+ * DELETE ACCOUNT (D in CRUD)
+ * 
+ * Purpose: Remove an account from the system
+ * Returns: 1 on success, 0 on failure
+ * 
+ * Safety Features:
+ * - Shows account before deletion
+ * - Requires confirmation
+ * - Warns about balance if non-zero
+ * - Refuses if the account changed while waiting for the confirmation
+ */
+int delete_account(void) {
+    printf("\n=== DELETE ACCOUNT ===\n");
+    
+    unsigned int acct_num = get_account_number("Enter account number to delete (1-100): ");
+    if (acct_num == 0) {
+        printf("Invalid account number. Operation cancelled.\n");
+        return 0;
+    }
+    
+    // A frozen account is turned away before the record is read
+    struct account_flags* flags = account_flags_open(DATA_FILE, 0);
+    int refusal = account_flags_refusal(flags, COMMAND_DELETE, acct_num, 0, NULL, 0);
+    if (flags != NULL) account_flags_close(flags);
+    if (refusal != COMMAND_OK) {
+        printf("❌ Account #%u is frozen. Deletion cancelled.\n", acct_num);
+        return 0;
+    }
+    
+    // Read existing account; the file is not kept open during the confirmation
+    struct client_data client;
+    int position = acct_num - 1;
+    if (!read_account_snapshot(acct_num, &client) || client.acct_num == 0) {
+        printf("❌ Account #%u not found or already empty.\n", acct_num);
+        return 0;
+    }
+    
+    printf("\nAccount to be deleted:\n");
+    display_client(&client);
+    
+    // Warning for non-zero balance
+    if (client.balance != 0.0) {
+        printf("⚠️  WARNING: This account has a balance of $%.2f\n", client.balance);
+        printf("Deleting will remove this balance permanently.\n");
+    }
+    
+    // Confirmation
+    printf("\nAre you sure you want to delete this account? (y/N): ");
+    char confirmation;
+    if (scanf(" %c", &confirmation) != 1) {
+        printf("Invalid input. Deletion cancelled.\n");
+        clear_input_buffer();
+        return 0;
+    }
+    clear_input_buffer();
+    
+    if (tolower(confirmation) != 'y') {
+        printf("Deletion cancelled by user.\n");
+        return 0;
+    }
+    
+    // Create empty record for deletion
+    struct client_data empty_client = CLIENT_RECORD(0, "", "", 0.0);
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) {
+        printf("Error: Could not open data file for deletion.\n");
+        return 0;
+    }
+    int status = write_client_if_unchanged(file_ptr, &empty_client, position, &client);
+    close_data_file(file_ptr);
+    
+    if (status == UPDATE_CONFLICT) {
+        printf("❌ Account #%u was changed while you were confirming. Deletion cancelled.\n", acct_num);
+        return 0;
+    }
+    
+    if (status == UPDATE_OK) {
+        struct command audited = {.type = COMMAND_DELETE, .acct_num = acct_num};
+        audit_append(DATA_FILE, &audited, COMMAND_OK);
+        printf("\n✅ Account #%u deleted successfully!\n", acct_num);
+        return 1;
+    } else {
+        printf("❌ Error: Could not delete account. Please try again.\n");
+        return 0;
+    }
+}
+
+/*
+ * INPUT VALIDATION FUNCTIONS
+ * 
+ * These functions handle user input safely and validate data
+ */
+
+/*
+ * GET_ACCOUNT_NUMBER
+ * 
+ * Purpose: Get and validate account number from user
+ * Parameters: prompt - message to display to user
+ * Returns: valid account number (1-100) or 0 on error
+ */
+unsigned int get_account_number(const char* prompt) {
+    unsigned int acct_num;
+    
+    printf("%s", prompt);
+    
+    if (scanf("%u", &acct_num) != 1) {
+        printf("Error: Please enter a valid number.\n");
+        clear_input_buffer();
+        return 0;
+    }
+    clear_input_buffer();
+    
+    if (!validate_account_number(acct_num)) {
+        printf("Error: Account number must be between %d and %d.\n", 
+               MIN_ACCOUNT_NUM, MAX_ACCOUNT_NUM);
+        return 0;
+    }
+    
+    return acct_num;
+}
+
+/*
+ * GET_BALANCE_INPUT
+ * 
+ * Purpose: Get and validate balance/transaction amount from user
+ * Parameters: prompt - message to display to user
+ * Returns: entered balance amount
+ */
+double get_balance_input(const char* prompt) {
+    char line[64];
+    
+    printf("%s", prompt);
+    
+    if (fgets(line, sizeof(line), stdin) == NULL) {
+        printf("Error: Please enter a valid amount.\n");
+        return 0.0;
+    }
+    if (strchr(line, '\n') == NULL) clear_input_buffer();  // Drop the rest of a long line
+    
+    long long cents;
+    size_t error_position;
+    int status = parse_amount_cents(line, strlen(line), &cents, &error_position);
+    if (status != AMOUNT_OK) {
+        printf("Error: %s at character %zu. Please enter a valid amount.\n",
+               amount_error_message(status), error_position + 1);
+        return 0.0;
+    }
+    
+    return cents / 100.0;
+}
+
+/*
+ * GET_NAME_INPUT
+ * 
+ * Purpose: Get and validate name input from user
+ * Parameters: 
+ *   - buffer: where to store the input
+ *   - max_length: maximum length of input
+ *   - prompt: message to display
+ */
+void get_name_input(char* buffer, int max_length, const char* prompt) {
+    printf("%s", prompt);
+    
+    if (fgets(buffer, max_length, stdin) != NULL) {
+        // Remove newline if present
+        size_t len = strlen(buffer);
+        if (len > 0 && buffer[len - 1] == '\n') {
+            buffer[len - 1] = '\0';
+        }
+        
+        // Trim leading and trailing spaces
+        trim_name(buffer);
+    } else {
+        buffer[0] = '\0';  // Empty string on error
+    }
+}
+
+/*
+ * CLEAR_INPUT_BUFFER
+ * 
+ * Purpose: Clear any remaining characters from input buffer
+ * This prevents issues with subsequent input operations
+ */
+void clear_input_buffer(void) {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+}
+
+/*
+ * VALIDATE_ACCOUNT_NUMBER
+ * 
+ * Purpose: Check if account number is in valid range
+ * Parameters: acct_num - account number to validate
+ * Returns: 1 if valid, 0 if invalid
+ */
+int validate_account_number(unsigned int acct_num) {
+    return (acct_num >= MIN_ACCOUNT_NUM && acct_num <= MAX_ACCOUNT_NUM);
+}
+
+/*
+ * VALIDATE_NAME
+ * 
+ * Purpose: Check if name is valid (not empty, reasonable length)
+ * Parameters: name - string to validate
+ * Returns: 1 if valid, 0 if invalid
+ */
+int validate_name(const char* name) {
+    if (name == NULL) return 0;
+    
+    size_t len = strlen(name);
+    
+    // Check if empty or too short
+    if (len == 0) return 0;
+    
+    // Check for valid characters (letters, spaces, hyphens, apostrophes)
+    return name_chars_valid(name, len);
+}
+
+/*
+ * NAME CHARACTER CLASSES
+ * 
+ * Names are checked 16 bytes at a time: with SSE2 one block is
+ * classified by a handful of vector compares, and each class comes
+ * back as a 16-bit mask (bit i = byte i), so whole names are accepted
+ * or trimmed with a few bit operations instead of a loop per character.
+ * Letters are ASCII letters, as isalpha() reports them in the C locale.
+ */
+
+/*
+ * NAME_BLOCK_MASKS
+ * 
+ * Purpose: Classify 16 bytes at once
+ * Parameters:
+ *   - block: 16 readable bytes
+ *   - space_mask: receives the whitespace bits
+ *   - nul_mask: receives the bits of '\0' bytes
+ * Returns: bit mask of the bytes allowed in a name
+ */
+unsigned int name_block_masks(const char* block, unsigned int* space_mask, unsigned int* nul_mask) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i*)block);
+    
+    // Letter: (c | 0x20) - 'a' <= 25, compared as unsigned bytes
+    __m128i folded = _mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i letter = _mm_cmpeq_epi8(_mm_min_epu8(folded, _mm_set1_epi8(25)), folded);
+    
+    __m128i space = _mm_cmpeq_epi8(bytes, _mm_set1_epi8(' '));
+    __m128i punctuation = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('-')),
+                                       _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\'')));
+    
+    // Whitespace: ' ' or '\t'..'\r' (c - '\t' <= 4 as unsigned)
+    __m128i control = _mm_sub_epi8(bytes, _mm_set1_epi8('\t'));
+    __m128i blank = _mm_or_si128(space, _mm_cmpeq_epi8(_mm_min_epu8(control, _mm_set1_epi8(4)), control));
+    
+    *space_mask = (unsigned int)_mm_movemask_epi8(blank);
+    *nul_mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_setzero_si128()));
+    return (unsigned int)_mm_movemask_epi8(_mm_or_si128(letter, _mm_or_si128(space, punctuation)));
+#else
+    unsigned int valid = 0, spaces = 0, nuls = 0;
+    for (int i = 0; i < 16; i++) {
+        unsigned char c = (unsigned char)block[i];
+        unsigned char folded = (unsigned char)((c | 0x20) - 'a');
+        if (folded <= 25 || c == ' ' || c == '-' || c == '\'') valid |= 1u << i;
+        if (c == ' ' || (unsigned char)(c - '\t') <= 4) spaces |= 1u << i;
+        if (c == '\0') nuls |= 1u << i;
+    }
+    *space_mask = spaces;
+    *nul_mask = nuls;
+    return valid;
+#endif
+}
+
+/*
+ * NAME_CHARS_VALID
+ * 
+ * Purpose: Check that all 'len' bytes of 'text' may appear in a name
+ * Returns: 1 if they all may, 0 otherwise
+ */
+int name_chars_valid(const char* text, size_t len) {
+    char block[16];
+    unsigned int spaces, nuls;
+    
+    for (size_t i = 0; i < len; i += 16) {
+        size_t n = (len - i < 16) ? len - i : 16;
+        const char* bytes = text + i;
+        if (n < 16) {
+            // Copy the tail so the load never reads past the string
+            memset(block, 0, sizeof(block));
+            memcpy(block, bytes, n);
+            bytes = block;
+        }
+        
+        unsigned int wanted = (n == 16) ? 0xFFFFu : (1u << n) - 1;
+        if ((name_block_masks(bytes, &spaces, &nuls) & wanted) != wanted) return 0;
+    }
+    return 1;
+}
+
+/*
+ * TRIM_NAME
+ * 
+ * Purpose: Remove leading and trailing whitespace in place
+ * Parameters: buffer - NUL-terminated string to trim
+ * Returns: length of the trimmed string
+ */
+size_t trim_name(char* buffer) {
+    size_t len = strlen(buffer);
+    size_t start = 0, end = len;
+    char block[16];
+    unsigned int spaces, nuls;
+    
+    // First non-space byte, a block at a time
+    while (start < end) {
+        size_t n = (end - start < 16) ? end - start : 16;
+        memset(block, ' ', sizeof(block));
+        memcpy(block, buffer + start, n);
+        name_block_masks(block, &spaces, &nuls);
+        if (spaces != 0xFFFFu) {
+            start += __builtin_ctz(~spaces & 0xFFFFu);
+            break;
+        }
+        start += n;
+    }
+    
+    // Last non-space byte, a block at a time from the end
+    while (end > start) {
+        size_t n = (end - start < 16) ? end - start : 16;
+        memset(block, ' ', sizeof(block));
+        memcpy(block + 16 - n, buffer + end - n, n);
+        name_block_masks(block, &spaces, &nuls);
+        if (spaces != 0xFFFFu) {
+            end -= __builtin_clz(~spaces & 0xFFFFu) - 16;  // Spaces after the last non-space bit
+            break;
+        }
+        end -= n;
+    }
+    
+    memmove(buffer, buffer + start, end - start);
+    buffer[end - start] = '\0';
+    return end - start;
+}
+
+/*
+ * NORMALIZE_NAMES_BATCH
+ * 
+ * Purpose: Trim and validate many fixed-width name fields in one call,
+ * e.g. the last_name of every record in an array
+ * Parameters:
+ *   - names: the first name field
+ *   - stride: bytes from one field to the next (sizeof the record)
+ *   - width: size of each field, including room for its NUL
+ *   - count: number of fields
+ *   - valid: receives 1 (valid) or 0 per field
+ * Returns: number of valid names
+ * 
+ * Fields of up to 16 bytes (all client_data names) take one block each:
+ * the NUL mask gives the length, the whitespace mask gives both trim
+ * points through a count of trailing/leading zero bits, and a single
+ * mask test validates the rest. Fields are loaded in place whenever 16
+ * bytes from the field start stay inside the array.
+ */
+size_t normalize_names_batch(char* names, size_t stride, size_t width, size_t count, unsigned char* valid) {
+    size_t valid_count = 0;
+    size_t total = (count > 0) ? (count - 1) * stride + width : 0;  // Bytes spanned by all fields
+    
+    for (size_t i = 0; i < count; i++) {
+        char* field = names + i * stride;
+        
+        if (width > 16) {
+            // Wide fields: the general-purpose helpers
+            field[width - 1] = '\0';
+            size_t len = trim_name(field);
+            valid[i] = (len > 0 && name_chars_valid(field, len));
+            valid_count += valid[i];
+            continue;
+        }
+        
+        const char* block = field;
+        char copy[16];
+        if (i * stride + 16 > total) {
+            memset(copy, 0, sizeof(copy));
+            memcpy(copy, field, width);
+            block = copy;
+        }
+        
+        // Length up to the first NUL; the field's last byte always ends it
+        unsigned int spaces, nuls;
+        unsigned int allowed = name_block_masks(block, &spaces, &nuls);
+        unsigned int len = __builtin_ctz(nuls | (1u << (width - 1)));
+        unsigned int text = ~spaces & ((1u << len) - 1);
+        
+        if (text == 0) {
+            // Empty or only whitespace
+            field[0] = '\0';
+            valid[i] = 0;
+            continue;
+        }
+        
+        unsigned int first = __builtin_ctz(text);
+        unsigned int last = 31 - __builtin_clz(text);
+        unsigned int span = ((2u << last) - 1) & ~((1u << first) - 1);
+        
+        if (first > 0 || last + 1 < len) {
+            memmove(field, block + first, last + 1 - first);
+            field[last + 1 - first] = '\0';
+        }
+        valid[i] = ((allowed & span) == span);
+        valid_count += valid[i];
+    }
+    
+    return valid_count;
+}
+
+/*
+ * AMOUNT PARSING
+ * 
+ * Amounts are parsed straight into whole cents, so "0.10" is exactly
+ * 10 and never the nearest binary fraction. Accepted form:
+ * 
+ *   [blanks] [+|-] digits [. 1-2 digits] [blanks]
+ * 
+ * (".5" and "5." are accepted too, as long as there is a digit.)
+ */
+
+/*
+ * PARSE_AMOUNT_CENTS
+ * 
+ * Purpose: Convert one decimal amount to integer cents
+ * Parameters:
+ *   - text/len: characters to parse (need not be NUL-terminated)
+ *   - cents: receives the amount on success
+ *   - error_position: receives the 0-based offset of the offending character
+ * Returns: AMOUNT_OK or one of the AMOUNT_* error codes
+ */
+int parse_amount_cents(const char* text, size_t len, long long* cents, size_t* error_position) {
+    size_t i = 0;
+    
+    // Surrounding blanks (and the newline fgets leaves behind)
+    while (i < len && (text[i] == ' ' || text[i] == '\t')) i++;
+    while (len > i && (text[len - 1] == ' ' || text[len - 1] == '\t' ||
+                       text[len - 1] == '\r' || text[len - 1] == '\n')) len--;
+    if (i == len) {
+        *error_position = i;
+        return AMOUNT_EMPTY;
+    }
+    
+    int negative = 0;
+    if (text[i] == '+' || text[i] == '-') {
+        negative = (text[i] == '-');
+        i++;
+    }
+    
+    // Whole units; unsigned arithmetic, range checked by digit count below
+    size_t digits_start = i;
+    unsigned long long whole = 0;
+    while (i < len) {
+        unsigned int digit = (unsigned char)text[i] - '0';
+        if (digit > 9) break;
+        whole = whole * 10 + digit;
+        i++;
+    }
+    size_t whole_digits = i - digits_start;
+    if (whole_digits > MAX_AMOUNT_DIGITS) {
+        *error_position = digits_start + MAX_AMOUNT_DIGITS;
+        return AMOUNT_OUT_OF_RANGE;
+    }
+    
+    // Cents
+    unsigned int fraction = 0, places = 0;
+    if (i < len && text[i] == '.') {
+        i++;
+        while (i < len) {
+            unsigned int digit = (unsigned char)text[i] - '0';
+            if (digit > 9) break;
+            if (places == 2) {
+                *error_position = i;
+                return AMOUNT_TOO_MANY_DECIMALS;
+            }
+            fraction = fraction * 10 + digit;
+            places++;
+            i++;
+        }
+        if (places == 1) fraction *= 10;
+    }
+    
+    if (i != len || whole_digits + places == 0) {
+        *error_position = i;
+        return (i == len) ? AMOUNT_EMPTY : AMOUNT_BAD_CHARACTER;
+    }
+    
+    long long value = (long long)(whole * 100 + fraction);
+    *cents = negative ? -value : value;
+    return AMOUNT_OK;
+}
+
+/*
+ * PARSE_EIGHT_DIGITS
+ * 
+ * Purpose: Convert 8 digit values packed in a 64-bit word (first digit
+ * in the lowest byte) to their number, using three multiplies instead
+ * of eight multiply-adds
+ */
+unsigned long long parse_eight_digits(unsigned long long digits) {
+    digits = (digits * 10) + (digits >> 8);  // Adjacent pairs: 10a + b
+    return (((digits & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((digits >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+}
+
+/*
+ * PARSE_DIGIT_RUN
+ * 
+ * Purpose: Convert 1-8 ASCII digits starting at 'text' to a number
+ * 8 bytes from 'text' must be readable; bytes after the digits are ignored.
+ */
+unsigned long long parse_digit_run(const char* text, unsigned int count) {
+    unsigned long long chunk;
+    memcpy(&chunk, text, sizeof(chunk));
+    
+    // Digit values, then shift out the bytes past the run: the freed
+    // low bytes become leading zeros
+    chunk -= 0x3030303030303030ULL;
+    chunk <<= 8 * (8 - count);
+    return parse_eight_digits(chunk);
+}
+
+/*
+ * PARSE_AMOUNT_LINE_FAST
+ * 
+ * Purpose: Parse a canonical "[-]digits.dd\n" line of at most 15 characters
+ * Parameters: line - 16 readable bytes, cents - receives the amount
+ * Returns: bytes consumed including the '\n', or 0 if the line is not
+ * canonical (the caller then uses parse_amount_cents)
+ * 
+ * One SSE2 classification of 16 bytes finds the newline and checks
+ * every digit position at once; the digits are then converted 8 at a
+ * time by parse_digit_run.
+ */
+int parse_amount_line_fast(const char* line, long long* cents) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i*)line);
+    __m128i values = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    unsigned int digit_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(values, _mm_set1_epi8(9)), values));
+    unsigned int newline_mask = _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+    if (newline_mask == 0) return 0;
+    
+    unsigned int length = __builtin_ctz(newline_mask);
+    unsigned int start = (line[0] == '-');
+    if (length < start + 4) return 0;  // Shortest canonical form is "d.dd"
+    
+    unsigned int dot = length - 3;
+    unsigned int wanted = ((1u << length) - 1) & ~((1u << start) - 1) & ~(1u << dot);
+    if (line[dot] != '.' || (digit_mask & wanted) != wanted) return 0;
+    
+    // At most 12 whole digits fit before the dot in 15 characters
+    unsigned int whole_digits = dot - start;
+    unsigned long long whole;
+    if (whole_digits <= 8) {
+        whole = parse_digit_run(line + start, whole_digits);
+    } else {
+        whole = parse_digit_run(line + start, whole_digits - 8) * 100000000ULL +
+                parse_digit_run(line + start + whole_digits - 8, 8);
+    }
+    
+    long long value = (long long)(whole * 100 + (line[dot + 1] - '0') * 10 + (line[dot + 2] - '0'));
+    *cents = start ? -value : value;
+    return (int)length + 1;
+#else
+    (void)line;
+    (void)cents;
+    return 0;
+#endif
+}
+
+/*
+ * PARSE_AMOUNTS_BATCH
+ * 
+ * Purpose: Parse a buffer of newline-separated amounts (one per line)
+ * Parameters:
+ *   - text/size: the buffer; the last line needs no newline
+ *   - cents: receives the amounts, in order
+ *   - max_count: capacity of 'cents'
+ *   - error: receives line, character and code of the first bad amount
+ * Returns: number of amounts stored; parsing stops at the first bad line
+ * 
+ * Lines in the common "[-]digits.dd" form take the vectorized fast
+ * path; everything else (blanks, '+', fewer decimals, a line too close
+ * to the end of the buffer to load 16 bytes) goes through
+ * parse_amount_cents, so both paths accept exactly the same input.
+ */
+long parse_amounts_batch(const char* text, size_t size, long long* cents, long max_count,
+                         struct amount_error* error) {
+    const char* p = text;
+    const char* end = text + size;
+    long count = 0;
+    
+    error->status = AMOUNT_OK;
+    error->line = 0;
+    error->position = 0;
+    
+    while (p < end && count < max_count) {
+        if (end - p >= 16) {
+            int consumed = parse_amount_line_fast(p, &cents[count]);
+            if (consumed > 0) {
+                p += consumed;
+                count++;
+                continue;
+            }
+        }
+        
+        const char* newline = find_newline(p, end);
+        int status = parse_amount_cents(p, newline - p, &cents[count], &error->position);
+        if (status != AMOUNT_OK) {
+            error->status = status;
+            error->line = count + 1;
+            return count;
+        }
+        
+        count++;
+        p = newline + 1;
+    }
+    
+    return count;
+}
+
+/*
+ * AMOUNT_ERROR_MESSAGE
+ * 
+ * Purpose: Describe an AMOUNT_* code for the user
+ */
+const char* amount_error_message(int status) {
+    switch (status) {
+        case AMOUNT_OK:                return "No error";
+        case AMOUNT_EMPTY:             return "Missing digits";
+        case AMOUNT_BAD_CHARACTER:     return "Unexpected character";
+        case AMOUNT_TOO_MANY_DECIMALS: return "More than two decimal places";
+        case AMOUNT_OUT_OF_RANGE:      return "Amount too large";
+        default:                       return "Invalid amount";
+    }
+}
+
+/*
+ * DISPLAY FUNCTIONS
+ * 
+ * Functions for formatting and displaying account information
+ */
+
+void display_client(const struct client_data* client) {
+    if (client == NULL) {
+        printf("Error: Cannot display null client data.\n");
+        return;
+    }
+    
+    printf("Account Number: %u\n", client->acct_num);
+    printf("Customer Name:  %s, %s\n", client->last_name, client->first_name);
+    printf("Account Balance: $%.2f\n", client->balance);
+    
+    // Additional status information
+    if (client->balance < 0) {
+        printf("Status: OVERDRAWN (%.2f)\n", -client->balance);
+    } else if (client->balance == 0) {
+        printf("Status: ZERO BALANCE\n");
+    } else {
+        printf("Status: ACTIVE\n");
+    }
+    
+    printf("-------------------------------------------\n");
+}
+
+void display_all_accounts(void) {
+    printf("\n=== ALL ACCOUNTS REPORT ===\n");
+    
+    FILE* file_ptr = open_data_file("rb");
+    if (file_ptr == NULL) {
+        printf("Error: Could not open data file for reading.\n");
+        return;
+    }
+    
+    print_account_header();
+    
+    struct client_data client;
+    int total_accounts = 0;
+    double total_balance = 0.0;
+    int overdrawn_accounts = 0;
+    
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        if (read_client_from_file(file_ptr, &client, i) && client.acct_num != 0) {
+            print_account_row(&client);
+            total_accounts++;
+            total_balance += client.balance;
+            if (client.balance < 0) overdrawn_accounts++;
+        }
+    }
+    
+    close_data_file(file_ptr);
+    
+    // Summary statistics
+    printf("=======================================================\n");
+    printf("Total Accounts: %d\n", total_accounts);
+    printf("Total Balance:  $%.2f\n", total_balance);
+    printf("Overdrawn:      %d accounts\n", overdrawn_accounts);
+    if (total_accounts > 0) {
+        printf("Average Balance: $%.2f\n", total_balance / total_accounts);
+    }
+}
+
+void print_account_header(void) {
+    printf("%-6s %-15s %-10s %12s %10s\n", 
+           "Acct#", "Last Name", "First Name", "Balance", "Status");
+    printf("=======================================================\n");
+}
+
+void print_account_row(const struct client_data* client) {
+    if (client == NULL) return;
+    
+    const char* status;
+    if (client->balance < 0) {
+        status = "OVERDRAWN";
+    } else if (client->balance == 0) {
+        status = "ZERO";
+    } else {
+        status = "ACTIVE";
+    }
+    
+    printf("%-6u %-15s %-10s %12.2f %10s\n",
+           client->acct_num, client->last_name, client->first_name,
+           client->balance, status);
+}
+
+/*
+ * UTILITY FUNCTIONS
+ */
+
+void initialize_client(struct client_data* client, unsigned int acct_num,
+                      const char* last_name, const char* first_name, double balance) {
+    if (client == NULL) return;
+    
+    client->acct_num = acct_num;
+    client->balance = balance;
+    
+    // Safe string copying
+    if (last_name != NULL) {
+        strncpy(client->last_name, last_name, sizeof(client->last_name) - 1);
+        client->last_name[sizeof(client->last_name) - 1] = '\0';
+    } else {
+        client->last_name[0] = '\0';
+    }
+    
+    if (first_name != NULL) {
+        strncpy(client->first_name, first_name, sizeof(client->first_name) - 1);
+        client->first_name[sizeof(client->first_name) - 1] = '\0';
+    } else {
+        client->first_name[0] = '\0';
+    }
+}
+
+void initialize_data_file_if_needed(void) {
+    // Check if file exists
+    FILE* test_file = fopen(DATA_FILE, "rb");
+    if (test_file != NULL) {
+        fclose(test_file);
+        printf("Data file '%s' found.\n", DATA_FILE);
+        return;
+    }
+    
+    // Create new file
+    printf("Creating new data file '%s'...\n", DATA_FILE);
+    FILE* file_ptr = fopen(DATA_FILE, "wb");
+    if (file_ptr == NULL) {
+        printf("Error: Could not create data file.\n");
+        return;
+    }
+    
+    // Initialize with empty records
+    struct client_data empty_client = CLIENT_RECORD(0, "", "", 0.0);
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        fwrite(&empty_client, RECORD_SIZE, 1, file_ptr);
+    }
+    
+    fclose(file_ptr);
+    printf("Data file initialized with %d empty slots.\n", MAX_ACCOUNTS);
+}
+
+double elapsed_seconds(const struct timespec* start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/*
+ * ARENA ALLOCATOR
+ * 
+ * Parsing a batch or answering a request makes many short-lived
+ * allocations that all die together. An arena hands them out by
+ * bumping a pointer through large blocks and frees them all at once:
+ * arena_reset only moves the pointer back to the first block, keeping
+ * every block for the next batch, so once an arena has grown to the
+ * size of a typical batch it makes no further malloc calls at all.
+ * 'mallocs' counts the blocks taken from malloc, which is how tests
+ * and reports show the steady state allocates nothing.
+ * 
+ * An arena is used by one thread at a time; handing it to another
+ * thread needs the same synchronization as any other data.
+ */
+
+void arena_init(struct arena* arena, size_t block_size) {
+    memset(arena, 0, sizeof(*arena));
+    arena->block_size = (block_size > 0) ? block_size : ARENA_BLOCK_SIZE;
+}
+
+/*
+ * ARENA_ALLOC
+ * 
+ * Purpose: Allocate 'size' bytes, aligned to ARENA_ALIGNMENT, that live
+ * until the arena is reset or released
+ * Returns: the memory (not zeroed), or NULL if out of memory
+ */
+void* arena_alloc(struct arena* arena, size_t size) {
+    size = (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    arena->allocations++;
+    
+    struct arena_block* block = arena->current;
+    while (block != NULL && block->size - block->used < size) {
+        // Blocks after 'current' are left over from before a reset
+        block = block->next;
+        if (block != NULL) block->used = 0;
+    }
+    
+    if (block == NULL) {
+        // Whole multiples of the block size, so similar requests after a reset fit again
+        size_t block_size = (size + arena->block_size - 1) / arena->block_size * arena->block_size;
+        if (block_size == 0) block_size = arena->block_size;
+        block = malloc(sizeof(struct arena_block) + block_size);
+        if (block == NULL) return NULL;
+        arena->mallocs++;
+        block->size = block_size;
+        block->used = 0;
+        
+        // Insert after 'current' so the blocks behind it stay reusable
+        if (arena->current == NULL) {
+            block->next = NULL;
+            arena->first = block;
+        } else {
+            block->next = arena->current->next;
+            arena->current->next = block;
+        }
+    }
+    
+    arena->current = block;
+    void* ptr = block->data + block->used;
+    block->used += size;
+    arena->last = ptr;
+    return ptr;
+}
+
+/*
+ * ARENA_GROW
+ * 
+ * Purpose: realloc for arena memory
+ * Returns: the (possibly moved) memory, or NULL if out of memory (the
+ * old contents are then still valid)
+ * 
+ * The newest allocation grows in place while its block has room, so an
+ * array grown by doubling is usually never copied.
+ */
+void* arena_grow(struct arena* arena, void* ptr, size_t old_size, size_t new_size) {
+    old_size = (old_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    size_t aligned_size = (new_size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    struct arena_block* block = arena->current;
+    
+    if (ptr != NULL && ptr == arena->last &&
+        (char*)ptr + old_size == block->data + block->used && aligned_size - old_size <= block->size - block->used) {
+        arena->allocations++;
+        block->used += aligned_size - old_size;
+        return ptr;
+    }
+    
+    void* moved = arena_alloc(arena, new_size);
+    if (moved != NULL && ptr != NULL) memcpy(moved, ptr, old_size < new_size ? old_size : new_size);
+    return moved;
+}
+
+/*
+ * ARENA_RESET / ARENA_RELEASE
+ * 
+ * Purpose: Free everything allocated, keeping the blocks (reset, O(1))
+ * or returning them to malloc (release)
+ */
+void arena_reset(struct arena* arena) {
+    arena->current = arena->first;
+    if (arena->first != NULL) arena->first->used = 0;
+    arena->last = NULL;
+}
+
+void arena_release(struct arena* arena) {
+    struct arena_block* block = arena->first;
+    while (block != NULL) {
+        struct arena_block* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->last = NULL;
+}
+
+/*
+ * OBJECT POOLS
+ * 
+ * A long-running service creates and drops a request object for every
+ * call. An object pool keeps dropped objects for reuse instead of
+ * handing them back to malloc. Each thread works with its own cache
+ * (given by index, like a work pool worker number), so a get or put
+ * touches only that thread's free list - no lock, no atomic operation.
+ * 
+ * Objects often die on another thread than the one that made them (a
+ * request is created by a caller and finished by the service thread).
+ * Such an object goes onto its owner's 'returned' stack with one
+ * compare-and-swap; the owner takes the whole stack back the next time
+ * its free list runs dry. Only when both are empty is malloc called,
+ * for POOL_REFILL objects at once. The counters give the hit rate
+ * (gets served from the pool) per pool.
+ */
+
+/*
+ * OBJECT_POOL_INIT / OBJECT_POOL_DESTROY
+ * 
+ * Purpose: Set up an empty pool of 'object_size' objects / free every
+ * object of a pool (whether or not it was put back)
+ * Returns (init): 1 on success
+ */
+int object_pool_init(struct object_pool* pool, size_t object_size) {
+    memset(pool, 0, sizeof(*pool));
+    pool->object_size = (object_size + sizeof(struct pool_object) - 1) / sizeof(struct pool_object) *
+                        sizeof(struct pool_object);
+    for (int i = 0; i < POOL_CACHES; i++) atomic_init(&pool->caches[i].returned, NULL);
+    return pthread_mutex_init(&pool->blocks_lock, NULL) == 0;
+}
+
+void object_pool_destroy(struct object_pool* pool) {
+    for (long i = 0; i < pool->block_count; i++) free(pool->blocks[i]);
+    free(pool->blocks);
+    pthread_mutex_destroy(&pool->blocks_lock);
+}
+
+/*
+ * OBJECT_POOL_GET
+ * 
+ * Purpose: Take an object for the thread using cache 'cache'
+ * Returns: the object (contents undefined), or NULL if out of memory
+ */
+void* object_pool_get(struct object_pool* pool, int cache) {
+    struct pool_cache* own = &pool->caches[cache];
+    own->gets++;
+    
+    if (own->free_list == NULL) {
+        own->free_list = atomic_exchange_explicit(&own->returned, NULL, memory_order_acquire);
+    }
+    
+    if (own->free_list == NULL) {
+        size_t stride = sizeof(struct pool_object) + pool->object_size;
+        char* block = malloc(POOL_REFILL * stride);
+        if (block == NULL) return NULL;
+        
+        pthread_mutex_lock(&pool->blocks_lock);
+        if (pool->block_count == pool->block_capacity) {
+            long capacity = pool->block_capacity > 0 ? pool->block_capacity * 2 : 16;
+            void** blocks = realloc(pool->blocks, capacity * sizeof(void*));
+            if (blocks == NULL) {
+                pthread_mutex_unlock(&pool->blocks_lock);
+                free(block);
+                return NULL;
+            }
+            pool->blocks = blocks;
+            pool->block_capacity = capacity;
+        }
+        pool->blocks[pool->block_count++] = block;
+        pthread_mutex_unlock(&pool->blocks_lock);
+        
+        for (int i = POOL_REFILL - 1; i >= 0; i--) {
+            struct pool_object* object = (struct pool_object*)(block + i * stride);
+            object->owner = cache;
+            object->next = own->free_list;
+            own->free_list = object;
+        }
+    } else {
+        own->hits++;
+    }
+    
+    struct pool_object* object = own->free_list;
+    own->free_list = object->next;
+    return object + 1;
+}
+
+/*
+ * OBJECT_POOL_PUT
+ * 
+ * Purpose: Give an object back, from the thread using cache 'cache'
+ */
+void object_pool_put(struct object_pool* pool, int cache, void* object) {
+    if (object == NULL) return;
+    struct pool_object* header = (struct pool_object*)object - 1;
+    struct pool_cache* own = &pool->caches[cache];
+    own->puts++;
+    
+    if (header->owner == cache) {
+        header->next = own->free_list;
+        own->free_list = header;
+        return;
+    }
+    
+    own->remote_puts++;
+    struct pool_cache* owner = &pool->caches[header->owner];
+    struct pool_object* head = atomic_load_explicit(&owner->returned, memory_order_relaxed);
+    do {
+        header->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&owner->returned, &head, header,
+                                                    memory_order_release, memory_order_relaxed));
+}
+
+/*
+ * OBJECT_POOL_STATS
+ * 
+ * Purpose: Add up the counters of every cache
+ * 
+ * The counters belong to the threads using the caches, so read them
+ * once those threads are done (or accept slightly stale numbers).
+ */
+void object_pool_stats(struct object_pool* pool, struct pool_stats* stats) {
+    memset(stats, 0, sizeof(*stats));
+    for (int i = 0; i < POOL_CACHES; i++) {
+        stats->gets += pool->caches[i].gets;
+        stats->hits += pool->caches[i].hits;
+        stats->puts += pool->caches[i].puts;
+        stats->remote_puts += pool->caches[i].remote_puts;
+    }
+    pthread_mutex_lock(&pool->blocks_lock);
+    stats->mallocs = pool->block_count;
+    pthread_mutex_unlock(&pool->blocks_lock);
+}
+
+/*
+ * NAME DICTIONARY
+ * 
+ * Last names repeat heavily: a million customers may share a few
+ * thousand surnames, yet every record carries its own 15-byte copy. A
+ * name dictionary stores each distinct name once and hands out dense
+ * 32-bit ids (0, 1, 2, ... in order of first appearance). Records that
+ * hold ids instead of text are smaller, and comparing two names becomes
+ * comparing two integers.
+ * 
+ * Lookups go through an open-addressing hash table of ids (linear
+ * probing, kept at most half full). The names themselves live back to
+ * back in one text buffer, so the whole dictionary is four allocations
+ * no matter how many names it holds.
+ */
+
+/*
+ * NAME_DICTIONARY_INIT / NAME_DICTIONARY_FREE
+ * 
+ * Purpose: Create an empty dictionary / release all of its memory
+ * Returns: 1 on success, 0 if out of memory
+ */
+int name_dictionary_init(struct name_dictionary* names) {
+    memset(names, 0, sizeof(*names));
+    names->slots = calloc(NAME_SLOTS_INITIAL, sizeof(unsigned int));
+    if (names->slots == NULL) return 0;
+    names->slot_mask = NAME_SLOTS_INITIAL - 1;
+    return 1;
+}
+
+void name_dictionary_free(struct name_dictionary* names) {
+    free(names->text);
+    free(names->offsets);
+    free(names->hashes);
+    free(names->slots);
+    memset(names, 0, sizeof(*names));
+}
+
+/*
+ * NAME_HASH
+ * 
+ * Purpose: FNV-1a hash of a name (names are short, so a byte loop is enough)
+ */
+unsigned int name_hash(const char* name, size_t len) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)name[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/*
+ * NAME_INTERN
+ * 
+ * Purpose: Get the id of a name, adding the name if it is new
+ * Returns: the id, or NAME_ID_NONE if out of memory
+ */
+unsigned int name_intern(struct name_dictionary* names, const char* name) {
+    size_t len = strlen(name);
+    unsigned int hash = name_hash(name, len);
+    
+    unsigned int slot = hash & names->slot_mask;
+    while (names->slots[slot] != 0) {
+        unsigned int id = names->slots[slot] - 1;
+        if (names->hashes[id] == hash && strcmp(names->text + names->offsets[id], name) == 0) return id;
+        slot = (slot + 1) & names->slot_mask;
+    }
+    
+    if (names->count >= NAME_ID_NONE - 1 || names->text_size + len + 1 > 0xFFFFFFFFu) return NAME_ID_NONE;
+    
+    // Room for the name
+    if (names->count == names->capacity) {
+        unsigned int capacity = names->capacity > 0 ? names->capacity * 2 : 256;
+        unsigned int* offsets = realloc(names->offsets, capacity * sizeof(unsigned int));
+        if (offsets == NULL) return NAME_ID_NONE;
+        names->offsets = offsets;
+        unsigned int* hashes = realloc(names->hashes, capacity * sizeof(unsigned int));
+        if (hashes == NULL) return NAME_ID_NONE;
+        names->hashes = hashes;
+        names->capacity = capacity;
+    }
+    if (names->text_size + len + 1 > names->text_capacity) {
+        size_t capacity = names->text_capacity > 0 ? names->text_capacity * 2 : 4096;
+        while (capacity < names->text_size + len + 1) capacity *= 2;
+        char* text = realloc(names->text, capacity);
+        if (text == NULL) return NAME_ID_NONE;
+        names->text = text;
+        names->text_capacity = capacity;
+    }
+    
+    // Keep the table at most half full: double it and re-insert every id
+    if ((names->count + 1) * 2 > names->slot_mask + 1) {
+        unsigned int slot_count = (names->slot_mask + 1) * 2;
+        unsigned int* slots = calloc(slot_count, sizeof(unsigned int));
+        if (slots == NULL) return NAME_ID_NONE;
+        for (unsigned int id = 0; id < names->count; id++) {
+            unsigned int free_slot = names->hashes[id] & (slot_count - 1);
+            while (slots[free_slot] != 0) free_slot = (free_slot + 1) & (slot_count - 1);
+            slots[free_slot] = id + 1;
+        }
+        free(names->slots);
+        names->slots = slots;
+        names->slot_mask = slot_count - 1;
+        
+        slot = hash & names->slot_mask;
+        while (names->slots[slot] != 0) slot = (slot + 1) & names->slot_mask;
+    }
+    
+    unsigned int id = names->count++;
+    names->offsets[id] = (unsigned int)names->text_size;
+    names->hashes[id] = hash;
+    memcpy(names->text + names->text_size, name, len + 1);
+    names->text_size += len + 1;
+    names->slots[slot] = id + 1;
+    return id;
+}
+
+/*
+ * NAME_FIND
+ * 
+ * Purpose: Get the id of a name without adding it
+ * Returns: the id, or NAME_ID_NONE if the name is not in the dictionary
+ */
+unsigned int name_find(const struct name_dictionary* names, const char* name) {
+    unsigned int hash = name_hash(name, strlen(name));
+    
+    unsigned int slot = hash & names->slot_mask;
+    while (names->slots[slot] != 0) {
+        unsigned int id = names->slots[slot] - 1;
+        if (names->hashes[id] == hash && strcmp(names->text + names->offsets[id], name) == 0) return id;
+        slot = (slot + 1) & names->slot_mask;
+    }
+    return NAME_ID_NONE;
+}
+
+/*
+ * NAME_TEXT
+ * 
+ * Purpose: The name behind an id ("" for an unknown id)
+ */
+const char* name_text(const struct name_dictionary* names, unsigned int id) {
+    return (id < names->count) ? names->text + names->offsets[id] : "";
+}
+
+/*
+ * ENCODE_CLIENT / DECODE_CLIENT
+ * 
+ * Purpose: Convert between a full record and its dictionary-encoded form
+ * Returns (encode): 1 on success, 0 if out of memory
+ */
+int encode_client(struct name_dictionary* names, const struct client_data* client, struct encoded_client* encoded) {
+    memset(encoded, 0, sizeof(*encoded));
+    encoded->acct_num = client->acct_num;
+    encoded->last_name = name_intern(names, client->last_name);
+    encoded->first_name = name_intern(names, client->first_name);
+    encoded->version = client->version;
+    encoded->balance = client->balance;
+    return (encoded->last_name != NAME_ID_NONE && encoded->first_name != NAME_ID_NONE);
+}
+
+void decode_client(const struct name_dictionary* names, const struct encoded_client* encoded,
+                   struct client_data* client) {
+    memset(client, 0, sizeof(*client));
+    client->acct_num = encoded->acct_num;
+    strncpy(client->last_name, name_text(names, encoded->last_name), sizeof(client->last_name) - 1);
+    strncpy(client->first_name, name_text(names, encoded->first_name), sizeof(client->first_name) - 1);
+    client->version = encoded->version;
+    client->balance = encoded->balance;
+}
+
+/*
+ * TRANSACTION HISTORY
+ * 
+ * Every balance change is appended to HISTORY_FILE as one
+ * transaction_record, so the file lists all activity in time order.
+ */
+
+/*
+ * LOG_TRANSACTION
+ * 
+ * Purpose: Append one balance change to the history file
+ * Parameters:
+ *   - acct_num: account that changed
+ *   - amount: transaction amount (+credit/-debit)
+ *   - balance_after: balance once the amount was applied
+ * Returns: 1 on success, 0 on failure
+ */
+int log_transaction(unsigned int acct_num, double amount, double balance_after) {
+    FILE* history_ptr = fopen(HISTORY_FILE, "ab");
+    if (history_ptr == NULL) return 0;
+    
+    int success = append_transaction(history_ptr, acct_num, amount, balance_after);
+    fclose(history_ptr);
+    return success;
+}
+
+/*
+ * APPEND_TRANSACTION
+ * 
+ * Purpose: Write one history entry to an already open history file
+ * Returns: 1 on success, 0 on failure
+ */
+int append_transaction(FILE* history_ptr, unsigned int acct_num, double amount, double balance_after) {
+    struct transaction_record entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.acct_num = acct_num;
+    entry.timestamp = (long long)time(NULL);
+    entry.amount = amount;
+    entry.balance_after = balance_after;
+    
+    return (fwrite(&entry, sizeof(entry), 1, history_ptr) == 1);
+}
+
+/*
+ * LOAD_HISTORY
+ * 
+ * Purpose: Read the whole history file into memory
+ * Parameters: history_path - file to read, count - receives number of entries
+ * Returns: malloc'd array (caller frees) or NULL if the file is missing or empty
+ */
+struct transaction_record* load_history(const char* history_path, long* count) {
+    *count = 0;
+    
+    FILE* history_ptr = fopen(history_path, "rb");
+    if (history_ptr == NULL) return NULL;
+    
+    fseek(history_ptr, 0, SEEK_END);
+    long entries = ftell(history_ptr) / (long)sizeof(struct transaction_record);
+    rewind(history_ptr);
+    
+    struct transaction_record* history = NULL;
+    if (entries > 0) {
+        history = malloc(entries * sizeof(struct transaction_record));
+        if (history != NULL) {
+            *count = fread(history, sizeof(struct transaction_record), entries, history_ptr);
+        }
+    }
+    
+    fclose(history_ptr);
+    return history;
+}
+
+/*
+ * BATCH JOB: MONTHLY STATEMENTS
+ * 
+ * Statements are produced by a four-stage pipeline:
+ * 
+ *   fetch -> history lookup -> format -> write
+ * 
+ * The first three stages run on their own threads and the calling
+ * thread writes the output. Stages hand statement_job objects to each
+ * other through bounded queues: a full queue blocks its producer, so a
+ * slow output device throttles the fetch stage instead of the whole
+ * file piling up in memory.
+ */
+
+/*
+ * BOUNDED QUEUE
+ * 
+ * queue_push blocks while the queue is full and queue_pop blocks while
+ * it is empty. After queue_close, pushes fail and pops drain what is
+ * left, then return NULL.
+ */
+int queue_init(struct bounded_queue* queue, int capacity) {
+    memset(queue, 0, sizeof(*queue));
+    queue->items = malloc(capacity * sizeof(void*));
+    if (queue->items == NULL) return 0;
+    
+    queue->capacity = capacity;
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->not_empty, NULL);
+    pthread_cond_init(&queue->not_full, NULL);
+    return 1;
+}
+
+int queue_push(struct bounded_queue* queue, void* item) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == queue->capacity && !queue->closed) {
+        pthread_cond_wait(&queue->not_full, &queue->lock);
+    }
+    
+    if (queue->closed) {
+        pthread_mutex_unlock(&queue->lock);
+        return 0;
+    }
+    
+    queue->items[(queue->head + queue->count) % queue->capacity] = item;
+    queue->count++;
+    pthread_cond_signal(&queue->not_empty);
+    pthread_mutex_unlock(&queue->lock);
+    return 1;
+}
+
+void* queue_pop(struct bounded_queue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    while (queue->count == 0 && !queue->closed) {
+        pthread_cond_wait(&queue->not_empty, &queue->lock);
+    }
+    
+    void* item = NULL;
+    if (queue->count > 0) {
+        item = queue->items[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        pthread_cond_signal(&queue->not_full);
+    }
+    
+    pthread_mutex_unlock(&queue->lock);
+    return item;
+}
+
+void queue_close(struct bounded_queue* queue) {
+    pthread_mutex_lock(&queue->lock);
+    queue->closed = 1;
+    pthread_cond_broadcast(&queue->not_empty);
+    pthread_cond_broadcast(&queue->not_full);
+    pthread_mutex_unlock(&queue->lock);
+}
+
+void queue_destroy(struct bounded_queue* queue) {
+    pthread_mutex_destroy(&queue->lock);
+    pthread_cond_destroy(&queue->not_empty);
+    pthread_cond_destroy(&queue->not_full);
+    free(queue->items);
+    queue->items = NULL;
+}
+
+/*
+ * STATEMENT_PERIOD_START
+ * 
+ * Purpose: Find the start of the current calendar month
+ * Returns: local midnight of the 1st, in seconds since the epoch
+ */
+long long statement_period_start(void) {
+    time_t now = time(NULL);
+    struct tm local;
+    localtime_r(&now, &local);
+    
+    local.tm_mday = 1;
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    return (long long)mktime(&local);
+}
+
+/*
+ * GROUP_HISTORY_BY_ACCOUNT
+ * 
+ * Purpose: Make each account's entries since 'since' contiguous
+ * Parameters:
+ *   - pipeline: receives the grouped array and per-account offsets
+ *   - history/count: entries as loaded from the history file
+ *   - since: entries older than this are left out
+ * Returns: 1 on success, 0 on allocation failure
+ * 
+ * A counting sort keyed by account number keeps every account's
+ * entries in file (time) order, and the offsets it produces turn the
+ * lookup stage into two array reads per statement.
+ */
+int group_history_by_account(struct statement_pipeline* pipeline, struct transaction_record* history,
+                             long count, long long since) {
+    unsigned int max_acct = 0;
+    for (long i = 0; i < count; i++) {
+        if (history[i].timestamp >= since && history[i].acct_num > max_acct) {
+            max_acct = history[i].acct_num;
+        }
+    }
+    
+    long* offsets = calloc((size_t)max_acct + 2, sizeof(long));
+    struct transaction_record* grouped = malloc((count > 0 ? count : 1) * sizeof(struct transaction_record));
+    if (offsets == NULL || grouped == NULL) {
+        free(offsets);
+        free(grouped);
+        return 0;
+    }
+    
+    // Count entries per account, then turn counts into start offsets
+    for (long i = 0; i < count; i++) {
+        if (history[i].timestamp >= since) offsets[history[i].acct_num + 1]++;
+    }
+    for (unsigned int a = 1; a <= max_acct + 1; a++) {
+        offsets[a] += offsets[a - 1];
+    }
+    
+    // Scatter entries into place; 'next' walks each account's slice
+    long* next = malloc(((size_t)max_acct + 1) * sizeof(long));
+    if (next == NULL) {
+        free(offsets);
+        free(grouped);
+        return 0;
+    }
+    memcpy(next, offsets, ((size_t)max_acct + 1) * sizeof(long));
+    for (long i = 0; i < count; i++) {
+        if (history[i].timestamp >= since) grouped[next[history[i].acct_num]++] = history[i];
+    }
+    free(next);
+    
+    pipeline->history = grouped;
+    pipeline->history_offsets = offsets;
+    pipeline->max_history_acct = max_acct;
+    return 1;
+}
+
+/*
+ * APPEND_STATEMENT_TEXT
+ * 
+ * Purpose: printf-style append to a statement's text buffer
+ * Returns: 1 on success, 0 if the buffer could not grow
+ */
+int append_statement_text(struct statement_job* job, const char* format, ...) {
+    for (;;) {
+        int room = job->text_capacity - job->text_length;
+        va_list args;
+        va_start(args, format);
+        int needed = vsnprintf(room > 0 ? job->text + job->text_length : NULL, room, format, args);
+        va_end(args);
+        
+        if (needed < 0) return 0;
+        if (needed < room) {
+            job->text_length += needed;
+            return 1;
+        }
+        
+        // Grow and format again
+        int capacity = job->text_capacity > 0 ? job->text_capacity * 2 : 1024;
+        while (capacity - job->text_length <= needed) capacity *= 2;
+        char* text = realloc(job->text, capacity);
+        if (text == NULL) return 0;
+        job->text = text;
+        job->text_capacity = capacity;
+    }
+}
+
+/*
+ * FORMAT_STATEMENT
+ * 
+ * Purpose: Render one statement using the display_client layout
+ * followed by the month's transactions
+ * Returns: 1 on success, 0 on allocation failure
+ */
+int format_statement(struct statement_job* job) {
+    const struct client_data* client = &job->client;
+    const char* status;
+    if (client->balance < 0) {
+        status = "OVERDRAWN";
+    } else if (client->balance == 0) {
+        status = "ZERO BALANCE";
+    } else {
+        status = "ACTIVE";
+    }
+    
+    int ok = append_statement_text(job, "=========== MONTHLY STATEMENT ============\n")
+          && append_statement_text(job, "Account Number: %u\n", client->acct_num)
+          && append_statement_text(job, "Customer Name:  %s, %s\n", client->last_name, client->first_name)
+          && append_statement_text(job, "Account Balance: $%.2f\n", client->balance)
+          && append_statement_text(job, "Status: %s\n", status)
+          && append_statement_text(job, "-------------------------------------------\n");
+    
+    if (ok && job->history_count == 0) {
+        ok = append_statement_text(job, "No transactions this month.\n");
+    } else if (ok) {
+        ok = append_statement_text(job, "%-12s %14s %14s\n", "Date", "Amount", "Balance");
+        for (long i = 0; ok && i < job->history_count; i++) {
+            const struct transaction_record* entry = &job->history[i];
+            time_t when = (time_t)entry->timestamp;
+            struct tm local;
+            char date[16];
+            localtime_r(&when, &local);
+            strftime(date, sizeof(date), "%Y-%m-%d", &local);
+            ok = append_statement_text(job, "%-12s %+14.2f %14.2f\n", date, entry->amount, entry->balance_after);
+        }
+    }
+    
+    return ok && append_statement_text(job, "===========================================\n\n");
+}
+
+/* Stage 1: read records in batches and queue the active ones */
+void* statement_fetch_stage(void* arg) {
+    struct statement_pipeline* pipeline = arg;
+    struct client_data batch[STATEMENT_READ_BATCH];
+    size_t read_count;
+    int running = 1;
+    
+    while (running && (read_count = fread(batch, RECORD_SIZE, STATEMENT_READ_BATCH, pipeline->data_ptr)) > 0) {
+        for (size_t i = 0; running && i < read_count; i++) {
+            if (batch[i].acct_num == 0) continue;  // Empty slot
+            
+            struct statement_job* job = calloc(1, sizeof(*job));
+            if (job == NULL) {
+                atomic_store(&pipeline->failed, 1);
+                running = 0;
+            } else {
+                job->client = batch[i];
+                if (!queue_push(&pipeline->fetched, job)) {
+                    free(job);
+                    running = 0;
+                }
+            }
+        }
+    }
+    
+    queue_close(&pipeline->fetched);
+    return NULL;
+}
+
+/* Stage 2: attach the account's slice of the grouped history */
+void* statement_lookup_stage(void* arg) {
+    struct statement_pipeline* pipeline = arg;
+    struct statement_job* job;
+    
+    while ((job = queue_pop(&pipeline->fetched)) != NULL) {
+        unsigned int acct = job->client.acct_num;
+        if (acct <= pipeline->max_history_acct) {
+            long first = pipeline->history_offsets[acct];
+            job->history = pipeline->history + first;
+            job->history_count = pipeline->history_offsets[acct + 1] - first;
+        }
+        if (!queue_push(&pipeline->looked_up, job)) free(job);
+    }
+    
+    queue_close(&pipeline->looked_up);
+    return NULL;
+}
+
+/* Stage 3: render statement text */
+void* statement_format_stage(void* arg) {
+    struct statement_pipeline* pipeline = arg;
+    struct statement_job* job;
+    
+    while ((job = queue_pop(&pipeline->looked_up)) != NULL) {
+        if (!format_statement(job)) {
+            atomic_store(&pipeline->failed, 1);
+        }
+        if (!queue_push(&pipeline->formatted, job)) {
+            free(job->text);
+            free(job);
+        }
+    }
+    
+    queue_close(&pipeline->formatted);
+    return NULL;
+}
+
+/* Stage 4 (calling thread): write statements in account order */
+void statement_write_stage(struct statement_pipeline* pipeline) {
+    struct statement_job* job;
+    
+    while ((job = queue_pop(&pipeline->formatted)) != NULL) {
+        if (fwrite(job->text, 1, job->text_length, pipeline->output_ptr) == (size_t)job->text_length) {
+            pipeline->written++;
+        } else {
+            atomic_store(&pipeline->failed, 1);
+        }
+        free(job->text);
+        free(job);
+    }
+}
+
+/*
+ * GENERATE_STATEMENTS
+ * 
+ * Purpose: Write this month's statement for every active account
+ * Parameters:
+ *   - data_path: binary account file
+ *   - history_path: transaction history file
+ *   - output_path: text file to create, or "-" for stdout
+ *   - stats: receives statement count and elapsed time (may be NULL)
+ * Returns: number of statements written, or -1 on error
+ */
+long generate_statements(const char* data_path, const char* history_path,
+                         const char* output_path, struct batch_stats* stats) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct statement_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    atomic_init(&pipeline.failed, 0);
+    
+    pipeline.data_ptr = fopen(data_path, "rb");
+    if (pipeline.data_ptr == NULL) {
+        printf("Error: Could not open data file '%s'\n", data_path);
+        return -1;
+    }
+    
+    int to_stdout = (strcmp(output_path, "-") == 0);
+    pipeline.output_ptr = to_stdout ? stdout : fopen(output_path, "w");
+    if (pipeline.output_ptr == NULL) {
+        printf("Error: Could not create statement file '%s'\n", output_path);
+        fclose(pipeline.data_ptr);
+        return -1;
+    }
+    
+    long history_count;
+    struct transaction_record* history = load_history(history_path, &history_count);
+    int ready = group_history_by_account(&pipeline, history, history_count, statement_period_start());
+    free(history);
+    
+    ready = ready && queue_init(&pipeline.fetched, STATEMENT_QUEUE_SIZE)
+                  && queue_init(&pipeline.looked_up, STATEMENT_QUEUE_SIZE)
+                  && queue_init(&pipeline.formatted, STATEMENT_QUEUE_SIZE);
+    
+    if (ready) {
+        void* (*stages[3])(void*) = {statement_fetch_stage, statement_lookup_stage, statement_format_stage};
+        struct bounded_queue* inputs[3] = {NULL, &pipeline.fetched, &pipeline.looked_up};
+        struct bounded_queue* outputs[3] = {&pipeline.fetched, &pipeline.looked_up, &pipeline.formatted};
+        pthread_t threads[3];
+        int started[3];
+        
+        for (int i = 0; i < 3; i++) {
+            started[i] = (pthread_create(&threads[i], NULL, stages[i], &pipeline) == 0);
+            if (!started[i]) {
+                // Closing both sides lets the neighbours of a missing stage finish
+                atomic_store(&pipeline.failed, 1);
+                if (inputs[i] != NULL) queue_close(inputs[i]);
+                queue_close(outputs[i]);
+            }
+        }
+        
+        statement_write_stage(&pipeline);
+        
+        for (int i = 0; i < 3; i++) {
+            if (started[i]) pthread_join(threads[i], NULL);
+        }
+    } else {
+        printf("Error: Not enough memory for the statement pipeline\n");
+        atomic_store(&pipeline.failed, 1);
+    }
+    
+    if (pipeline.fetched.items) queue_destroy(&pipeline.fetched);
+    if (pipeline.looked_up.items) queue_destroy(&pipeline.looked_up);
+    if (pipeline.formatted.items) queue_destroy(&pipeline.formatted);
+    free(pipeline.history);
+    free(pipeline.history_offsets);
+    
+    fclose(pipeline.data_ptr);
+    if (to_stdout) {
+        fflush(stdout);
+    } else {
+        fclose(pipeline.output_ptr);
+    }
+    
+    if (stats != NULL) {
+        stats->records = pipeline.written;
+        stats->seconds = elapsed_seconds(&start);
+    }
+    return atomic_load(&pipeline.failed) ? -1 : pipeline.written;
+}
+
+/*
+ * WORK-STEALING POOL
+ * 
+ * The batch jobs split their input into tasks and run them on a
+ * work_pool. Every worker has its own deque: it runs its own newest
+ * task first, and when it runs dry it steals the oldest task of a
+ * randomly chosen victim. Work therefore flows to whichever workers
+ * are free, so chunks that take longer than others (dense regions of
+ * the data file, import chunks full of long rows) do not leave the
+ * rest of the threads idle.
+ * 
+ * The thread that creates the pool is worker 0: it submits the tasks
+ * and runs them alongside the helpers inside work_pool_wait. A pool
+ * with one thread therefore needs no threads at all, and a helper that
+ * cannot be created just means fewer workers.
+ */
+
+/*
+ * WORK_POOL_CREATE
+ * 
+ * Purpose: Start a pool of 'threads' workers (including the caller)
+ * Returns: the pool, or NULL if memory ran out
+ */
+struct work_pool* work_pool_create(int threads) {
+    if (threads < 1) threads = 1;
+    if (threads > MAX_POOL_THREADS) threads = MAX_POOL_THREADS;
+    
+    struct work_pool* pool = calloc(1, sizeof(struct work_pool));
+    if (pool == NULL) return NULL;
+    
+    pool->threads = threads;
+    pool->deques = calloc(threads, sizeof(struct work_deque));
+    pool->helpers = calloc(threads, sizeof(pthread_t));
+    if (pool->deques == NULL || pool->helpers == NULL) {
+        free(pool->deques);
+        free(pool->helpers);
+        free(pool);
+        return NULL;
+    }
+    
+    for (int i = 0; i < threads; i++) pthread_mutex_init(&pool->deques[i].lock, NULL);
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->work_available, NULL);
+    atomic_init(&pool->pending, 0);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->steals, 0);
+    atomic_init(&pool->next_worker, 1);
+    
+    // A helper that fails to start leaves its deque empty; nothing is lost
+    while (pool->helpers_started < threads - 1 &&
+           pthread_create(&pool->helpers[pool->helpers_started], NULL, work_pool_helper, pool) == 0) {
+        pool->helpers_started++;
+    }
+    return pool;
+}
+
+/*
+ * WORK_POOL_DESTROY
+ * 
+ * Purpose: Stop the helpers and free the pool (all work must be done)
+ */
+void work_pool_destroy(struct work_pool* pool) {
+    if (pool == NULL) return;
+    
+    pthread_mutex_lock(&pool->idle_lock);
+    pool->shutting_down = 1;
+    pthread_cond_broadcast(&pool->work_available);
+    pthread_mutex_unlock(&pool->idle_lock);
+    
+    for (int i = 0; i < pool->helpers_started; i++) pthread_join(pool->helpers[i], NULL);
+    
+    for (int i = 0; i < pool->threads; i++) pthread_mutex_destroy(&pool->deques[i].lock);
+    pthread_mutex_destroy(&pool->idle_lock);
+    pthread_cond_destroy(&pool->work_available);
+    free(pool->deques);
+    free(pool->helpers);
+    free(pool);
+}
+
+/*
+ * WORK_POOL_SUBMIT
+ * 
+ * Purpose: Queue a task on a worker's own deque
+ * Parameters: worker - the calling worker (0 outside of tasks)
+ * 
+ * If that deque is full the task runs right away instead.
+ */
+void work_pool_submit(struct work_pool* pool, int worker, work_function function, void* arg) {
+    struct work_deque* deque = &pool->deques[worker];
+    atomic_fetch_add(&pool->pending, 1);
+    
+    pthread_mutex_lock(&deque->lock);
+    int queued = (deque->bottom - deque->top < WORK_DEQUE_SIZE);
+    if (queued) {
+        deque->tasks[deque->bottom % WORK_DEQUE_SIZE] = (struct work_task){function, arg};
+        deque->bottom++;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    
+    if (!queued) {
+        function(pool, worker, arg);
+        atomic_fetch_sub(&pool->pending, 1);
+        return;
+    }
+    
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_mutex_lock(&pool->idle_lock);
+    pthread_cond_signal(&pool->work_available);
+    pthread_mutex_unlock(&pool->idle_lock);
+}
+
+/*
+ * WORK_POOL_RUN_ONE
+ * 
+ * Purpose: Run one task: the worker's newest, else one stolen from
+ * the top of another deque, starting at a random victim
+ * Returns: 1 if a task ran, 0 if every deque was empty
+ */
+int work_pool_run_one(struct work_pool* pool, int worker, unsigned int* seed) {
+    struct work_task task;
+    int found = 0;
+    
+    struct work_deque* own = &pool->deques[worker];
+    pthread_mutex_lock(&own->lock);
+    if (own->bottom > own->top) {
+        own->bottom--;
+        task = own->tasks[own->bottom % WORK_DEQUE_SIZE];
+        found = 1;
+    }
+    pthread_mutex_unlock(&own->lock);
+    
+    if (!found && pool->threads > 1) {
+        // xorshift keeps victim choice cheap and different per worker
+        *seed ^= *seed << 13;
+        *seed ^= *seed >> 17;
+        *seed ^= *seed << 5;
+        int first_victim = (int)(*seed % (unsigned int)pool->threads);
+        
+        for (int i = 0; i < pool->threads && !found; i++) {
+            int victim = (first_victim + i) % pool->threads;
+            if (victim == worker) continue;
+            
+            struct work_deque* deque = &pool->deques[victim];
+            pthread_mutex_lock(&deque->lock);
+            if (deque->bottom > deque->top) {
+                task = deque->tasks[deque->top % WORK_DEQUE_SIZE];
+                deque->top++;
+                found = 1;
+            }
+            pthread_mutex_unlock(&deque->lock);
+        }
+        if (found) atomic_fetch_add(&pool->steals, 1);
+    }
+    
+    if (!found) return 0;
+    
+    atomic_fetch_sub(&pool->queued, 1);
+    task.function(pool, worker, task.arg);
+    atomic_fetch_sub(&pool->pending, 1);
+    return 1;
+}
+
+/*
+ * WORK_POOL_HELPER
+ * 
+ * Purpose: Helper thread body - run and steal tasks, sleep while
+ * there is nothing queued anywhere
+ */
+void* work_pool_helper(void* arg) {
+    struct work_pool* pool = arg;
+    
+    int worker = atomic_fetch_add(&pool->next_worker, 1);
+    unsigned int seed = 2654435761u * (unsigned int)worker;
+    
+    for (;;) {
+        if (work_pool_run_one(pool, worker, &seed)) continue;
+        
+        pthread_mutex_lock(&pool->idle_lock);
+        while (!pool->shutting_down && atomic_load(&pool->queued) == 0) {
+            pthread_cond_wait(&pool->work_available, &pool->idle_lock);
+        }
+        int stop = pool->shutting_down;
+        pthread_mutex_unlock(&pool->idle_lock);
+        if (stop) break;
+    }
+    return NULL;
+}
+
+/*
+ * WORK_POOL_WAIT
+ * 
+ * Purpose: Run tasks on the calling thread (worker 0) until every
+ * submitted task, including the ones tasks submitted, has finished
+ */
+void work_pool_wait(struct work_pool* pool) {
+    unsigned int seed = 2463534242u;
+    while (atomic_load(&pool->pending) > 0) {
+        if (!work_pool_run_one(pool, 0, &seed)) sched_yield();  // Helpers hold the last tasks
+    }
+}
+
+/*
+ * ACCOUNT_SCAN_TASK
+ * 
+ * Purpose: Scan a range of grains, splitting it in half and queueing
+ * the upper half while it is larger than one grain
+ * 
+ * Splitting lazily like this leaves big ranges at the top of every
+ * deque for thieves, so a worker stuck in a dense region of the file
+ * sheds the rest of its range to idle workers.
+ */
+void account_scan_task(struct work_pool* pool, int worker, void* arg) {
+    struct account_scan_task* task = arg;
+    struct account_scan* scan = task->scan;
+    long first = task->first;
+    long count = task->count;
+    
+    while (count > 1) {
+        long half = count / 2;
+        struct account_scan_task* upper = &scan->tasks[atomic_fetch_add(&scan->next_task, 1)];
+        upper->scan = scan;
+        upper->first = first + count - half;
+        upper->count = half;
+        work_pool_submit(pool, worker, account_scan_task, upper);
+        count -= half;
+    }
+    
+    long first_position = first * SCAN_GRAIN;
+    long records = scan->record_count - first_position;
+    if (records > SCAN_GRAIN) records = SCAN_GRAIN;
+    scan->handler(scan->context, worker, scan->records + first_position, first_position, records);
+}
+
+/*
+ * SCAN_ACCOUNTS_PARALLEL
+ * 
+ * Purpose: Hand every record of a data file to 'handler', in ranges
+ * spread over a work-stealing pool
+ * Parameters:
+ *   - data_path: data file to scan (memory-mapped read-only)
+ *   - threads: pool size
+ *   - handler: called for consecutive ranges of records, concurrently,
+ *     with the worker number (0 .. threads-1) for per-worker totals
+ * Returns: number of records scanned, or -1 on error
+ */
+long scan_accounts_parallel(const char* data_path, int threads, account_range_handler handler, void* context) {
+    size_t size;
+    const char* data = map_text_file(data_path, &size);
+    if (data == NULL) {
+        FILE* file_ptr = fopen(data_path, "rb");
+        if (file_ptr == NULL) {
+            printf("Error: Could not open data file '%s'\n", data_path);
+            return -1;
+        }
+        fclose(file_ptr);
+        return 0;  // Empty file
+    }
+    
+    struct account_scan scan;
+    scan.records = (const struct client_data*)data;
+    scan.record_count = (long)(size / RECORD_SIZE);
+    scan.handler = handler;
+    scan.context = context;
+    
+    long grains = (scan.record_count + SCAN_GRAIN - 1) / SCAN_GRAIN;
+    struct arena arena;
+    arena_init(&arena, ARENA_BLOCK_SIZE);
+    scan.tasks = arena_alloc(&arena, (grains > 0 ? grains : 1) * sizeof(struct account_scan_task));
+    atomic_init(&scan.next_task, 1);
+    
+    struct work_pool* pool = (scan.tasks != NULL) ? work_pool_create(threads) : NULL;
+    if (pool == NULL) {
+        printf("Error: Not enough memory to scan '%s'\n", data_path);
+        arena_release(&arena);
+        unmap_text_file(data, size);
+        return -1;
+    }
+    
+    if (grains > 0) {
+        scan.tasks[0] = (struct account_scan_task){&scan, 0, grains};
+        work_pool_submit(pool, 0, account_scan_task, &scan.tasks[0]);
+        work_pool_wait(pool);
+    }
+    
+    work_pool_destroy(pool);
+    arena_release(&arena);
+    unmap_text_file(data, size);
+    return scan.record_count;
+}
+
+/*
+ * SUMMARIZE_ACCOUNT_RANGE
+ * 
+ * Purpose: scan_accounts_parallel handler adding a range of records to
+ * the calling worker's own account_summary (context is the array of them)
+ */
+void summarize_account_range(void* context, int worker, const struct client_data* records,
+                             long first_position, long count) {
+    struct account_summary* summary = (struct account_summary*)context + worker;
+    (void)first_position;
+    
+    for (long i = 0; i < count; i++) {
+        if (records[i].acct_num == 0) continue;
+        summary->accounts++;
+        summary->total_cents += balance_to_cents(records[i].balance);
+        if (records[i].balance < 0) summary->overdrawn++;
+    }
+}
+
+/*
+ * SUMMARIZE_ACCOUNTS
+ * 
+ * Purpose: Count accounts, overdrawn accounts and the total balance of
+ * a data file with a parallel scan
+ * Returns: number of records scanned, or -1 on error
+ */
+long summarize_accounts(const char* data_path, int threads, struct account_summary* summary) {
+    struct account_summary partial[MAX_POOL_THREADS];
+    memset(partial, 0, sizeof(partial));
+    memset(summary, 0, sizeof(*summary));
+    
+    long scanned = scan_accounts_parallel(data_path, threads, summarize_account_range, partial);
+    
+    // Totals are in cents, so the merge order cannot change the result
+    for (int i = 0; i < MAX_POOL_THREADS; i++) {
+        summary->accounts += partial[i].accounts;
+        summary->overdrawn += partial[i].overdrawn;
+        summary->total_cents += partial[i].total_cents;
+    }
+    return scanned;
+}
+
+/*
+ * BATCH JOB: INTEREST ACCRUAL
+ * 
+ * Credits interest to every positive balance, on the parallel scan of
+ * the data file. Rates are tiered like a marginal tax: with tiers
+ * "0.10% from $0, 0.15% from $1,000" a $1,500.00 balance earns 0.10%
+ * of its first $1,000 and 0.15% of the remaining $500.
+ * 
+ * Each grain of the scan is handled in four steps:
+ * 
+ * 1. Grains whose mapped records hold no positive balance are skipped
+ *    without taking any lock (a balance that turns positive just then
+ *    counts as arriving after the run).
+ * 2. The grain's records are locked with one range lock (which keeps
+ *    tellers off them for the few microseconds the grain takes) and
+ *    read again, so the accrual works from current balances.
+ * 3. The balances become a column of cents, and the interest of the
+ *    whole column is computed at once (accrue_interest_column), two
+ *    accounts per SSE2 instruction.
+ * 4. Credited records get their new balance and a new version stamp,
+ *    the grain is written back with one write and unlocked, and its
+ *    history entries go to the history file with one fwrite.
+ * 
+ * Amounts are exact: the column holds whole cents as doubles, which
+ * are exact below 2^53, and a grain is only computed with SIMD if its
+ * largest balance times the largest rate stays below that. Interest is
+ * rounded to the nearest cent, ties to even, the same in the scalar
+ * code (interest_cents, integers only) as in the SIMD code.
+ * 
+ * A session that has a credited account in its account table sees
+ * the new version stamp on its next write and reloads the record, as
+ * with any other concurrent change.
+ */
+
+/*
+ * INTEREST_CENTS
+ * 
+ * Purpose: Interest due on one balance (0 for balances <= 0)
+ * 
+ * Each tier's part is split into whole multiples of
+ * INTEREST_RATE_UNIT and the rest, so no product overflows 64 bits
+ * even for the largest balances.
+ */
+long long interest_cents(long long balance_cents, const struct interest_tiers* tiers) {
+    long long whole = 0;      // Interest in cents, before adding the remainders
+    long long remainder = 0;  // In millionths of a cent
+    
+    for (int t = 0; t < tiers->count; t++) {
+        long long portion = balance_cents - tiers->floor_cents[t];
+        if (portion <= 0) break;
+        if (t + 1 < tiers->count && portion > tiers->floor_cents[t + 1] - tiers->floor_cents[t]) {
+            portion = tiers->floor_cents[t + 1] - tiers->floor_cents[t];
+        }
+        whole += (portion / INTEREST_RATE_UNIT) * tiers->rate[t];
+        remainder += (portion % INTEREST_RATE_UNIT) * tiers->rate[t];
+    }
+    
+    whole += remainder / INTEREST_RATE_UNIT;
+    remainder %= INTEREST_RATE_UNIT;
+    if (2 * remainder > INTEREST_RATE_UNIT || (2 * remainder == INTEREST_RATE_UNIT && (whole & 1))) whole++;
+    return whole;
+}
+
+/*
+ * ACCRUE_INTEREST_COLUMN
+ * 
+ * Purpose: Interest due on a column of balances in cents
+ * Parameters: cents/interest - 'count' balances in, interest out (both
+ * whole numbers of cents); every balance times every rate must be
+ * below INTEREST_EXACT_LIMIT
+ * 
+ * Per account the sum of (part of the balance in the tier) x (rate)
+ * is exact, one division by INTEREST_RATE_UNIT rounds it, and adding
+ * and subtracting 2^52 rounds that to a whole cent (ties to even).
+ */
+void accrue_interest_column(const double* cents, double* interest, long count, const struct interest_tiers* tiers) {
+    long i = 0;
+#ifdef __SSE2__
+    __m128d floors[INTEREST_MAX_TIERS], widths[INTEREST_MAX_TIERS], rates[INTEREST_MAX_TIERS];
+    for (int t = 0; t < tiers->count; t++) {
+        floors[t] = _mm_set1_pd((double)tiers->floor_cents[t]);
+        widths[t] = _mm_set1_pd((t + 1 < tiers->count) ? (double)(tiers->floor_cents[t + 1] - tiers->floor_cents[t])
+                                                       : INTEREST_EXACT_LIMIT);
+        rates[t] = _mm_set1_pd((double)tiers->rate[t]);
+    }
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d unit = _mm_set1_pd((double)INTEREST_RATE_UNIT);
+    const __m128d to_cent = _mm_set1_pd(4503599627370496.0);  // 2^52
+    
+    for (; i + 2 <= count; i += 2) {
+        __m128d balance = _mm_loadu_pd(cents + i);
+        __m128d scaled = zero;
+        for (int t = 0; t < tiers->count; t++) {
+            __m128d portion = _mm_min_pd(_mm_max_pd(_mm_sub_pd(balance, floors[t]), zero), widths[t]);
+            scaled = _mm_add_pd(scaled, _mm_mul_pd(portion, rates[t]));
+        }
+        __m128d due = _mm_div_pd(scaled, unit);
+        _mm_storeu_pd(interest + i, _mm_sub_pd(_mm_add_pd(due, to_cent), to_cent));
+    }
+#endif
+    for (; i < count; i++) interest[i] = (double)interest_cents((long long)cents[i], tiers);
+}
+
+/*
+ * ACCRUE_INTEREST_RANGE
+ * 
+ * Purpose: scan_accounts_parallel handler crediting the interest of one
+ * grain (context is the interest_job)
+ */
+void accrue_interest_range(void* context, int worker, const struct client_data* records,
+                           long first_position, long count) {
+    struct interest_job* job = context;
+    struct interest_worker* own = &job->workers[worker];
+    
+    // Only grains with something to credit are locked
+    long positive = 0;
+    for (long i = 0; i < count; i++) positive += (records[i].acct_num != 0 && records[i].balance > 0);
+    if (positive == 0) {
+        own->grains_skipped++;
+        return;
+    }
+    
+    if (!lock_record_range(job->fd, first_position, count, 1)) {
+        own->ok = 0;
+        return;
+    }
+    
+    long max_rate = 0;
+    for (int t = 0; t < job->tiers.count; t++) {
+        if (job->tiers.rate[t] > max_rate) max_rate = job->tiers.rate[t];
+    }
+    
+    size_t size = (size_t)count * RECORD_SIZE;
+    off_t offset = (off_t)first_position * RECORD_SIZE;
+    long credited = 0;
+    if (pread(job->fd, own->records, size, offset) == (ssize_t)size) {
+        double largest = 0.0;
+        for (long i = 0; i < count; i++) {
+            const struct client_data* client = &own->records[i];
+            int earns = client->acct_num != 0 && client->balance > 0 &&
+                        !account_flag(job->flags, client->acct_num, ACCOUNT_CLOSED);
+            own->cents[i] = earns ? (double)balance_to_cents(client->balance) : 0.0;
+            if (own->cents[i] > largest) largest = own->cents[i];
+        }
+        
+        if (largest * max_rate < INTEREST_EXACT_LIMIT) {
+            accrue_interest_column(own->cents, own->interest, count, &job->tiers);
+        } else {
+            for (long i = 0; i < count; i++) {
+                own->interest[i] = (double)interest_cents((long long)own->cents[i], &job->tiers);
+            }
+        }
+        
+        for (long i = 0; i < count; i++) {
+            if (own->interest[i] <= 0) continue;
+            
+            struct client_data* client = &own->records[i];
+            long long due = (long long)own->interest[i];
+            client->balance = ((long long)own->cents[i] + due) / 100.0;
+            client->version++;
+            
+            struct transaction_record* entry = &own->entries[credited++];
+            memset(entry, 0, sizeof(*entry));
+            entry->acct_num = client->acct_num;
+            entry->timestamp = job->timestamp;
+            entry->amount = due / 100.0;
+            entry->balance_after = client->balance;
+            own->interest_cents += due;
+        }
+        
+        if (credited > 0 && pwrite(job->fd, own->records, size, offset) != (ssize_t)size) {
+            own->ok = 0;
+            credited = 0;
+        }
+    } else {
+        own->ok = 0;
+    }
+    lock_record_range(job->fd, first_position, count, 0);
+    
+    own->accounts += credited;
+    if (credited > 0 && fwrite(own->entries, sizeof(struct transaction_record), credited, job->history_ptr) !=
+                        (size_t)credited) {
+        own->ok = 0;
+    }
+}
+
+/*
+ * ACCRUE_INTEREST
+ * 
+ * Purpose: Credit interest to every positive balance of a data file
+ * and record each credit in the history file
+ * Returns: number of records scanned, or -1 on error (summary
+ * describes what was done even then)
+ */
+long accrue_interest(const char* data_path, const char* history_path, int threads,
+                     const struct interest_tiers* tiers, struct interest_summary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    if (threads < 1) threads = 1;
+    if (threads > MAX_POOL_THREADS) threads = MAX_POOL_THREADS;
+    
+    struct interest_job* job = aligned_alloc(64, sizeof(struct interest_job));
+    if (job == NULL) return -1;
+    memset(job, 0, sizeof(*job));
+    job->tiers = *tiers;
+    job->timestamp = (long long)time(NULL);
+    job->fd = open(data_path, O_RDWR);
+    job->history_ptr = fopen(history_path, "ab");
+    job->flags = account_flags_open(data_path, 0);
+    
+    int ok = job->fd >= 0 && job->history_ptr != NULL;
+    for (int w = 0; ok && w < threads; w++) {
+        struct interest_worker* own = &job->workers[w];
+        own->records = malloc(SCAN_GRAIN * RECORD_SIZE);
+        own->cents = malloc(SCAN_GRAIN * sizeof(double));
+        own->interest = malloc(SCAN_GRAIN * sizeof(double));
+        own->entries = malloc(SCAN_GRAIN * sizeof(struct transaction_record));
+        own->ok = 1;
+        ok = own->records != NULL && own->cents != NULL && own->interest != NULL && own->entries != NULL;
+    }
+    
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long scanned = ok ? scan_accounts_parallel(data_path, threads, accrue_interest_range, job) : -1;
+    summary->seconds = elapsed_seconds(&start);
+    summary->records = (scanned > 0) ? scanned : 0;
+    
+    for (int w = 0; w < threads; w++) {
+        struct interest_worker* own = &job->workers[w];
+        summary->accounts += own->accounts;
+        summary->interest_cents += own->interest_cents;
+        summary->grains_skipped += own->grains_skipped;
+        if (scanned >= 0 && !own->ok) scanned = -1;
+        free(own->records);
+        free(own->cents);
+        free(own->interest);
+        free(own->entries);
+    }
+    
+    if (job->flags != NULL) account_flags_close(job->flags);
+    if (job->history_ptr != NULL && fclose(job->history_ptr) != 0) scanned = -1;
+    if (job->fd >= 0) close(job->fd);
+    if (!ok) printf("Error: Could not open '%s' and '%s' for the interest run\n", data_path, history_path);
+    free(job);
+    return scanned;
+}
+
+/*
+ * PARSE_INTEREST_TIERS
+ * 
+ * Purpose: Tiers from "version3 interest" arguments: a rate, then
+ * "<balance>:<rate>" for each further tier, rates in percent per run
+ * with up to four decimals (e.g. 0.1 1000.00:0.15 10000.00:0.2)
+ * Returns: 1 on success, 0 if an argument is malformed
+ */
+int parse_interest_tiers(int count, char* arguments[], struct interest_tiers* tiers) {
+    memset(tiers, 0, sizeof(*tiers));
+    if (count < 1 || count > INTEREST_MAX_TIERS) return 0;
+    
+    for (int t = 0; t < count; t++) {
+        const char* rate_text = arguments[t];
+        if (t > 0) {
+            const char* colon = strchr(arguments[t], ':');
+            size_t error_position;
+            if (colon == NULL ||
+                parse_amount_cents(arguments[t], (size_t)(colon - arguments[t]), &tiers->floor_cents[t],
+                                   &error_position) != AMOUNT_OK ||
+                tiers->floor_cents[t] <= tiers->floor_cents[t - 1]) {
+                return 0;
+            }
+            rate_text = colon + 1;
+        }
+        
+        if (!parse_rate_percent(rate_text, &tiers->rate[t])) return 0;
+    }
+    tiers->count = count;
+    return 1;
+}
+
+/*
+ * PARSE_RATE_PERCENT
+ * 
+ * Purpose: A rate in percent, 0 to 100 with up to four decimals
+ * Returns: 1 with the rate in millionths (INTEREST_RATE_UNIT), 0 if
+ * malformed
+ * 
+ * Read digit by digit like parse_amount_cents: digits [. 1-4 digits],
+ * so exponents, hex, "nan" and a fifth decimal are all rejected rather
+ * than rounded.
+ */
+int parse_rate_percent(const char* text, long* rate) {
+    long whole = 0, fraction = 0;
+    int whole_digits = 0, places = 0;
+    const char* p = text;
+    for (; *p >= '0' && *p <= '9'; p++) {
+        if (++whole_digits > 3) return 0;
+        whole = whole * 10 + (*p - '0');
+    }
+    if (*p == '.') {
+        for (p++; *p >= '0' && *p <= '9'; p++) {
+            if (++places > 4) return 0;
+            fraction = fraction * 10 + (*p - '0');
+        }
+    }
+    if (*p != '\0' || whole_digits + places == 0) return 0;
+    for (; places < 4; places++) fraction *= 10;
+    
+    // Percent with four decimals is a whole number of millionths
+    long millionths = whole * (INTEREST_RATE_UNIT / 100) + fraction * (INTEREST_RATE_UNIT / 1000000);
+    if (millionths > INTEREST_RATE_UNIT) return 0;
+    *rate = millionths;
+    return 1;
+}
+
+/*
+ * BATCH JOB: OVERDRAFT FEES
+ * 
+ * Charges a fee to every overdrawn account, once a night. The job does
+ * not scan the data file to find them: the status flag file holds an
+ * index of the accounts that may be below zero (account_flags.overdrawn,
+ * one bit per account), to which every command, menu update and hot
+ * account fold that leaves a balance below zero adds its account. The
+ * candidates are the set bits of FLAG_WORDS words of memory.
+ * 
+ * Nothing takes an account out of the index when it is paid back, so
+ * the index may name accounts that are no longer overdrawn, but not
+ * miss one that is. The job reads each candidate before charging it,
+ * and drops from the index those that are back at zero or above, or
+ * deleted. Writers that do not keep the index (the bulk importer) mark
+ * it stale, and the next run first rebuilds it with one parallel scan;
+ * so does the first run on a data file. Sessions started before the
+ * flag file existed do not keep it either: "fees --rebuild" covers
+ * them.
+ * 
+ * Each account is charged under its own record lock, held for one read
+ * and one write, so a teller waits a few microseconds at most, and
+ * only on the account being charged. A session with the account in its
+ * table sees the new version stamp and reloads it, as with any other
+ * concurrent change. Closed accounts are not charged.
+ */
+
+/*
+ * INDEX_OVERDRAWN_RANGE
+ * 
+ * Purpose: scan_accounts_parallel handler adding the overdrawn accounts
+ * of one grain to the index (context is the account_flags)
+ */
+void index_overdrawn_range(void* context, int worker, const struct client_data* records,
+                           long first_position, long count) {
+    struct account_flags* flags = context;
+    (void)worker;
+    (void)first_position;
+    
+    for (long i = 0; i < count; i++) {
+        if (records[i].acct_num != 0) account_flags_note_balance(flags, records[i].acct_num, records[i].balance);
+    }
+}
+
+/*
+ * INDEX_OVERDRAWN_ACCOUNTS
+ * 
+ * Purpose: Rebuild the overdrawn index from a scan of the data file
+ * Returns: number of records scanned, or -1 on error (the index stays
+ * marked stale)
+ * 
+ * Bits are only added: an account paid back during the scan is dropped
+ * by the fee run, and one overdrawn during it is added by its writer.
+ * The index is marked current before the scan, so a bulk import that
+ * marks it stale meanwhile is not overlooked.
+ */
+long index_overdrawn_accounts(const char* data_path, struct account_flags* flags, int threads) {
+    atomic_store_explicit(&flags->indexed, 1, memory_order_release);
+    long scanned = scan_accounts_parallel(data_path, threads, index_overdrawn_range, flags);
+    if (scanned < 0) atomic_store_explicit(&flags->indexed, 0, memory_order_release);
+    return scanned;
+}
+
+/*
+ * OVERDRAFT_FEE_CENTS
+ * 
+ * Purpose: Fee for an account overdrawn by 'overdrawn_cents' (0 if it
+ * is not overdrawn), the rate part rounded like interest
+ */
+long long overdraft_fee_cents(long long overdrawn_cents, const struct overdraft_fees* fees) {
+    if (overdrawn_cents <= 0) return 0;
+    
+    struct interest_tiers rate = {.count = 1, .rate = {fees->rate}};
+    long long fee = fees->flat_cents + interest_cents(overdrawn_cents, &rate);
+    return (fees->cap_cents > 0 && fee > fees->cap_cents) ? fees->cap_cents : fee;
+}
+
+/*
+ * CHARGE_OVERDRAFT_FEES
+ * 
+ * Purpose: Charge the overdraft fee to every overdrawn account found
+ * through the index, and record each fee in the history file
+ * Parameters:
+ *   - rebuild: 1 to rebuild the index first even if it is current
+ *   - report_ptr: one line per account charged (NULL for none)
+ * Returns: number of accounts charged, or -1 on error (summary
+ * describes what was done even then)
+ */
+long charge_overdraft_fees(const char* data_path, const char* history_path, const struct overdraft_fees* fees,
+                           int rebuild, FILE* report_ptr, struct overdraft_summary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    int fd = open(data_path, O_RDWR);
+    FILE* history_ptr = fopen(history_path, "ab");
+    struct account_flags* flags = (fd >= 0) ? account_flags_open(data_path, 1) : NULL;
+    int ok = fd >= 0 && history_ptr != NULL && flags != NULL;
+    if (!ok) printf("Error: Could not open '%s' and '%s' for the overdraft run\n", data_path, history_path);
+    
+    if (ok && (rebuild || atomic_load_explicit(&flags->indexed, memory_order_acquire) != 1)) {
+        summary->rebuilt = 1;
+        ok = index_overdrawn_accounts(data_path, flags, (int)sysconf(_SC_NPROCESSORS_ONLN)) >= 0;
+    }
+    
+    for (unsigned int word = 0; ok && word < FLAG_WORDS; word++) {
+        unsigned long long candidates = atomic_load_explicit(&flags->overdrawn[word], memory_order_acquire);
+        while (ok && candidates != 0) {
+            unsigned int acct_num = word * 64 + (unsigned int)__builtin_ctzll(candidates);
+            candidates &= candidates - 1;
+            summary->candidates++;
+            
+            // Read, charge and write back one record under its own lock
+            long position = (long)acct_num - 1;
+            off_t offset = (off_t)position * RECORD_SIZE;
+            struct client_data client;
+            long long before = 0, fee = 0;
+            if (!lock_record_range(fd, position, 1, 1)) {
+                ok = 0;
+                break;
+            }
+            ssize_t got = pread(fd, &client, RECORD_SIZE, offset);
+            if (got == (ssize_t)RECORD_SIZE && client.acct_num == acct_num && client.balance < 0) {
+                before = balance_to_cents(client.balance);
+                if (!account_flag(flags, acct_num, ACCOUNT_CLOSED)) fee = overdraft_fee_cents(-before, fees);
+                if (fee > 0) {
+                    client.balance = (before - fee) / 100.0;
+                    client.version++;
+                    ok = pwrite(fd, &client, RECORD_SIZE, offset) == (ssize_t)RECORD_SIZE;
+                }
+            } else if (got >= 0) {
+                // Cleared while still locked, so a writer overdrawing it again re-adds it after us
+                atomic_fetch_and_explicit(&flags->overdrawn[word], ~(1ULL << (acct_num % 64)), memory_order_acq_rel);
+                summary->cleared++;
+            } else {
+                ok = 0;
+            }
+            lock_record_range(fd, position, 1, 0);
+            
+            if (!ok || before == 0) continue;
+            summary->overdrawn_cents += fee - before;
+            if (fee == 0) {
+                summary->skipped++;
+                continue;
+            }
+            
+            ok = append_transaction(history_ptr, acct_num, -fee / 100.0, client.balance);
+            summary->charged++;
+            summary->fee_cents += fee;
+            if (report_ptr != NULL) {
+                fprintf(report_ptr, "%-6u %-15s %-10s %12.2f %10.2f %12.2f\n", acct_num, client.last_name,
+                        client.first_name, before / 100.0, -fee / 100.0, client.balance);
+            }
+        }
+    }
+    
+    if (flags != NULL) account_flags_close(flags);
+    if (history_ptr != NULL && fclose(history_ptr) != 0) ok = 0;
+    if (fd >= 0) close(fd);
+    summary->seconds = elapsed_seconds(&start);
+    return ok ? summary->charged : -1;
+}
+
+/*
+ * PARSE_OVERDRAFT_FEES
+ * 
+ * Purpose: Fees from "version3 fees" arguments: the flat fee, then
+ * optionally a rate in percent of the amount overdrawn and a cap
+ * (e.g. 25.00 1.5 40.00)
+ * Returns: 1 on success, 0 if an argument is malformed
+ */
+int parse_overdraft_fees(int count, char* arguments[], struct overdraft_fees* fees) {
+    memset(fees, 0, sizeof(*fees));
+    if (count < 1 || count > 3) return 0;
+    
+    size_t error_position;
+    if (parse_amount_cents(arguments[0], strlen(arguments[0]), &fees->flat_cents, &error_position) != AMOUNT_OK ||
+        fees->flat_cents < 0) {
+        return 0;
+    }
+    if (count > 1 && !parse_rate_percent(arguments[1], &fees->rate)) return 0;
+    if (count > 2 && (parse_amount_cents(arguments[2], strlen(arguments[2]), &fees->cap_cents,
+                                         &error_position) != AMOUNT_OK || fees->cap_cents <= 0)) {
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * BATCH JOB: STANDING ORDERS
+ * 
+ * Recurring transfers ("pay $50.00 from 17 to 42 every week") are kept
+ * in "<data file>.orders", one standing_order record per order, and
+ * made by "version3 run-orders", which a scheduler runs as often as the
+ * shortest interval in use.
+ * 
+ * A run puts the active orders in a min-heap on their due time, built
+ * in one pass, and pops orders while the top one is due, so finding
+ * the k due orders among n costs O(n + k log n) and they come out
+ * oldest first: when an account cannot cover all of its orders, the
+ * ones that fell due earliest are paid.
+ * 
+ * Due orders are made in batches of up to ORDER_BATCH:
+ * 
+ * 1. Every order of the batch is moved to its next due time and the
+ *    order file synced, before any money moves. A crash can then skip
+ *    a batch (the history shows which transfers were made) but never
+ *    pay one twice.
+ * 2. The accounts the batch involves are locked with one range lock and
+ *    read with one read.
+ * 3. The transfers are made in memory, in due order, each one whole or
+ *    not at all, under the rules of the "transfer" command: frozen and
+ *    closed accounts, overdrafts not allowed and debits beyond the
+ *    velocity limits (counting the batch's own) are refused.
+ * 4. The changed records get a new version stamp and are written back
+ *    with one write, the lock is released, and the history entries go
+ *    to the history file with one fwrite.
+ * 5. Each order whose transfer was written uses up one of its payments
+ *    (a refused one does not) and counts as a debit for the velocity
+ *    limits, and the order file is synced again. A
+ *    crash just before this leaves the batch's payments uncounted, so
+ *    an order for n payments can make one more.
+ * 
+ * Tellers wait for a batch only while it is applied in memory, which
+ * takes microseconds. An order that missed several due times (nothing
+ * ran it) is made once, not once per missed time, and moves to its
+ * first due time after the run. The order file is locked for the whole
+ * run, so two runs never make the same order twice; adding or
+ * cancelling an order waits for the run to end.
+ */
+
+/*
+ * ORDER_FILE_OPEN
+ * 
+ * Purpose: Lock and map the order file of a data file
+ * Parameters: create - 1 to create the order file if it does not exist yet
+ * Returns: 1 on success (release with order_file_close), 0 if there is
+ * no order file (and create is 0) or it cannot be mapped
+ */
+int order_file_open(struct order_file* file, const char* data_path, int create) {
+    memset(file, 0, sizeof(*file));
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, ORDERS_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return 0;
+    
+    file->fd = open(path, O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (file->fd < 0) return 0;
+    
+    struct stat info;
+    int ok = flock(file->fd, LOCK_EX) == 0 && fstat(file->fd, &info) == 0 &&
+             info.st_size % sizeof(struct standing_order) == 0;
+    file->count = ok ? (long)(info.st_size / sizeof(struct standing_order)) : 0;
+    if (ok && file->count > 0) {
+        void* mapping = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, file->fd, 0);
+        file->orders = (mapping == MAP_FAILED) ? NULL : mapping;
+        ok = (file->orders != NULL);
+    }
+    
+    if (!ok) {
+        close(file->fd);
+        return 0;
+    }
+    return 1;
+}
+
+void order_file_close(struct order_file* file) {
+    if (file->orders != NULL) {
+        size_t size = file->count * sizeof(struct standing_order);
+        msync(file->orders, size, MS_SYNC);
+        munmap(file->orders, size);
+    }
+    flock(file->fd, LOCK_UN);
+    close(file->fd);
+}
+
+/*
+ * ADD_STANDING_ORDERS
+ * 
+ * Purpose: Append orders to the order file (their ids are assigned here)
+ * Returns: id of the first order added, or -1 on error
+ */
+long add_standing_orders(const char* data_path, const struct standing_order* orders, long count) {
+    struct order_file file;
+    if (!order_file_open(&file, data_path, 1)) return -1;
+    
+    struct standing_order* added = malloc(count * sizeof(*added));
+    long first_id = file.count + 1;
+    for (long i = 0; added != NULL && i < count; i++) {
+        added[i] = orders[i];
+        added[i].id = (unsigned int)(first_id + i);
+        added[i].last_status = -1;
+    }
+    
+    size_t size = count * sizeof(*added);
+    off_t offset = (off_t)file.count * sizeof(*added);
+    int ok = added != NULL && pwrite(file.fd, added, size, offset) == (ssize_t)size && fdatasync(file.fd) == 0;
+    free(added);
+    order_file_close(&file);
+    return ok ? first_id : -1;
+}
+
+/*
+ * CANCEL_STANDING_ORDER
+ * 
+ * Purpose: Stop an order; it stays in the order file as finished
+ * Returns: 1 on success, 0 if there is no such active order
+ */
+int cancel_standing_order(const char* data_path, unsigned int id) {
+    struct order_file file;
+    if (!order_file_open(&file, data_path, 0)) return 0;
+    
+    int found = id >= 1 && id <= file.count && file.orders[id - 1].remaining != 0;
+    if (found) file.orders[id - 1].remaining = 0;
+    order_file_close(&file);
+    return found;
+}
+
+/*
+ * ORDER HEAP
+ * 
+ * Purpose: Binary min-heap of order positions on (next_due, position),
+ * so orders due at the same time come out in the order they were added
+ */
+int order_due_first(const struct standing_order* orders, unsigned int a, unsigned int b) {
+    return orders[a].next_due < orders[b].next_due || (orders[a].next_due == orders[b].next_due && a < b);
+}
+
+void order_heap_sift_down(struct order_heap* heap, long i) {
+    for (;;) {
+        long child = 2 * i + 1;
+        if (child >= heap->count) return;
+        if (child + 1 < heap->count && order_due_first(heap->orders, heap->items[child + 1], heap->items[child])) {
+            child++;
+        }
+        if (!order_due_first(heap->orders, heap->items[child], heap->items[i])) return;
+        
+        unsigned int swap = heap->items[i];
+        heap->items[i] = heap->items[child];
+        heap->items[child] = swap;
+        i = child;
+    }
+}
+
+void order_heap_push(struct order_heap* heap, unsigned int position) {
+    long i = heap->count++;
+    while (i > 0 && order_due_first(heap->orders, position, heap->items[(i - 1) / 2])) {
+        heap->items[i] = heap->items[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    heap->items[i] = position;
+}
+
+unsigned int order_heap_pop(struct order_heap* heap) {
+    unsigned int top = heap->items[0];
+    heap->items[0] = heap->items[--heap->count];
+    order_heap_sift_down(heap, 0);
+    return top;
+}
+
+/*
+ * APPLY_ORDER_BATCH
+ * 
+ * Purpose: Make the transfers of a batch of due orders, in order, under
+ * one range lock over the accounts involved (steps 2 to 4 above)
+ * Returns: 1 on success, 0 on an I/O error
+ * 
+ * An order counts as made, and uses up one of its payments, only once
+ * the records are written; if that write fails its status is IO_ERROR.
+ */
+int apply_order_batch(struct order_run* run, struct standing_order* orders, const unsigned int* batch,
+                      long count, struct order_summary* summary) {
+    long first = MAX_ACCOUNTS, last = -1;
+    for (long i = 0; i < count; i++) {
+        const struct standing_order* order = &orders[batch[i]];
+        if (!validate_account_number(order->from_acct) || !validate_account_number(order->to_acct)) continue;
+        long low = (order->from_acct < order->to_acct ? order->from_acct : order->to_acct) - 1;
+        long high = (order->from_acct > order->to_acct ? order->from_acct : order->to_acct) - 1;
+        if (low < first) first = low;
+        if (high > last) last = high;
+    }
+    
+    long span = (last >= first) ? last - first + 1 : 0;
+    struct client_data* records = run->records;
+    if (span > 0 && !lock_record_range(run->fd, first, span, 1)) return 0;
+    
+    // Positions past the end of the file read as empty records
+    memset(records, 0, sizeof(run->records));
+    memset(run->changed, 0, sizeof(run->changed));
+    memset(run->debits, 0, sizeof(run->debits));
+    memset(run->debited_cents, 0, sizeof(run->debited_cents));
+    ssize_t got = (span > 0) ? pread(run->fd, records, span * RECORD_SIZE, (off_t)first * RECORD_SIZE) : 0;
+    if (got < 0) {
+        lock_record_range(run->fd, first, span, 0);
+        return 0;
+    }
+    
+    long dirty_first = span, dirty_last = -1;
+    long entries = 0;
+    long long timestamp = (long long)time(NULL);
+    long long velocity_time = velocity_now();
+    for (long i = 0; i < count; i++) {
+        struct standing_order* order = &orders[batch[i]];
+        struct command command = {.type = COMMAND_TRANSFER, .acct_num = order->from_acct,
+                                  .target_acct = order->to_acct, .cents = order->cents};
+        struct command_result result;
+        memset(&result, 0, sizeof(result));
+        
+        int status = validate_command(&command, &result);
+        if (status == COMMAND_OK) {
+            status = account_flags_refusal(run->flags, COMMAND_TRANSFER, command.acct_num, command.target_acct,
+                                           result.detail, sizeof(result.detail));
+        }
+        if (status == COMMAND_OK && run->velocity != NULL && command.cents > 0) {
+            long payer = command.acct_num - 1;
+            status = velocity_check(run->velocity, command.acct_num, run->debits[payer] + 1,
+                                    run->debited_cents[payer] + command.cents, velocity_time, result.detail,
+                                    sizeof(result.detail));
+        }
+        
+        struct client_data* from = NULL;
+        struct client_data* to = NULL;
+        long long from_cents = 0;
+        if (status == COMMAND_OK) {
+            from = &records[command.acct_num - 1 - first];
+            to = &records[command.target_acct - 1 - first];
+            if (from->acct_num != command.acct_num || to->acct_num != command.target_acct) {
+                snprintf(result.detail, sizeof(result.detail), "account %u not found",
+                         (from->acct_num != command.acct_num) ? command.acct_num : command.target_acct);
+                status = COMMAND_NOT_FOUND;
+            }
+        }
+        if (status == COMMAND_OK) {
+            from_cents = balance_to_cents(from->balance) - command.cents;
+            if (from_cents < 0 && !account_flag(run->flags, command.acct_num, ACCOUNT_OVERDRAFT)) {
+                snprintf(result.detail, sizeof(result.detail), "account %u may not be overdrawn", command.acct_num);
+                status = COMMAND_NO_OVERDRAFT;
+            }
+        }
+        
+        if (status == COMMAND_OK) {
+            from->balance = from_cents / 100.0;
+            to->balance = (balance_to_cents(to->balance) + command.cents) / 100.0;
+            account_flags_note_balance(run->flags, command.acct_num, from->balance);
+            run->debits[command.acct_num - 1]++;
+            run->debited_cents[command.acct_num - 1] += command.cents;
+            
+            long positions[2] = {command.acct_num - 1 - first, command.target_acct - 1 - first};
+            for (int side = 0; side < 2; side++) {
+                run->changed[positions[side]] = 1;
+                if (positions[side] < dirty_first) dirty_first = positions[side];
+                if (positions[side] > dirty_last) dirty_last = positions[side];
+                
+                struct transaction_record* entry = &run->entries[entries++];
+                memset(entry, 0, sizeof(*entry));
+                entry->acct_num = side ? command.target_acct : command.acct_num;
+                entry->timestamp = timestamp;
+                entry->amount = (side ? command.cents : -command.cents) / 100.0;
+                entry->balance_after = side ? to->balance : from->balance;
+            }
+        } else {
+            order->refused++;
+            summary->refused++;
+            if (run->report_ptr != NULL) {
+                fprintf(run->report_ptr, "ERR %s order %u: %s\n", command_status_name(status), order->id, result.detail);
+            }
+        }
+        order->last_status = status;
+    }
+    
+    // Each changed record gets one new version stamp, however many transfers touched it;
+    // unchanged records between them are written back as they were read
+    int ok = 1;
+    if (dirty_last >= dirty_first) {
+        for (long i = dirty_first; i <= dirty_last; i++) records[i].version += run->changed[i];
+        size_t size = (dirty_last - dirty_first + 1) * RECORD_SIZE;
+        ok = pwrite(run->fd, &records[dirty_first], size, (off_t)(first + dirty_first) * RECORD_SIZE) ==
+             (ssize_t)size;
+    }
+    if (span > 0) lock_record_range(run->fd, first, span, 0);
+    
+    // Only now are the transfers made: count them and audit the batch
+    for (long i = 0; i < count; i++) {
+        struct standing_order* order = &orders[batch[i]];
+        if (order->last_status == COMMAND_OK && !ok) {
+            order->last_status = COMMAND_IO_ERROR;
+        } else if (order->last_status == COMMAND_OK) {
+            if (order->remaining > 0) order->remaining--;
+            order->executed++;
+            if (run->velocity != NULL && order->cents > 0) {
+                velocity_record(run->velocity, order->from_acct, order->cents, velocity_time);
+            }
+            summary->executed++;
+            summary->cents += order->cents;
+        }
+        if (run->audit != NULL) {
+            struct command command = {.type = COMMAND_TRANSFER, .acct_num = order->from_acct,
+                                      .target_acct = order->to_acct, .cents = order->cents};
+            audit_record(run->audit, &command, order->last_status);
+        }
+    }
+    
+    if (ok && entries > 0) {
+        ok = fwrite(run->entries, sizeof(struct transaction_record), entries, run->history_ptr) == (size_t)entries;
+    }
+    return ok;
+}
+
+/*
+ * RUN_STANDING_ORDERS
+ * 
+ * Purpose: Make every order due at 'now' (seconds since the epoch)
+ * Parameters:
+ *   - audit: log recording every transfer made or refused, or NULL
+ *   - report_ptr: one line per refused order (NULL for none)
+ * Returns: number of transfers made, or -1 on error (summary describes
+ * what was done even then)
+ */
+long run_standing_orders(const char* data_path, const char* history_path, long long now,
+                         struct audit_log* audit, FILE* report_ptr, struct order_summary* summary) {
+    memset(summary, 0, sizeof(*summary));
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct order_file file;
+    if (!order_file_open(&file, data_path, 0)) return 0;  // No orders
+    
+    struct order_run* run = calloc(1, sizeof(*run));
+    unsigned int* batch = malloc(ORDER_BATCH * sizeof(*batch));
+    struct order_heap heap = {malloc((file.count + 1) * sizeof(unsigned int)), 0, file.orders};
+    if (run != NULL) {
+        run->fd = open(data_path, O_RDWR);
+        run->history_ptr = fopen(history_path, "ab");
+        run->entries = malloc(2 * ORDER_BATCH * sizeof(struct transaction_record));
+        run->flags = account_flags_open(data_path, 0);
+        run->velocity = velocity_tracker_open(data_path);
+        run->audit = (audit != NULL) ? audit_ring_attach(audit) : NULL;
+        run->report_ptr = report_ptr;
+    }
+    int ok = run != NULL && batch != NULL && heap.items != NULL && run->fd >= 0 && run->history_ptr != NULL &&
+             run->entries != NULL;
+    if (!ok) printf("Error: Could not open '%s' and '%s' for the standing orders\n", data_path, history_path);
+    
+    // Heapify the active orders in one pass
+    for (long i = 0; ok && i < file.count; i++) {
+        if (file.orders[i].remaining != 0) heap.items[heap.count++] = (unsigned int)i;
+    }
+    for (long i = heap.count / 2 - 1; i >= 0; i--) order_heap_sift_down(&heap, i);
+    summary->orders = heap.count;
+    
+    while (ok && heap.count > 0 && file.orders[heap.items[0]].next_due <= now) {
+        long count = 0;
+        while (count < ORDER_BATCH && heap.count > 0 && file.orders[heap.items[0]].next_due <= now) {
+            batch[count++] = order_heap_pop(&heap);
+        }
+        
+        // Step 1: the batch is moved on, on disk, before it is made
+        for (long i = 0; i < count; i++) {
+            struct standing_order* order = &file.orders[batch[i]];
+            long long interval = (order->interval > 0) ? order->interval : 1;
+            order->next_due += interval * ((now - order->next_due) / interval + 1);
+        }
+        ok = msync(file.orders, file.count * sizeof(struct standing_order), MS_SYNC) == 0 &&
+             apply_order_batch(run, file.orders, batch, count, summary);
+        
+        // Step 5: the payments used up follow the transfers to disk
+        if (msync(file.orders, file.count * sizeof(struct standing_order), MS_SYNC) != 0) ok = 0;
+        
+        for (long i = 0; i < count; i++) {
+            if (file.orders[batch[i]].remaining != 0) order_heap_push(&heap, batch[i]);
+        }
+        summary->due += count;
+        summary->batches++;
+    }
+    if (heap.count > 0) summary->next_due = file.orders[heap.items[0]].next_due;
+    
+    if (run != NULL) {
+        if (run->audit != NULL) audit_ring_detach(run->audit);
+        if (run->flags != NULL) account_flags_close(run->flags);
+        if (run->velocity != NULL) velocity_tracker_close(run->velocity);
+        if (run->history_ptr != NULL && fclose(run->history_ptr) != 0) ok = 0;
+        if (run->fd >= 0) close(run->fd);
+        free(run->entries);
+        free(run);
+    }
+    free(batch);
+    free(heap.items);
+    order_file_close(&file);
+    summary->seconds = elapsed_seconds(&start);
+    return ok ? summary->executed : -1;
+}
+
+/*
+ * PARSE_ORDER_INTERVAL
+ * 
+ * Purpose: An interval such as "12h", "1d" or "2w" (a bare number is
+ * in days)
+ * Returns: 1 with the interval in seconds, 0 if malformed
+ */
+int parse_order_interval(const char* text, long long* seconds) {
+    char* end;
+    long long count = strtoll(text, &end, 10);
+    if (end == text || count <= 0 || count > 3650) return 0;
+    
+    long long unit;
+    switch (*end) {
+        case 'h':  unit = 3600; break;
+        case '\0':
+        case 'd':  unit = 86400; break;
+        case 'w':  unit = 7 * 86400; break;
+        default:   return 0;
+    }
+    if (*end != '\0' && end[1] != '\0') return 0;
+    
+    *seconds = count * unit;
+    return 1;
+}
+
+/*
+ * PRINT_STANDING_ORDERS
+ * 
+ * Purpose: List every order with its schedule and outcome ("version3 orders")
+ * Returns: 1 on success, 0 if the order file cannot be read
+ */
+int print_standing_orders(const char* data_path, FILE* output_ptr) {
+    struct order_file file;
+    if (!order_file_open(&file, data_path, 0)) {
+        fprintf(output_ptr, "OK 0 (no standing orders for '%s')\n", data_path);
+        return access(data_path, F_OK) == 0;
+    }
+    
+    fprintf(output_ptr, "%-6s %-6s %-6s %12s %9s %-16s %9s %8s %7s %s\n", "Order", "From", "To", "Amount",
+            "Every", "Next Due", "Left", "Made", "Refused", "Last");
+    for (long i = 0; i < file.count; i++) {
+        const struct standing_order* order = &file.orders[i];
+        char every[32], due[32], left[32];
+        long long interval = order->interval;
+        if (interval % (7 * 86400) == 0) {
+            snprintf(every, sizeof(every), "%lldw", interval / (7 * 86400));
+        } else if (interval % 86400 == 0) {
+            snprintf(every, sizeof(every), "%lldd", interval / 86400);
+        } else {
+            snprintf(every, sizeof(every), "%lldh", interval / 3600);
+        }
+        
+        time_t when = (time_t)order->next_due;
+        struct tm local;
+        localtime_r(&when, &local);
+        strftime(due, sizeof(due), "%Y-%m-%d %H:%M", &local);
+        if (order->remaining == 0) {
+            snprintf(due, sizeof(due), "finished");
+            snprintf(left, sizeof(left), "0");
+        } else if (order->remaining < 0) {
+            snprintf(left, sizeof(left), "no end");
+        } else {
+            snprintf(left, sizeof(left), "%lld", order->remaining);
+        }
+        
+        fprintf(output_ptr, "%-6u %-6u %-6u %12.2f %9s %-16s %9s %8lld %7lld %s\n", order->id, order->from_acct,
+                order->to_acct, order->cents / 100.0, every, due, left, order->executed, order->refused,
+                (order->last_status < 0) ? "-" : command_status_name(order->last_status));
+    }
+    fprintf(output_ptr, "OK %ld\n", file.count);
+    
+    order_file_close(&file);
+    return 1;
+}
+
+/*
+ * BATCH JOB: BULK IMPORT
+ * 
+ * Loads text files in the clients.dat format, one account per line:
+ * 
+ *   100 Jones      900.00
+ * 
+ * The file is memory-mapped and parsed in place. Lines are split with
+ * a 16-bytes-at-a-time newline search, fields are parsed by hand
+ * instead of scanf, and records whose positions follow each other are
+ * collected into runs written with a single fwrite.
+ */
+
+/*
+ * MAP_TEXT_FILE
+ * 
+ * Purpose: Map a whole text file read-only into memory
+ * Parameters: path - file to map, size - receives its length
+ * Returns: pointer to the contents, or NULL on error or for an empty file
+ */
+const char* map_text_file(const char* path, size_t* size) {
+    *size = 0;
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    
+    void* text = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);  // The mapping stays valid after close
+    if (text == MAP_FAILED) return NULL;
+    
+    madvise(text, info.st_size, MADV_SEQUENTIAL);
+    *size = info.st_size;
+    return text;
+}
+
+void unmap_text_file(const char* text, size_t size) {
+    if (text != NULL) munmap((void*)text, size);
+}
+
+/*
+ * FIND_NEWLINE
+ * 
+ * Purpose: Locate the next '\n' in [start, end)
+ * Returns: pointer to the newline, or end if there is none
+ * 
+ * With SSE2 the search compares 16 bytes per instruction and uses the
+ * resulting bit mask to jump straight to the first match.
+ */
+const char* find_newline(const char* start, const char* end) {
+    const char* p = start;
+    
+#ifdef __SSE2__
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, newline));
+        if (mask != 0) {
+            return p + __builtin_ctz(mask);
+        }
+        p += 16;
+    }
+#endif
+    
+    while (p < end && *p != '\n') p++;
+    return p;
+}
+
+/*
+ * SKIP_FIELD_SEPARATOR
+ * 
+ * Purpose: Step over the gap between two fields: blanks with at most
+ * one comma among them, so "100 Jones 9.00" and "100, Jones,9.00" both work
+ * Returns: pointer to the start of the next field
+ */
+const char* skip_field_separator(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p < end && *p == ',') p++;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    return p;
+}
+
+/*
+ * PARSE_CLIENT_ROW
+ * 
+ * Purpose: Parse one "acct last balance" line (blank or comma separated)
+ * Parameters: line/end - the line without its '\n', client - receives the record
+ * Returns: 1 for a well-formed row, 0 for a malformed one
+ * 
+ * The characters of the name are not checked here: callers validate
+ * names in bulk with normalize_names_batch.
+ */
+int parse_client_row(const char* line, const char* end, struct client_data* client) {
+    const char* p = line;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    
+    // Account number
+    const char* digits = p;
+    unsigned long acct = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        acct = acct * 10 + (*p - '0');
+        if (acct > MAX_IMPORT_ACCOUNT) return 0;
+        p++;
+    }
+    if (p == digits || acct == 0) return 0;
+    const char* field = skip_field_separator(p, end);
+    if (field == p) return 0;  // Fields must be separated
+    p = field;
+    
+    // Last name (a single word, like new_record's %14s)
+    const char* name = p;
+    while (p < end && *p != ' ' && *p != '\t' && *p != ',') p++;
+    size_t name_length = p - name;
+    if (name_length == 0 || name_length >= sizeof(client->last_name)) return 0;
+    p = skip_field_separator(p, end);
+    
+    // Balance: the rest of the line (the parser ignores trailing blanks and '\r')
+    long long cents;
+    size_t error_position;
+    if (parse_amount_cents(p, end - p, &cents, &error_position) != AMOUNT_OK) return 0;
+    
+    memset(client, 0, sizeof(*client));
+    client->acct_num = (unsigned int)acct;
+    memcpy(client->last_name, name, name_length);
+    client->balance = cents / 100.0;
+    
+    return 1;
+}
+
+/*
+ * FLUSH_IMPORT_RUN
+ * 
+ * Purpose: Write 'count' records that occupy consecutive file positions
+ * Parameters: current - scratch space for 'count' records
+ * Returns: 1 on success, 0 on failure
+ * 
+ * Imported rows replace their slots unconditionally, but like every
+ * other writer they bump the version stamp the slot had, under a lock
+ * on the run's records, so an interactive edit that read the old
+ * record ends in a conflict instead of overwriting the import (see
+ * OPTIMISTIC UPDATES). Slots past the end of the file read as empty.
+ */
+int flush_import_run(FILE* data_ptr, struct client_data* run, struct client_data* current,
+                     long first_position, int count) {
+    if (count == 0) return 1;
+    int fd = fileno(data_ptr);
+    if (!lock_record_range(fd, first_position, count, 1)) return 0;
+    
+    size_t size = (size_t)count * RECORD_SIZE;
+    off_t offset = (off_t)first_position * RECORD_SIZE;
+    memset(current, 0, size);
+    int ok = (pread(fd, current, size, offset) >= 0);
+    for (int i = 0; ok && i < count; i++) run[i].version = (unsigned short)(current[i].version + 1);
+    ok = ok && (pwrite(fd, run, size, offset) == (ssize_t)size);
+    
+    lock_record_range(fd, first_position, count, 0);
+    return ok;
+}
+
+/*
+ * PARSE_IMPORT_CHUNK
+ * 
+ * Purpose: Pool task - parse every line of one chunk
+ * Each non-blank line becomes one import_row, in file order; malformed
+ * lines are kept as rows with acct_num 0 so the merge can report them.
+ */
+void parse_import_chunk(struct work_pool* pool, int worker, void* arg) {
+    struct import_chunk* chunk = arg;
+    struct arena* arena = &chunk->arenas[worker];
+    (void)pool;
+    const char* line = chunk->start;
+    
+    chunk->rows = NULL;
+    chunk->row_count = 0;
+    chunk->row_capacity = 0;
+    chunk->line_count = 0;
+    
+    while (line < chunk->end) {
+        const char* newline = find_newline(line, chunk->end);
+        
+        const char* p = line;
+        while (p < newline && isspace((unsigned char)*p)) p++;
+        
+        if (p < newline) {
+            if (chunk->row_count == chunk->row_capacity) {
+                // Typical rows are 20-30 bytes, so one estimate is usually enough
+                long capacity = chunk->row_capacity > 0 ? chunk->row_capacity * 2
+                                                        : (chunk->end - chunk->start) / 16 + 1;
+                struct import_row* rows = arena_grow(arena, chunk->rows, chunk->row_capacity * sizeof(struct import_row),
+                                                     capacity * sizeof(struct import_row));
+                if (rows == NULL) {
+                    chunk->failed = 1;
+                    return;
+                }
+                chunk->rows = rows;
+                chunk->row_capacity = capacity;
+            }
+            
+            struct import_row* row = &chunk->rows[chunk->row_count++];
+            row->line = chunk->line_count;
+            if (!parse_client_row(line, newline, &row->client)) {
+                memset(&row->client, 0, sizeof(row->client));
+            }
+        }
+        
+        chunk->line_count++;
+        line = newline + 1;
+    }
+    
+    // Check the chunk's names in bulk; rows with a bad name become malformed rows
+    unsigned char valid[NAME_BATCH];
+    for (long first = 0; first < chunk->row_count; first += NAME_BATCH) {
+        long count = (chunk->row_count - first < NAME_BATCH) ? chunk->row_count - first : NAME_BATCH;
+        normalize_names_batch(chunk->rows[first].client.last_name, sizeof(struct import_row),
+                              sizeof(chunk->rows[first].client.last_name), count, valid);
+        for (long r = 0; r < count; r++) {
+            if (!valid[r]) chunk->rows[first + r].client.acct_num = 0;
+        }
+    }
+}
+
+/*
+ * SCAN_IMPORT_TEXT
+ * 
+ * Purpose: Parse a mapped import file and hand every row to 'handler'
+ * Parameters:
+ *   - text/size: file contents
+ *   - threads: work pool size (1 parses on the calling thread)
+ *   - handler: called once per non-blank line, in file order, with the
+ *     parsed record (NULL for a malformed row) and its 1-based line number;
+ *     returning 0 stops the scan
+ *   - context: passed through to handler
+ *   - stats: if not NULL, the arena counters are added to it
+ * Returns: 1 on success, 0 if memory ran out or the handler stopped the scan
+ * 
+ * The input is cut into IMPORT_CHUNK_BYTES chunks, each boundary moved
+ * forward to the end of the line it falls in. Each round, a few chunks
+ * per thread are parsed on a work-stealing pool and then handed over
+ * on the calling thread in file order, so what the handler sees never
+ * depends on timing.
+ * 
+ * Rows live in the arena of the worker that parsed them; the arenas
+ * are reset after every round, so after the first round parsing
+ * allocates nothing.
+ */
+int scan_import_text(const char* text, size_t size, int threads,
+                     import_row_handler handler, void* context, struct batch_stats* stats) {
+    struct work_pool* pool = work_pool_create(threads);
+    int round_chunks = (pool != NULL) ? pool->threads * IMPORT_CHUNKS_PER_THREAD : 0;
+    struct import_chunk* chunks = calloc(round_chunks > 0 ? round_chunks : 1, sizeof(struct import_chunk));
+    struct arena* arenas = (pool != NULL) ? malloc(pool->threads * sizeof(struct arena)) : NULL;
+    if (pool == NULL || chunks == NULL || arenas == NULL) {
+        printf("Error: Not enough memory to parse the import file\n");
+        work_pool_destroy(pool);
+        free(chunks);
+        free(arenas);
+        return 0;
+    }
+    for (int i = 0; i < pool->threads; i++) arena_init(&arenas[i], IMPORT_CHUNK_BYTES);
+    for (int i = 0; i < round_chunks; i++) chunks[i].arenas = arenas;
+    
+    long line_base = 0;  // Lines in all chunks already handed over
+    int ok = 1;
+    
+    const char* end = text + size;
+    const char* next = text;
+    while (ok && next < end) {
+        // Cut up to 'round_chunks' chunks, each ending just after a newline
+        int chunk_count = 0;
+        while (chunk_count < round_chunks && next < end) {
+            struct import_chunk* chunk = &chunks[chunk_count++];
+            chunk->start = next;
+            chunk->failed = 0;
+            if ((size_t)(end - next) <= IMPORT_CHUNK_BYTES) {
+                chunk->end = end;
+            } else {
+                const char* newline = find_newline(next + IMPORT_CHUNK_BYTES, end);
+                chunk->end = (newline < end) ? newline + 1 : end;
+            }
+            next = chunk->end;
+        }
+        
+        // Parse the chunks concurrently; queued last-first so the
+        // calling thread starts on chunk 0 while helpers steal from the end
+        for (int i = chunk_count - 1; i >= 0; i--) {
+            work_pool_submit(pool, 0, parse_import_chunk, &chunks[i]);
+        }
+        work_pool_wait(pool);
+        
+        // Hand rows over in file order
+        for (int i = 0; ok && i < chunk_count; i++) {
+            struct import_chunk* chunk = &chunks[i];
+            if (chunk->failed) {
+                printf("Error: Not enough memory to parse the import file\n");
+                ok = 0;
+                break;
+            }
+            
+            for (long r = 0; ok && r < chunk->row_count; r++) {
+                const struct import_row* row = &chunk->rows[r];
+                ok = handler(context, row->client.acct_num != 0 ? &row->client : NULL,
+                             line_base + row->line + 1);
+            }
+            line_base += chunk->line_count;
+        }
+        
+        for (int i = 0; i < pool->threads; i++) arena_reset(&arenas[i]);
+    }
+    
+    for (int i = 0; i < pool->threads; i++) {
+        if (stats != NULL) {
+            stats->allocations += arenas[i].allocations;
+            stats->mallocs += arenas[i].mallocs;
+        }
+        arena_release(&arenas[i]);
+    }
+    free(arenas);
+    free(chunks);
+    work_pool_destroy(pool);
+    return ok;
+}
+
+/*
+ * IMPORT_WRITE_ROW
+ * 
+ * Purpose: scan_import_text handler for the importer - report bad rows,
+ * accounts outside the data file's range and duplicates (the first row
+ * for an account wins) and gather the rest into runs of consecutive
+ * positions
+ * Returns: 1 to continue, 0 on a write error
+ */
+int import_write_row(void* context, const struct client_data* client, long line_number) {
+    struct import_writer* writer = context;
+    
+    if (client == NULL) {
+        writer->rejected++;
+        if (writer->report_ptr) fprintf(writer->report_ptr, "line %ld: invalid row\n", line_number);
+        return 1;
+    }
+    
+    unsigned int acct = client->acct_num;
+    if (!validate_account_number(acct)) {
+        writer->rejected++;
+        if (writer->report_ptr) {
+            fprintf(writer->report_ptr, "line %ld: invalid row (account %u is outside %d-%d)\n",
+                    line_number, acct, MIN_ACCOUNT_NUM, MAX_ACCOUNT_NUM);
+        }
+        return 1;
+    }
+    if (writer->seen[acct / 8] & (1u << (acct % 8))) {
+        writer->rejected++;
+        if (writer->report_ptr) fprintf(writer->report_ptr, "line %ld: duplicate account %u\n", line_number, acct);
+        return 1;
+    }
+    writer->seen[acct / 8] |= (unsigned char)(1u << (acct % 8));
+    
+    long position = acct - 1;
+    if (writer->run_length == IMPORT_BATCH ||
+        (writer->run_length > 0 && position != writer->run_start + writer->run_length)) {
+        if (!flush_import_run(writer->data_ptr, writer->run, writer->current, writer->run_start,
+                              writer->run_length)) {
+            return 0;
+        }
+        writer->run_length = 0;
+    }
+    if (writer->run_length == 0) writer->run_start = position;
+    writer->run[writer->run_length++] = *client;
+    writer->imported++;
+    return 1;
+}
+
+/*
+ * IMPORT_CLIENTS_TEXT
+ * 
+ * Purpose: Load every row of a clients.dat-style text file into the data file
+ * Parameters:
+ *   - text_path: text file to import
+ *   - data_path: binary account file (created if missing)
+ *   - threads: number of parser threads
+ *   - report_ptr: receives one line per rejected row (may be NULL)
+ *   - stats: receives imported/rejected counts and elapsed time (may be NULL)
+ * Returns: number of records written, or -1 on error
+ * 
+ * Rows are stored at position acct_num - 1 like every other record, so
+ * an imported account replaces whatever the slot held; rows for
+ * accounts outside 1-MAX_ACCOUNT_NUM are rejected. A new data file is
+ * sized for every slot first; slots never written read back as empty
+ * records.
+ * The overdrawn index is marked stale afterwards, for the next
+ * overdraft run to rebuild.
+ */
+long import_clients_text(const char* text_path, const char* data_path, int threads,
+                         FILE* report_ptr, struct batch_stats* stats) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    size_t size;
+    const char* text = map_text_file(text_path, &size);
+    if (text == NULL) {
+        printf("Error: Could not read import file '%s'\n", text_path);
+        return -1;
+    }
+    
+    struct import_writer writer;
+    memset(&writer, 0, sizeof(writer));
+    writer.report_ptr = report_ptr;
+    writer.data_ptr = fopen(data_path, "rb+");
+    if (writer.data_ptr == NULL) writer.data_ptr = fopen(data_path, "wb+");
+    
+    // A new (or short) file gets all its slots, as initialize_data_file_if_needed gives them
+    struct stat info;
+    off_t full_size = (off_t)MAX_ACCOUNTS * RECORD_SIZE;
+    if (writer.data_ptr != NULL &&
+        (fstat(fileno(writer.data_ptr), &info) != 0 ||
+         (info.st_size < full_size && ftruncate(fileno(writer.data_ptr), full_size) != 0))) {
+        fclose(writer.data_ptr);
+        writer.data_ptr = NULL;
+    }
+    writer.run = malloc(IMPORT_BATCH * sizeof(struct client_data));
+    writer.current = malloc(IMPORT_BATCH * sizeof(struct client_data));
+    writer.seen = calloc(MAX_ACCOUNTS / 8 + 1, 1);  // One bit per account
+    
+    if (writer.data_ptr == NULL || writer.run == NULL || writer.current == NULL || writer.seen == NULL) {
+        printf("Error: Could not prepare data file '%s' for import\n", data_path);
+        if (writer.data_ptr) fclose(writer.data_ptr);
+        free(writer.run);
+        free(writer.current);
+        free(writer.seen);
+        unmap_text_file(text, size);
+        return -1;
+    }
+    
+    struct batch_stats scan_stats;
+    memset(&scan_stats, 0, sizeof(scan_stats));
+    int ok = scan_import_text(text, size, threads, import_write_row, &writer, &scan_stats);
+    ok = ok && flush_import_run(writer.data_ptr, writer.run, writer.current, writer.run_start, writer.run_length);
+    ok = (fclose(writer.data_ptr) == 0) && ok;
+    free(writer.run);
+    free(writer.current);
+    free(writer.seen);
+    unmap_text_file(text, size);
+    account_flags_invalidate_index(data_path);  // Overdrawn rows were not added to the index
+    
+    if (!ok) {
+        printf("Error: Could not import '%s' into '%s'\n", text_path, data_path);
+        return -1;
+    }
+    
+    if (stats != NULL) {
+        stats->records = writer.imported;
+        stats->rejected = writer.rejected;
+        stats->seconds = elapsed_seconds(&start);
+        stats->allocations = scan_stats.allocations;
+        stats->mallocs = scan_stats.mallocs;
+    }
+    return writer.imported;
+}
+
+/*
+ * BATCH JOB: STORE FILE BUILDER
+ * 
+ * Builds a read-optimized "store file" from an import file. Unlike
+ * accounts.dat, which reserves one slot per possible account number,
+ * the store file packs records densely, sorted by account number:
+ * 
+ *   page 0        store_header
+ *   data pages    up to STORE_DATA_CAPACITY sorted records each
+ *   index pages   (first account, child page) pairs, one tree level each
+ *   name pages    only in a dictionary-encoded store (see below)
+ * 
+ * The builder sorts the input once, then makes a single sequential
+ * pass: every full data page is written immediately and its first key
+ * is added to the level-1 index page; a full index page is written the
+ * same way and its first key is pushed one level up. The tree is
+ * therefore built bottom-up while the data is written, and no page is
+ * ever rewritten except the header.
+ * 
+ * A dictionary-encoded store (STORE_FORMAT_NAMES) keeps encoded_client
+ * records, whose names are ids in a name dictionary. That makes a
+ * record 24 bytes instead of 40, so a data page holds
+ * STORE_ENCODED_CAPACITY (170) records instead of 102. The dictionary
+ * follows the index as an array of name_count text offsets and then
+ * the names themselves, each NUL-terminated.
+ */
+
+/*
+ * COLLECT_STORE_ROW
+ * 
+ * Purpose: scan_import_text handler for the builder - keep valid rows
+ * with their line numbers for sorting
+ * Returns: 1 to continue, 0 when out of memory
+ */
+int collect_store_row(void* context, const struct client_data* client, long line_number) {
+    struct store_row_list* list = context;
+    
+    if (client == NULL) {
+        list->rejected++;
+        if (list->report_ptr) fprintf(list->report_ptr, "line %ld: invalid row\n", line_number);
+        return 1;
+    }
+    
+    if (list->count == list->capacity) {
+        long capacity = list->capacity > 0 ? list->capacity * 2 : 65536;
+        struct import_row* rows = realloc(list->rows, capacity * sizeof(struct import_row));
+        if (rows == NULL) return 0;
+        list->rows = rows;
+        list->capacity = capacity;
+    }
+    
+    list->rows[list->count].client = *client;
+    list->rows[list->count].line = line_number;
+    list->count++;
+    return 1;
+}
+
+/*
+ * SORT_ROW_KEYS
+ * 
+ * Purpose: Order rows by account number, keeping file order for equal accounts
+ * Parameters: keys - (acct_num << 32 | row index) per row, count - number of keys
+ * Returns: 1 on success, 0 on allocation failure
+ * 
+ * An LSD radix sort over the account bytes. Each pass is stable, so
+ * rows with the same account stay in row-index (file) order; passes
+ * where every key has the same byte are skipped.
+ */
+int sort_row_keys(unsigned long long* keys, long count) {
+    unsigned long long* buffer = malloc((count > 0 ? count : 1) * sizeof(unsigned long long));
+    if (buffer == NULL) return 0;
+    
+    unsigned long long* from = keys;
+    unsigned long long* to = buffer;
+    
+    for (int shift = 32; shift < 64; shift += 8) {
+        long counts[256] = {0};
+        for (long i = 0; i < count; i++) counts[(from[i] >> shift) & 0xFF]++;
+        
+        // Skip the pass if all keys share this byte
+        if (count == 0 || counts[(from[0] >> shift) & 0xFF] == count) continue;
+        
+        long offset = 0;
+        for (int b = 0; b < 256; b++) {
+            long bucket = counts[b];
+            counts[b] = offset;
+            offset += bucket;
+        }
+        for (long i = 0; i < count; i++) to[counts[(from[i] >> shift) & 0xFF]++] = from[i];
+        
+        unsigned long long* swap = from;
+        from = to;
+        to = swap;
+    }
+    
+    if (from != keys) memcpy(keys, from, count * sizeof(unsigned long long));
+    free(buffer);
+    return 1;
+}
+
+/*
+ * STORE_WRITE_PAGE
+ * 
+ * Purpose: Append one page to the store file
+ * Returns: the page number written, or 0 on a write error (page 0 is the header)
+ */
+unsigned int store_write_page(struct store_builder* builder, const union store_page* page) {
+    if (fwrite(page, STORE_PAGE_SIZE, 1, builder->store_ptr) != 1) return 0;
+    return builder->next_page++;
+}
+
+/*
+ * STORE_ADD_INDEX_ENTRY
+ * 
+ * Purpose: Add a (first account, child page) entry to the index page
+ * being filled at 'level', writing that page first if it is full
+ * Returns: 1 on success, 0 on a write error
+ */
+int store_add_index_entry(struct store_builder* builder, int level, unsigned int first_acct, unsigned int child) {
+    if (level > STORE_MAX_LEVELS) return 0;
+    
+    union store_page* page = &builder->levels[level - 1];
+    if (level > builder->level_count) {
+        builder->level_count = level;
+        memset(page, 0, sizeof(*page));
+        page->index.level = level;
+    }
+    
+    if (page->index.count == STORE_INDEX_CAPACITY) {
+        unsigned int written = store_write_page(builder, page);
+        if (written == 0) return 0;
+        builder->pages_at_level[level - 1]++;
+        if (!store_add_index_entry(builder, level + 1, page->index.entries[0].first_acct, written)) return 0;
+        
+        memset(page, 0, sizeof(*page));
+        page->index.level = level;
+    }
+    
+    page->index.entries[page->index.count].first_acct = first_acct;
+    page->index.entries[page->index.count].page = child;
+    page->index.count++;
+    return 1;
+}
+
+/*
+ * STORE_FLUSH_DATA_PAGE
+ * 
+ * Purpose: Write the data page being filled and index it
+ * Returns: 1 on success, 0 on a write error
+ */
+int store_flush_data_page(struct store_builder* builder) {
+    union store_page* page = &builder->data;
+    if (page->data.count == 0) return 1;
+    
+    unsigned int first_acct = (builder->names != NULL) ? page->encoded.records[0].acct_num
+                                                       : page->data.records[0].acct_num;
+    unsigned int written = store_write_page(builder, page);
+    if (written == 0) return 0;
+    if (!store_add_index_entry(builder, 1, first_acct, written)) return 0;
+    
+    memset(page, 0, sizeof(*page));
+    return 1;
+}
+
+/*
+ * STORE_FINISH
+ * 
+ * Purpose: Write the partly filled index pages bottom-up and the header
+ * Returns: 1 on success, 0 on a write error
+ * 
+ * Each level's last page is written and pushed into the level above,
+ * until a level consists of a single page: that page is the root.
+ */
+int store_finish(struct store_builder* builder) {
+    if (!store_flush_data_page(builder)) return 0;
+    
+    struct store_header* header = &builder->header;
+    for (int level = 1; level <= builder->level_count; level++) {
+        union store_page* page = &builder->levels[level - 1];
+        unsigned int written = store_write_page(builder, page);
+        if (written == 0) return 0;
+        
+        if (builder->pages_at_level[level - 1] == 0) {
+            header->root_page = written;
+            header->index_levels = level;
+            break;
+        }
+        if (!store_add_index_entry(builder, level + 1, page->index.entries[0].first_acct, written)) return 0;
+    }
+    
+    if (builder->names != NULL && !store_write_names(builder)) return 0;
+    header->page_count = builder->next_page;
+    
+    union store_page first;
+    memset(&first, 0, sizeof(first));
+    memcpy(first.bytes, header, sizeof(*header));
+    if (fseeko(builder->store_ptr, 0, SEEK_SET) != 0) return 0;
+    return (fwrite(&first, STORE_PAGE_SIZE, 1, builder->store_ptr) == 1);
+}
+
+/*
+ * STORE_WRITE_NAMES
+ * 
+ * Purpose: Append the name dictionary after the index, padded to whole pages
+ * Returns: 1 on success, 0 on a write error
+ */
+int store_write_names(struct store_builder* builder) {
+    const struct name_dictionary* names = builder->names;
+    struct store_header* header = &builder->header;
+    header->record_format = STORE_FORMAT_NAMES;
+    header->name_count = names->count;
+    header->names_page = builder->next_page;
+    header->names_size = names->text_size;
+    
+    size_t size = names->count * sizeof(unsigned int) + names->text_size;
+    size_t padding = (STORE_PAGE_SIZE - size % STORE_PAGE_SIZE) % STORE_PAGE_SIZE;
+    union store_page blank;
+    memset(&blank, 0, sizeof(blank));
+    
+    if (fwrite(names->offsets, sizeof(unsigned int), names->count, builder->store_ptr) != names->count ||
+        fwrite(names->text, 1, names->text_size, builder->store_ptr) != names->text_size ||
+        fwrite(&blank, 1, padding, builder->store_ptr) != padding) {
+        return 0;
+    }
+    builder->next_page += (size + padding) / STORE_PAGE_SIZE;
+    return 1;
+}
+
+/*
+ * BUILD_STORE_FILE
+ * 
+ * Purpose: Bulk-load an import file into a new store file
+ * Parameters:
+ *   - text_path: rows in the import format
+ *   - store_path: store file to create (replaced if it exists)
+ *   - threads: number of parser threads
+ *   - encode_names: 1 to build a dictionary-encoded store, 0 for plain records
+ *   - report_ptr: receives one line per rejected row (may be NULL)
+ *   - stats: receives stored/rejected counts and elapsed time (may be NULL)
+ * Returns: number of records stored, or -1 on error
+ * 
+ * As with import, the first row for an account wins; later rows for the
+ * same account are reported as duplicates.
+ */
+long build_store_file(const char* text_path, const char* store_path, int threads, int encode_names,
+                      FILE* report_ptr, struct batch_stats* stats) {
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    size_t size;
+    const char* text = map_text_file(text_path, &size);
+    if (text == NULL) {
+        printf("Error: Could not read import file '%s'\n", text_path);
+        return -1;
+    }
+    
+    // 1. Parse every row
+    struct store_row_list list;
+    memset(&list, 0, sizeof(list));
+    list.report_ptr = report_ptr;
+    struct batch_stats scan_stats;
+    memset(&scan_stats, 0, sizeof(scan_stats));
+    int ok = scan_import_text(text, size, threads, collect_store_row, &list, &scan_stats);
+    unmap_text_file(text, size);
+    
+    // 2. Sort (account, row) keys
+    unsigned long long* keys = ok ? malloc((list.count > 0 ? list.count : 1) * sizeof(unsigned long long)) : NULL;
+    ok = (keys != NULL);
+    for (long i = 0; ok && i < list.count; i++) {
+        keys[i] = ((unsigned long long)list.rows[i].client.acct_num << 32) | (unsigned long long)i;
+    }
+    ok = ok && sort_row_keys(keys, list.count);
+    
+    // 3. One pass: data pages and index levels
+    struct store_builder* builder = ok ? calloc(1, sizeof(struct store_builder)) : NULL;
+    struct name_dictionary names;
+    int have_names = builder != NULL && encode_names && name_dictionary_init(&names);
+    if (have_names) builder->names = &names;
+    ok = (builder != NULL) && (have_names || !encode_names) && (builder->store_ptr = fopen(store_path, "wb")) != NULL;
+    
+    long stored = 0;
+    if (ok) {
+        memcpy(builder->header.magic, STORE_MAGIC, sizeof(builder->header.magic));
+        builder->header.page_size = STORE_PAGE_SIZE;
+        builder->next_page = 1;
+        
+        // Reserve page 0 for the header, written last
+        union store_page blank;
+        memset(&blank, 0, sizeof(blank));
+        ok = (fwrite(&blank, STORE_PAGE_SIZE, 1, builder->store_ptr) == 1);
+        
+        unsigned int previous = 0;
+        for (long i = 0; ok && i < list.count; i++) {
+            const struct import_row* row = &list.rows[keys[i] & 0xFFFFFFFFu];
+            if (row->client.acct_num == previous) {
+                list.rejected++;
+                if (report_ptr) fprintf(report_ptr, "line %ld: duplicate account %u\n", row->line, previous);
+                continue;
+            }
+            previous = row->client.acct_num;
+            
+            if (have_names) {
+                if (builder->data.encoded.count == STORE_ENCODED_CAPACITY) ok = store_flush_data_page(builder);
+                ok = ok && encode_client(&names, &row->client,
+                                         &builder->data.encoded.records[builder->data.encoded.count++]);
+            } else {
+                if (builder->data.data.count == STORE_DATA_CAPACITY) ok = store_flush_data_page(builder);
+                builder->data.data.records[builder->data.data.count++] = row->client;
+            }
+            stored++;
+        }
+        
+        builder->header.record_count = stored;
+        ok = ok && store_finish(builder);
+        ok = (fclose(builder->store_ptr) == 0) && ok;
+    }
+    
+    if (have_names) name_dictionary_free(&names);
+    free(builder);
+    free(keys);
+    free(list.rows);
+    
+    if (!ok) {
+        printf("Error: Could not build store file '%s'\n", store_path);
+        return -1;
+    }
+    
+    if (stats != NULL) {
+        stats->records = stored;
+        stats->rejected = list.rejected;
+        stats->seconds = elapsed_seconds(&start);
+        stats->allocations = scan_stats.allocations;
+        stats->mallocs = scan_stats.mallocs;
+    }
+    return stored;
+}
+
+/*
+ * STORE_FILE_OPEN
+ * 
+ * Purpose: Map a store file read-only and check its header
+ * Returns: 1 on success, 0 if the file is missing or not a valid store
+ */
+int store_file_open(struct store_file* store, const char* store_path) {
+    memset(store, 0, sizeof(*store));
+    
+    int fd = open(store_path, O_RDONLY);
+    if (fd < 0) return 0;
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < STORE_PAGE_SIZE) {
+        close(fd);
+        return 0;
+    }
+    
+    void* base = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return 0;
+    
+    memcpy(&store->header, base, sizeof(store->header));
+    if (memcmp(store->header.magic, STORE_MAGIC, sizeof(store->header.magic)) != 0 ||
+        store->header.page_size != STORE_PAGE_SIZE ||
+        store->header.page_count * STORE_PAGE_SIZE != (unsigned long long)info.st_size) {
+        munmap(base, info.st_size);
+        return 0;
+    }
+    
+    store->pages = base;
+    store->size = info.st_size;
+    if (!store_file_load_names(store)) {
+        store_file_close(store);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * STORE_FILE_LOAD_NAMES
+ * 
+ * Purpose: Rebuild the name dictionary of a dictionary-encoded store
+ * Returns: 1 on success (or for a plain store), 0 if the dictionary is
+ * damaged or out of memory
+ * 
+ * Interning the names in file order gives every name its stored id
+ * back, so the records can be decoded and searched by id.
+ */
+int store_file_load_names(struct store_file* store) {
+    const struct store_header* header = &store->header;
+    if (header->record_format == STORE_FORMAT_PLAIN) return 1;
+    if (header->record_format != STORE_FORMAT_NAMES || header->names_page == 0 ||
+        header->names_page > header->page_count) {
+        return 0;
+    }
+    
+    unsigned long long available = (header->page_count - header->names_page) * STORE_PAGE_SIZE;
+    unsigned long long size = (unsigned long long)header->name_count * sizeof(unsigned int) + header->names_size;
+    if (size > available) return 0;
+    if (!name_dictionary_init(&store->names)) return 0;
+    if (header->name_count == 0) return 1;  // Empty store
+    
+    const unsigned int* offsets = (const unsigned int*)&store->pages[header->names_page];
+    const char* text = (const char*)(offsets + header->name_count);
+    if (header->names_size == 0 || text[header->names_size - 1] != '\0') return 0;
+    
+    for (unsigned int id = 0; id < header->name_count; id++) {
+        if (offsets[id] >= header->names_size || name_intern(&store->names, text + offsets[id]) != id) return 0;
+    }
+    return 1;
+}
+
+void store_file_close(struct store_file* store) {
+    if (store->pages != NULL) munmap((void*)store->pages, store->size);
+    store->pages = NULL;
+    name_dictionary_free(&store->names);
+}
+
+/*
+ * STORE_FILE_FIND
+ * 
+ * Purpose: Look up one account: binary search from the root index page
+ * down to a data page (index_levels + 1 page reads)
+ * Returns: 1 and fills 'client' if found, 0 otherwise
+ */
+int store_file_find(const struct store_file* store, unsigned int acct_num, struct client_data* client) {
+    if (store->pages == NULL || store->header.index_levels == 0) return 0;
+    
+    unsigned long long page_number = store->header.root_page;
+    for (unsigned int level = store->header.index_levels; level > 0; level--) {
+        const struct store_index_page* page = &store->pages[page_number].index;
+        
+        // Last entry whose first account is <= acct_num
+        int low = 0, high = (int)page->count - 1, found = -1;
+        while (low <= high) {
+            int middle = (low + high) / 2;
+            if (page->entries[middle].first_acct <= acct_num) {
+                found = middle;
+                low = middle + 1;
+            } else {
+                high = middle - 1;
+            }
+        }
+        if (found < 0) return 0;
+        page_number = page->entries[found].page;
+    }
+    
+    if (store->header.record_format == STORE_FORMAT_NAMES) {
+        const struct store_encoded_page* page = &store->pages[page_number].encoded;
+        int low = 0, high = (int)page->count - 1;
+        while (low <= high) {
+            int middle = (low + high) / 2;
+            if (page->records[middle].acct_num == acct_num) {
+                decode_client(&store->names, &page->records[middle], client);
+                return 1;
+            }
+            if (page->records[middle].acct_num < acct_num) {
+                low = middle + 1;
+            } else {
+                high = middle - 1;
+            }
+        }
+        return 0;
+    }
+    
+    const struct store_data_page* page = &store->pages[page_number].data;
+    int low = 0, high = (int)page->count - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (page->records[middle].acct_num == acct_num) {
+            *client = page->records[middle];
+            return 1;
+        }
+        if (page->records[middle].acct_num < acct_num) {
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * STORE_FILE_FIND_LAST_NAME
+ * 
+ * Purpose: Find every account with a given last name (a full scan of the data pages)
+ * Parameters: matches - receives up to max_matches records in account order (may be NULL)
+ * Returns: the number of matching accounts
+ * 
+ * In a dictionary-encoded store the name is looked up once and each
+ * record costs one integer comparison; a name that is not in the
+ * dictionary matches nothing without reading a data page.
+ */
+long store_file_find_last_name(const struct store_file* store, const char* last_name,
+                               struct client_data* matches, long max_matches) {
+    int encoded = (store->header.record_format == STORE_FORMAT_NAMES);
+    unsigned int id = encoded ? name_find(&store->names, last_name) : NAME_ID_NONE;
+    if (store->pages == NULL || (encoded && id == NAME_ID_NONE)) return 0;
+    
+    // Data and index pages come before the dictionary; only data pages have level 0
+    unsigned long long end = encoded ? store->header.names_page : store->header.page_count;
+    long found = 0;
+    for (unsigned long long n = 1; n < end; n++) {
+        const union store_page* page = &store->pages[n];
+        if (page->data.level != 0) continue;
+        
+        for (unsigned int i = 0; i < page->data.count; i++) {
+            if (encoded ? page->encoded.records[i].last_name != id
+                        : strcmp(page->data.records[i].last_name, last_name) != 0) {
+                continue;
+            }
+            if (found < max_matches && matches != NULL) {
+                if (encoded) {
+                    decode_client(&store->names, &page->encoded.records[i], &matches[found]);
+                } else {
+                    matches[found] = page->data.records[i];
+                }
+            }
+            found++;
+        }
+    }
+    return found;
+}
+
+/*
+ * STORE_FILE_GROUP_LAST_NAMES
+ * 
+ * Purpose: Count the accounts per last name
+ * Parameters: groups - an empty dictionary; receives every last name in
+ * order of first appearance (by account number)
+ * Returns: malloc'd counts indexed by the ids in 'groups' (caller frees),
+ * or NULL if out of memory
+ * 
+ * A plain store has to hash every record's name. A dictionary-encoded
+ * store counts by id in a flat array, then interns just the distinct
+ * names into 'groups'.
+ */
+long* store_file_group_last_names(const struct store_file* store, struct name_dictionary* groups) {
+    int encoded = (store->header.record_format == STORE_FORMAT_NAMES);
+    unsigned long long end = encoded ? store->header.names_page : store->header.page_count;
+    size_t capacity = encoded ? store->names.count : 1024;
+    long* counts = calloc(capacity > 0 ? capacity : 1, sizeof(long));
+    unsigned int* first_seen = encoded ? malloc((capacity > 0 ? capacity : 1) * sizeof(unsigned int)) : NULL;
+    if (counts == NULL || (encoded && first_seen == NULL)) {
+        free(counts);
+        free(first_seen);
+        return NULL;
+    }
+    
+    unsigned int distinct = 0;
+    for (unsigned long long n = 1; store->pages != NULL && n < end; n++) {
+        const union store_page* page = &store->pages[n];
+        if (page->data.level != 0) continue;
+        
+        if (encoded) {
+            for (unsigned int i = 0; i < page->encoded.count; i++) {
+                unsigned int id = page->encoded.records[i].last_name;
+                if (id >= capacity) continue;  // Damaged record
+                if (counts[id]++ == 0) first_seen[distinct++] = id;
+            }
+            continue;
+        }
+        
+        for (unsigned int i = 0; i < page->data.count; i++) {
+            unsigned int id = name_intern(groups, page->data.records[i].last_name);
+            if (id == NAME_ID_NONE) {
+                free(counts);
+                return NULL;
+            }
+            if (id == capacity) {
+                long* grown = realloc(counts, capacity * 2 * sizeof(long));
+                if (grown == NULL) {
+                    free(counts);
+                    return NULL;
+                }
+                memset(grown + capacity, 0, capacity * sizeof(long));
+                counts = grown;
+                capacity *= 2;
+            }
+            counts[id]++;
+        }
+    }
+    if (!encoded) return counts;
+    
+    // Renumber the names in use, in order of first appearance
+    long* grouped = malloc((distinct > 0 ? distinct : 1) * sizeof(long));
+    for (unsigned int i = 0; grouped != NULL && i < distinct; i++) {
+        if (name_intern(groups, name_text(&store->names, first_seen[i])) != i) {
+            free(grouped);
+            grouped = NULL;
+            break;
+        }
+        grouped[i] = counts[first_seen[i]];
+    }
+    free(counts);
+    free(first_seen);
+    return grouped;
+}
+
+/*
+ * SCRIPTED COMMANDS
+ * 
+ * The interactive CRUD functions prompt for every field, so driving
+ * them from another program means faking keystrokes. Scripted mode
+ * takes whole commands instead, one per line:
+ * 
+ *   create <acct> <last> <first> [balance]
+ *   read <acct>
+ *   update <acct> <+/-amount>
+ *   delete <acct>
+ *   transfer <from> <to> <amount>
+ *   list
+ * 
+ * Each command answers with one line that is easy to parse:
+ * 
+ *   OK <acct> <last> <first> <balance>     (transfer: both accounts)
+ *   ERR <CODE> <description>
+ * 
+ * "list" prints one "<acct> <last> <first> <balance>" row per account
+ * followed by "OK <count>". Blank lines and lines starting with '#'
+ * produce no output.
+ * 
+ * A command goes through parse -> validate -> apply -> log, where the
+ * log step appends balance changes to the history and prints the answer.
+ * The data and history files stay open for the whole script and the
+ * output is fully buffered, so a script runs without a prompt, a
+ * file open or a terminal flush per command.
+ */
+
+/*
+ * BALANCE_TO_CENTS
+ * 
+ * Purpose: Round a stored balance to whole cents so amounts can be
+ * added exactly
+ */
+long long balance_to_cents(double balance) {
+    return (long long)(balance * 100.0 + (balance < 0 ? -0.5 : 0.5));
+}
+
+/*
+ * COMMAND_TYPE
+ * 
+ * Purpose: Look up a command word
+ * Returns: COMMAND_CREATE ... COMMAND_LIST, or 0 if unknown
+ */
+int command_type(const char* word, size_t len) {
+    static const struct {
+        const char* word;
+        int type;
+    } commands[] = {
+        {"create", COMMAND_CREATE},
+        {"read", COMMAND_READ},
+        {"update", COMMAND_UPDATE},
+        {"delete", COMMAND_DELETE},
+        {"transfer", COMMAND_TRANSFER},
+        {"list", COMMAND_LIST}
+    };
+    
+    for (size_t i = 0; i < sizeof(commands) / sizeof(commands[0]); i++) {
+        if (strlen(commands[i].word) == len && memcmp(commands[i].word, word, len) == 0) {
+            return commands[i].type;
+        }
+    }
+    return 0;
+}
+
+/*
+ * PARSE_COMMAND_ACCOUNT / PARSE_COMMAND_AMOUNT / PARSE_COMMAND_NAME
+ * 
+ * Purpose: Convert one token of a command, describing any error in 'result'
+ * Returns: COMMAND_OK or the error code
+ */
+int parse_command_account(const char* token, size_t len, unsigned int* acct_num,
+                          struct command_result* result) {
+    unsigned long value = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!isdigit((unsigned char)token[i]) || i >= 9) {
+            snprintf(result->detail, sizeof(result->detail), "invalid account number '%.*s'", (int)len, token);
+            return COMMAND_BAD_ACCOUNT;
+        }
+        value = value * 10 + (token[i] - '0');
+    }
+    
+    *acct_num = (unsigned int)value;
+    return COMMAND_OK;
+}
+
+int parse_command_amount(const char* token, size_t len, long long* cents,
+                         struct command_result* result) {
+    size_t error_position;
+    int status = parse_amount_cents(token, len, cents, &error_position);
+    if (status != AMOUNT_OK) {
+        snprintf(result->detail, sizeof(result->detail), "%s at character %zu of '%.*s'",
+                 amount_error_message(status), error_position + 1, (int)len, token);
+        return COMMAND_BAD_AMOUNT;
+    }
+    return COMMAND_OK;
+}
+
+int parse_command_name(const char* token, size_t len, char* name, size_t size,
+                       struct command_result* result) {
+    if (len >= size) {
+        snprintf(result->detail, sizeof(result->detail), "name '%.*s' longer than %zu characters",
+                 (int)len, token, size - 1);
+        return COMMAND_BAD_NAME;
+    }
+    
+    memcpy(name, token, len);
+    name[len] = '\0';
+    return COMMAND_OK;
+}
+
+/*
+ * PARSE_COMMAND
+ * 
+ * Purpose: Split a command line into its fields
+ * Parameters:
+ *   - line/len: one command, without the newline
+ *   - command: receives the fields
+ *   - result: receives the error description
+ * Returns: COMMAND_OK or an error code
+ * 
+ * Only the syntax is checked here; ranges and existence are left to
+ * validate_command and apply_command.
+ */
+int parse_command(const char* line, size_t len, struct command* command, struct command_result* result) {
+    const char* tokens[MAX_COMMAND_TOKENS + 1];
+    size_t lengths[MAX_COMMAND_TOKENS + 1];
+    int count = 0;
+    
+    memset(command, 0, sizeof(*command));
+    result->detail[0] = '\0';
+    
+    // Split on blanks; one token more than any command takes shows extra arguments
+    for (size_t i = 0; i < len && count <= MAX_COMMAND_TOKENS; ) {
+        while (i < len && isspace((unsigned char)line[i])) i++;
+        if (i == len) break;
+        
+        size_t start = i;
+        while (i < len && !isspace((unsigned char)line[i])) i++;
+        tokens[count] = line + start;
+        lengths[count] = i - start;
+        count++;
+    }
+    
+    if (count == 0) {
+        snprintf(result->detail, sizeof(result->detail), "empty command");
+        return COMMAND_BAD_SYNTAX;
+    }
+    
+    command->type = command_type(tokens[0], lengths[0]);
+    
+    int min_args, max_args;
+    switch (command->type) {
+        case COMMAND_CREATE:   min_args = 3; max_args = 4; break;
+        case COMMAND_READ:     min_args = 1; max_args = 1; break;
+        case COMMAND_UPDATE:   min_args = 2; max_args = 2; break;
+        case COMMAND_DELETE:   min_args = 1; max_args = 1; break;
+        case COMMAND_TRANSFER: min_args = 3; max_args = 3; break;
+        case COMMAND_LIST:     min_args = 0; max_args = 0; break;
+        default:
+            snprintf(result->detail, sizeof(result->detail), "unknown command '%.*s'",
+                     (int)lengths[0], tokens[0]);
+            return COMMAND_BAD_SYNTAX;
+    }
+    
+    int args = count - 1;
+    if (args < min_args || args > max_args) {
+        snprintf(result->detail, sizeof(result->detail), "'%.*s' takes %d to %d arguments",
+                 (int)lengths[0], tokens[0], min_args, max_args);
+        return COMMAND_BAD_SYNTAX;
+    }
+    
+    int status = COMMAND_OK;
+    if (args > 0) {
+        status = parse_command_account(tokens[1], lengths[1], &command->acct_num, result);
+    }
+    
+    switch (command->type) {
+        case COMMAND_CREATE:
+            if (status == COMMAND_OK) {
+                status = parse_command_name(tokens[2], lengths[2], command->last_name,
+                                            sizeof(command->last_name), result);
+            }
+            if (status == COMMAND_OK) {
+                status = parse_command_name(tokens[3], lengths[3], command->first_name,
+                                            sizeof(command->first_name), result);
+            }
+            if (status == COMMAND_OK && args == 4) {
+                status = parse_command_amount(tokens[4], lengths[4], &command->cents, result);
+            }
+            break;
+        case COMMAND_UPDATE:
+            if (status == COMMAND_OK) {
+                status = parse_command_amount(tokens[2], lengths[2], &command->cents, result);
+            }
+            break;
+        case COMMAND_TRANSFER:
+            if (status == COMMAND_OK) {
+                status = parse_command_account(tokens[2], lengths[2], &command->target_acct, result);
+            }
+            if (status == COMMAND_OK) {
+                status = parse_command_amount(tokens[3], lengths[3], &command->cents, result);
+            }
+            break;
+    }
+    
+    return status;
+}
+
+/*
+ * VALIDATE_COMMAND
+ * 
+ * Purpose: Apply the interactive input rules to a parsed command
+ * Returns: COMMAND_OK or an error code (described in 'result')
+ */
+int validate_command(const struct command* command, struct command_result* result) {
+    if (command->type == COMMAND_LIST) return COMMAND_OK;
+    
+    if (!validate_account_number(command->acct_num)) {
+        snprintf(result->detail, sizeof(result->detail), "account %u is outside %d-%d",
+                 command->acct_num, MIN_ACCOUNT_NUM, MAX_ACCOUNT_NUM);
+        return COMMAND_BAD_ACCOUNT;
+    }
+    
+    if (command->type == COMMAND_CREATE &&
+        (!validate_name(command->last_name) || !validate_name(command->first_name))) {
+        snprintf(result->detail, sizeof(result->detail), "invalid name '%s %s'",
+                 command->last_name, command->first_name);
+        return COMMAND_BAD_NAME;
+    }
+    
+    if (command->type == COMMAND_TRANSFER) {
+        if (!validate_account_number(command->target_acct)) {
+            snprintf(result->detail, sizeof(result->detail), "account %u is outside %d-%d",
+                     command->target_acct, MIN_ACCOUNT_NUM, MAX_ACCOUNT_NUM);
+            return COMMAND_BAD_ACCOUNT;
+        }
+        if (command->target_acct == command->acct_num) {
+            snprintf(result->detail, sizeof(result->detail), "cannot transfer to the same account");
+            return COMMAND_BAD_ACCOUNT;
+        }
+        if (command->cents <= 0) {
+            snprintf(result->detail, sizeof(result->detail), "transfer amount must be positive");
+            return COMMAND_BAD_AMOUNT;
+        }
+    }
+    
+    return COMMAND_OK;
+}
+
+/*
+ * READ_COMMAND_ACCOUNT
+ * 
+ * Purpose: Read an account a command needs, describing a failure in 'result'
+ * Returns: COMMAND_OK, COMMAND_NOT_FOUND or COMMAND_IO_ERROR
+ */
+int read_command_account(struct command_session* session, unsigned int acct_num,
+                         struct client_data* client, struct command_result* result) {
+    account_table_read(session->table, acct_num - 1, client);
+    if (client->acct_num == 0) {
+        snprintf(result->detail, sizeof(result->detail), "account %u not found", acct_num);
+        return COMMAND_NOT_FOUND;
+    }
+    return COMMAND_OK;
+}
+
+/*
+ * APPLY_COMMAND
+ * 
+ * Purpose: Carry out a validated command against the session's files
+ * Returns: COMMAND_OK or an error code (described in 'result')
+ * 
+ * Balance changes are done in whole cents. Nothing is printed or
+ * logged here (see log_command); "list" collects its rows in
+ * result->listing, allocated from result->arena unless the caller
+ * supplied a buffer there.
+ * 
+ * Records are written with a compare-on-write, so a teller or another
+ * script changing the same account between our read and our write is
+ * noticed; the command is then simply run again on the new contents,
+ * up to UPDATE_RETRY_LIMIT times, after the records involved have been
+ * reloaded into the session's account table.
+ * 
+ * Frozen and closed accounts are turned away first, from the status
+ * bitmap, before any record is read, and so are debits beyond the
+ * velocity limits. Every outcome, refusals included, goes to the audit
+ * trail if the session has one, and an account left below zero goes
+ * into the overdrawn index.
+ */
+int apply_command(struct command_session* session, const struct command* command, struct command_result* result) {
+    int status = apply_command_retrying(session, command, result);
+    if (status == COMMAND_OK && (command->type == COMMAND_CREATE || command->type == COMMAND_UPDATE ||
+                                 command->type == COMMAND_TRANSFER)) {
+        account_flags_note_balance(session->flags, command->acct_num, result->client.balance);
+    }
+    if (status == COMMAND_OK && session->velocity != NULL && command_debit_cents(command) > 0) {
+        velocity_record(session->velocity, command->acct_num, command_debit_cents(command), velocity_now());
+    }
+    if (session->audit != NULL) audit_record(session->audit, command, status);
+    return status;
+}
+
+int apply_command_retrying(struct command_session* session, const struct command* command,
+                           struct command_result* result) {
+    int refusal = account_flags_refusal(session->flags, command->type, command->acct_num, command->target_acct,
+                                        result->detail, sizeof(result->detail));
+    if (refusal == COMMAND_OK && session->velocity != NULL && command_debit_cents(command) > 0) {
+        refusal = velocity_check(session->velocity, command->acct_num, 1, command_debit_cents(command),
+                                 velocity_now(), result->detail, sizeof(result->detail));
+    }
+    if (refusal != COMMAND_OK) return refusal;
+    
+    for (int attempt = 0; attempt <= UPDATE_RETRY_LIMIT; attempt++) {
+        int status = apply_command_once(session, command, result);
+        if (status != COMMAND_CONFLICT) return status;
+        
+        int refreshed = account_table_refresh(session->table, session->data_ptr, command->acct_num - 1);
+        if (refreshed && command->type == COMMAND_TRANSFER) {
+            refreshed = account_table_refresh(session->table, session->data_ptr, command->target_acct - 1);
+        }
+        if (!refreshed) {
+            snprintf(result->detail, sizeof(result->detail), "could not read account %u", command->acct_num);
+            return COMMAND_IO_ERROR;
+        }
+    }
+    
+    snprintf(result->detail, sizeof(result->detail), "account %u kept changing, gave up after %d retries",
+             command->acct_num, UPDATE_RETRY_LIMIT);
+    return COMMAND_CONFLICT;
+}
+
+/*
+ * COMMAND_WRITE_STATUS
+ * 
+ * Purpose: Turn an UPDATE_* result into a COMMAND_* status
+ */
+int command_write_status(int update_status, unsigned int acct_num, struct command_result* result) {
+    if (update_status == UPDATE_OK) return COMMAND_OK;
+    if (update_status == UPDATE_CONFLICT) return COMMAND_CONFLICT;
+    
+    snprintf(result->detail, sizeof(result->detail), "could not write account %u", acct_num);
+    return COMMAND_IO_ERROR;
+}
+
+/*
+ * APPLY_COMMAND_ONCE
+ * 
+ * Purpose: One attempt of apply_command
+ * Returns: as apply_command, or COMMAND_CONFLICT if a record changed
+ * between reading and writing it (nothing was written)
+ */
+int apply_command_once(struct command_session* session, const struct command* command, struct command_result* result) {
+    struct client_data* client = &result->client;
+    struct client_data expected;
+    int position = command->acct_num - 1;
+    int status;
+    
+    switch (command->type) {
+        case COMMAND_CREATE: {
+            account_table_read(session->table, position, client);
+            if (client->acct_num != 0) {
+                snprintf(result->detail, sizeof(result->detail), "account %u already exists", command->acct_num);
+                return COMMAND_EXISTS;
+            }
+            
+            expected = *client;
+            initialize_client(client, command->acct_num, command->last_name, command->first_name,
+                              command->cents / 100.0);
+            break;
+        }
+        case COMMAND_READ:
+            return read_command_account(session, command->acct_num, client, result);
+        case COMMAND_UPDATE: {
+            status = read_command_account(session, command->acct_num, client, result);
+            if (status != COMMAND_OK) return status;
+            
+            expected = *client;
+            long long cents = balance_to_cents(client->balance) + command->cents;
+            if (command->cents < 0 && cents < 0 && !account_flag(session->flags, command->acct_num, ACCOUNT_OVERDRAFT)) {
+                snprintf(result->detail, sizeof(result->detail), "account %u may not be overdrawn", command->acct_num);
+                return COMMAND_NO_OVERDRAFT;
+            }
+            client->balance = cents / 100.0;
+            break;
+        }
+        case COMMAND_DELETE: {
+            status = read_command_account(session, command->acct_num, client, result);
+            if (status != COMMAND_OK) return status;
+            
+            struct client_data empty_client = CLIENT_RECORD(0, "", "", 0.0);
+            int written = write_clients_upgrading(session->data_ptr, session->extension_ptr,
+                                                  &empty_client, client, &position, 1);
+            status = command_write_status(written, command->acct_num, result);
+            if (status == COMMAND_OK) account_table_publish(session->table, &empty_client, &position, 1, 0);
+            return status;
+        }
+        case COMMAND_TRANSFER: {
+            status = read_command_account(session, command->acct_num, client, result);
+            if (status == COMMAND_OK) {
+                status = read_command_account(session, command->target_acct, &result->target, result);
+            }
+            if (status != COMMAND_OK) return status;
+            
+            // Both records are checked and written under one lock, so money never half-moves
+            struct client_data pair_expected[2] = {*client, result->target};
+            struct client_data pair[2] = {*client, result->target};
+            int positions[2] = {position, (int)command->target_acct - 1};
+            long long cents = balance_to_cents(client->balance) - command->cents;
+            if (command->cents > 0 && cents < 0 && !account_flag(session->flags, command->acct_num, ACCOUNT_OVERDRAFT)) {
+                snprintf(result->detail, sizeof(result->detail), "account %u may not be overdrawn", command->acct_num);
+                return COMMAND_NO_OVERDRAFT;
+            }
+            pair[0].balance = cents / 100.0;
+            pair[1].balance = (balance_to_cents(result->target.balance) + command->cents) / 100.0;
+            
+            int written = write_clients_upgrading(session->data_ptr, session->extension_ptr,
+                                                  pair, pair_expected, positions, 2);
+            status = command_write_status(written, command->acct_num, result);
+            if (status == COMMAND_OK) {
+                account_table_publish(session->table, pair, positions, 2, 0);
+                *client = pair[0];
+                result->target = pair[1];
+            }
+            return status;
+        }
+        case COMMAND_LIST: {
+            // A caller may supply the buffer (LISTING_SIZE bytes)
+            size_t capacity = LISTING_SIZE;
+            char* listing = (result->listing != NULL) ? result->listing : arena_alloc(result->arena, capacity);
+            if (listing == NULL) {
+                snprintf(result->detail, sizeof(result->detail), "out of memory");
+                return COMMAND_IO_ERROR;
+            }
+            
+            size_t length = 0;
+            long listed = 0;
+            listing[0] = '\0';
+            for (int i = 0; i < MAX_ACCOUNTS; i++) {
+                account_table_read(session->table, i, client);
+                if (client->acct_num != 0) {
+                    int written = snprintf(listing + length, capacity - length, "%u %s %s %.2f\n", client->acct_num,
+                                           client->last_name, client->first_name, client->balance);
+                    if (written > 0) length += ((size_t)written < capacity - length) ? (size_t)written : capacity - length - 1;
+                    listed++;
+                }
+            }
+            result->listing = listing;
+            client->acct_num = (unsigned int)listed;  // Reported as "OK <count>"
+            return COMMAND_OK;
+        }
+        default:
+            return COMMAND_BAD_SYNTAX;
+    }
+    
+    int written = write_clients_upgrading(session->data_ptr, session->extension_ptr, client, &expected, &position, 1);
+    status = command_write_status(written, command->acct_num, result);
+    if (status == COMMAND_OK) account_table_publish(session->table, client, &position, 1, 0);
+    return status;
+}
+
+/*
+ * LOG_COMMAND
+ * 
+ * Purpose: Record a finished command: history entries for balance
+ * changes, then the answer line
+ */
+void log_command(struct command_session* session, const struct command* command, struct command_result* result) {
+    log_command_history(session, command, result);
+    write_command_result(session->output_ptr, command, result);
+    result->listing = NULL;  // Freed with the arena
+    
+    session->executed++;
+    if (result->status != COMMAND_OK) session->failed++;
+}
+
+/*
+ * LOG_COMMAND_HISTORY
+ * 
+ * Purpose: The history entries of a finished command (none unless it
+ * changed a balance)
+ */
+void log_command_history(struct command_session* session, const struct command* command,
+                         const struct command_result* result) {
+    if (result->status == COMMAND_OK && command->type == COMMAND_UPDATE) {
+        append_transaction(session->history_ptr, command->acct_num, command->cents / 100.0,
+                           result->client.balance);
+    } else if (result->status == COMMAND_OK && command->type == COMMAND_TRANSFER) {
+        append_transaction(session->history_ptr, command->acct_num, -command->cents / 100.0,
+                           result->client.balance);
+        append_transaction(session->history_ptr, command->target_acct, command->cents / 100.0,
+                           result->target.balance);
+    }
+}
+
+/*
+ * COMMAND_STATUS_NAME
+ * 
+ * Purpose: Machine-readable name of a COMMAND_* code
+ */
+const char* command_status_name(int status) {
+    switch (status) {
+        case COMMAND_OK:          return "OK";
+        case COMMAND_BAD_SYNTAX:  return "BAD_SYNTAX";
+        case COMMAND_BAD_ACCOUNT: return "BAD_ACCOUNT";
+        case COMMAND_BAD_NAME:    return "BAD_NAME";
+        case COMMAND_BAD_AMOUNT:  return "BAD_AMOUNT";
+        case COMMAND_NOT_FOUND:   return "NOT_FOUND";
+        case COMMAND_EXISTS:      return "EXISTS";
+        case COMMAND_CONFLICT:    return "CONFLICT";
+        case COMMAND_FROZEN:      return "FROZEN";
+        case COMMAND_CLOSED:      return "CLOSED";
+        case COMMAND_NO_OVERDRAFT: return "NO_OVERDRAFT";
+        case COMMAND_VELOCITY:    return "VELOCITY";
+        default:                  return "IO_ERROR";
+    }
+}
+
+const char* command_name(int type) {
+    switch (type) {
+        case COMMAND_CREATE:   return "create";
+        case COMMAND_READ:     return "read";
+        case COMMAND_UPDATE:   return "update";
+        case COMMAND_DELETE:   return "delete";
+        case COMMAND_TRANSFER: return "transfer";
+        case COMMAND_LIST:     return "list";
+        default:               return "unknown";
+    }
+}
+
+/*
+ * WRITE_COMMAND_RESULT
+ * 
+ * Purpose: Print the one-line answer to a command
+ */
+void write_command_result(FILE* output_ptr, const struct command* command, const struct command_result* result) {
+    const struct client_data* client = &result->client;
+    
+    if (result->status != COMMAND_OK) {
+        fprintf(output_ptr, "ERR %s %s\n", command_status_name(result->status), result->detail);
+    } else if (command->type == COMMAND_LIST) {
+        if (result->listing != NULL) fputs(result->listing, output_ptr);
+        fprintf(output_ptr, "OK %u\n", client->acct_num);
+    } else if (command->type == COMMAND_DELETE) {
+        fprintf(output_ptr, "OK %u deleted\n", command->acct_num);
+    } else if (command->type == COMMAND_TRANSFER) {
+        fprintf(output_ptr, "OK %u %s %s %.2f %u %s %s %.2f\n",
+                client->acct_num, client->last_name, client->first_name, client->balance,
+                result->target.acct_num, result->target.last_name, result->target.first_name,
+                result->target.balance);
+    } else {
+        fprintf(output_ptr, "OK %u %s %s %.2f\n",
+                client->acct_num, client->last_name, client->first_name, client->balance);
+    }
+}
+
+/*
+ * COMMAND_SESSION_OPEN / COMMAND_SESSION_CLOSE
+ * 
+ * Purpose: Open the data and history files for a run of commands and
+ * load the session's account table
+ * Returns: 1 on success, 0 if the files could not be opened or loaded
+ */
+int command_session_open(struct command_session* session, const char* data_path,
+                         const char* history_path, FILE* output_ptr) {
+    memset(session, 0, sizeof(*session));
+    session->output_ptr = output_ptr;
+    
+    session->data_ptr = fopen(data_path, "rb+");
+    if (session->data_ptr == NULL) {
+        fprintf(output_ptr, "ERR IO_ERROR could not open data file '%s'\n", data_path);
+        return 0;
+    }
+    
+    session->history_ptr = fopen(history_path, "ab");
+    if (session->history_ptr == NULL) {
+        fprintf(output_ptr, "ERR IO_ERROR could not open history file '%s'\n", history_path);
+        fclose(session->data_ptr);
+        return 0;
+    }
+    
+    session->table = account_table_load(session->data_ptr);
+    if (session->table == NULL) {
+        fprintf(output_ptr, "ERR IO_ERROR could not load data file '%s'\n", data_path);
+        fclose(session->history_ptr);
+        fclose(session->data_ptr);
+        return 0;
+    }
+    session->owns_table = 1;
+    session->extension_ptr = open_extension_file(data_path, 0);
+    session->flags = account_flags_open(data_path, 0);
+    session->velocity = velocity_tracker_open(data_path);
+    arena_init(&session->arena, ARENA_BLOCK_SIZE);
+    return 1;
+}
+
+void command_session_close(struct command_session* session) {
+    arena_release(&session->arena);
+    if (session->owns_table) free(session->table);
+    if (session->view != NULL) shared_view_close(session->view);
+    if (session->flags != NULL) account_flags_close(session->flags);
+    if (session->velocity != NULL) velocity_tracker_close(session->velocity);
+    if (session->audit != NULL) audit_ring_detach(session->audit);
+    if (session->extension_ptr != NULL) fclose(session->extension_ptr);
+    fclose(session->history_ptr);
+    fclose(session->data_ptr);
+    fflush(session->output_ptr);
+}
+
+/*
+ * COMMAND_SESSION_AUDIT
+ * 
+ * Purpose: Record the session's commands in an audit log (see AUDIT
+ * TRAIL); the session must then be used by one thread at a time
+ * 
+ * The session must be closed before the log.
+ */
+void command_session_audit(struct command_session* session, struct audit_log* log) {
+    if (session->audit == NULL && log != NULL) session->audit = audit_ring_attach(log);
+}
+
+/*
+ * COMMAND_SESSION_SHARE_TABLE
+ * 
+ * Purpose: Make a session read from (and publish to) a table shared
+ * with other sessions on the same data file, instead of its own
+ * 
+ * The caller keeps ownership of 'table' and must keep it until every
+ * session using it is closed.
+ */
+void command_session_share_table(struct command_session* session, struct account_table* table) {
+    if (session->owns_table) free(session->table);
+    session->table = table;
+    session->owns_table = 0;
+}
+
+/*
+ * COMMAND_SESSION_PUBLISH_VIEW
+ * 
+ * Purpose: Make a session read from and publish to the data file's
+ * shared-memory view, so other processes see its writes
+ * Returns: 1 on success, 0 if the view could not be opened (the session
+ * then keeps its own table)
+ */
+int command_session_publish_view(struct command_session* session, const char* data_path) {
+    struct shared_view* view = shared_view_open(data_path, session->data_ptr);
+    if (view == NULL) return 0;
+    
+    command_session_share_table(session, &view->table);
+    session->view = view;
+    return 1;
+}
+
+/*
+ * EXECUTE_COMMAND_LINE
+ * 
+ * Purpose: Run one command line and print its answer
+ * Returns: the command's COMMAND_* status (COMMAND_OK for blank and comment lines)
+ */
+int execute_command_line(struct command_session* session, const char* line, size_t len) {
+    size_t start = 0;
+    while (start < len && isspace((unsigned char)line[start])) start++;
+    if (start == len || line[start] == '#') return COMMAND_OK;
+    
+    struct command command;
+    struct command_result result;
+    memset(&result, 0, sizeof(result));
+    result.arena = &session->arena;
+    
+    result.status = parse_command(line + start, len - start, &command, &result);
+    if (result.status == COMMAND_OK) result.status = validate_command(&command, &result);
+    if (result.status == COMMAND_OK) result.status = apply_command(session, &command, &result);
+    log_command(session, &command, &result);
+    arena_reset(&session->arena);
+    return result.status;
+}
+
+/*
+ * READ_COMMAND_LINE
+ * 
+ * Purpose: Read the next script line without its newline
+ * Returns: 1 for a line, 0 at end of file, -1 for a line too long for
+ * 'line' (the rest of it is skipped)
+ */
+int read_command_line(FILE* script_ptr, char* line, size_t size, size_t* len) {
+    if (fgets(line, size, script_ptr) == NULL) return 0;
+    
+    *len = strlen(line);
+    if (*len > 0 && line[*len - 1] == '\n') {
+        (*len)--;
+    } else if (!feof(script_ptr)) {
+        int c;
+        while ((c = fgetc(script_ptr)) != '\n' && c != EOF);
+        return -1;
+    }
+    return 1;
+}
+
+/*
+ * RUN_COMMAND_SCRIPT
+ * 
+ * Purpose: Execute every command in a script
+ * Parameters:
+ *   - script_ptr: one command per line
+ *   - data_path/history_path: files the commands work on
+ *   - output_ptr: receives one answer line per command
+ *   - audit: log recording every command, or NULL
+ * Returns: number of failed commands, or -1 if the files could not be opened
+ */
+long run_command_script(FILE* script_ptr, const char* data_path, const char* history_path,
+                        FILE* output_ptr, int publish_view, struct audit_log* audit) {
+    struct command_session session;
+    if (!command_session_open(&session, data_path, history_path, output_ptr)) return -1;
+    if (publish_view) command_session_publish_view(&session, data_path);  // Best effort
+    command_session_audit(&session, audit);
+    
+    char line[MAX_COMMAND_LINE];
+    size_t len;
+    int status;
+    while ((status = read_command_line(script_ptr, line, sizeof(line), &len)) != 0) {
+        if (status < 0) {
+            fprintf(output_ptr, "ERR BAD_SYNTAX line longer than %d characters\n", MAX_COMMAND_LINE - 2);
+            session.executed++;
+            session.failed++;
+            continue;
+        }
+        
+        execute_command_line(&session, line, len);
+    }
+    
+    long failed = session.failed;
+    command_session_close(&session);
+    return failed;
+}
+
+/*
+ * BATCH JOB: INGEST PIPELINE
+ * 
+ * Runs a command script with each step of execute_command_line on
+ * its own thread:
+ * 
+ *   parse -> validate -> apply -> log
+ * 
+ * Parsing and validation are pure CPU work, applying owns the data
+ * file and logging owns the history file and the output, so one
+ * command can be parsed while the previous ones are being validated,
+ * written and logged. The answers are identical to "exec", in the
+ * same order.
+ * 
+ * Stages are connected by lock-free SPSC rings; a fourth ring returns
+ * finished items from the log stage to the parser, so a fixed set of
+ * INGEST_ITEMS is reused and nothing is allocated per command. A full
+ * ring stops its producer (backpressure) and each stage counts how
+ * often it had to wait on either side.
+ */
+
+/*
+ * SPSC RING
+ * 
+ * The producer publishes a slot by advancing 'tail' with release
+ * order after filling it; the consumer frees it by advancing 'head'.
+ * Acquire loads of the other side's index make the slot contents
+ * visible, so no lock is needed with exactly one thread on each end.
+ */
+int spsc_ring_init(struct spsc_ring* ring, size_t capacity) {
+    ring->slots = malloc(capacity * sizeof(void*));
+    ring->mask = capacity - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return (ring->slots != NULL);
+}
+
+void spsc_ring_destroy(struct spsc_ring* ring) {
+    free(ring->slots);
+}
+
+int spsc_ring_try_push(struct spsc_ring* ring, void* item) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) return 0;  // Full
+    
+    ring->slots[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+int spsc_ring_try_pop(struct spsc_ring* ring, void** item) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) return 0;  // Empty
+    
+    *item = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return 1;
+}
+
+/*
+ * RING_BACKOFF
+ * 
+ * Purpose: Wait a little before retrying a full or empty ring
+ * Spins briefly (the other side is usually about to catch up), then
+ * yields so a waiting stage does not starve the one it waits for.
+ */
+void ring_backoff(unsigned int* attempts) {
+    if (++(*attempts) < RING_SPIN_LIMIT) {
+#ifdef __SSE2__
+        _mm_pause();
+#endif
+    } else {
+        sched_yield();
+    }
+}
+
+/*
+ * SPSC_RING_PUSH / SPSC_RING_POP
+ * 
+ * Purpose: Blocking versions of try_push/try_pop that count waits
+ */
+void spsc_ring_push(struct spsc_ring* ring, void* item, struct stage_stats* stats) {
+    unsigned int attempts = 0;
+    if (spsc_ring_try_push(ring, item)) return;
+    
+    stats->full_waits++;
+    while (!spsc_ring_try_push(ring, item)) ring_backoff(&attempts);
+}
+
+void* spsc_ring_pop(struct spsc_ring* ring, struct stage_stats* stats) {
+    unsigned int attempts = 0;
+    void* item;
+    if (spsc_ring_try_pop(ring, &item)) return item;
+    
+    stats->empty_waits++;
+    while (!spsc_ring_try_pop(ring, &item)) ring_backoff(&attempts);
+    return item;
+}
+
+/*
+ * INGEST STAGES
+ * 
+ * Each stage pops an item, does its step (skipped once the command has
+ * failed) and passes it on. The parser sends NULL at the end of the
+ * script; every stage forwards it and stops.
+ */
+void* ingest_parse_stage(void* arg) {
+    struct ingest_pipeline* pipeline = arg;
+    struct stage_stats* stats = &pipeline->stats[0];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    char line[MAX_COMMAND_LINE];
+    size_t len;
+    int line_status;
+    struct ingest_item* item = spsc_ring_pop(&pipeline->free_items, stats);
+    
+    while ((line_status = read_command_line(pipeline->script_ptr, line, sizeof(line), &len)) != 0) {
+        memset(&item->result, 0, sizeof(item->result));
+        item->result.arena = &item->arena;
+        
+        if (line_status < 0) {
+            memset(&item->command, 0, sizeof(item->command));
+            item->result.status = COMMAND_BAD_SYNTAX;
+            snprintf(item->result.detail, sizeof(item->result.detail),
+                     "line longer than %d characters", MAX_COMMAND_LINE - 2);
+        } else {
+            size_t start_pos = 0;
+            while (start_pos < len && isspace((unsigned char)line[start_pos])) start_pos++;
+            if (start_pos == len || line[start_pos] == '#') continue;  // Reuse the item
+            
+            item->result.status = parse_command(line + start_pos, len - start_pos, &item->command, &item->result);
+        }
+        
+        stats->items++;
+        spsc_ring_push(&pipeline->parsed, item, stats);
+        item = spsc_ring_pop(&pipeline->free_items, stats);
+    }
+    
+    spsc_ring_push(&pipeline->parsed, NULL, stats);
+    stats->seconds = elapsed_seconds(&start);
+    return NULL;
+}
+
+void* ingest_validate_stage(void* arg) {
+    struct ingest_pipeline* pipeline = arg;
+    struct stage_stats* stats = &pipeline->stats[1];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct ingest_item* item;
+    while ((item = spsc_ring_pop(&pipeline->parsed, stats)) != NULL) {
+        if (item->result.status == COMMAND_OK) {
+            item->result.status = validate_command(&item->command, &item->result);
+        }
+        stats->items++;
+        spsc_ring_push(&pipeline->validated, item, stats);
+    }
+    
+    spsc_ring_push(&pipeline->validated, NULL, stats);
+    stats->seconds = elapsed_seconds(&start);
+    return NULL;
+}
+
+void* ingest_apply_stage(void* arg) {
+    struct ingest_pipeline* pipeline = arg;
+    struct stage_stats* stats = &pipeline->stats[2];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct ingest_item* item;
+    while ((item = spsc_ring_pop(&pipeline->validated, stats)) != NULL) {
+        if (item->result.status == COMMAND_OK) {
+            item->result.status = apply_command(&pipeline->session, &item->command, &item->result);
+        }
+        stats->items++;
+        spsc_ring_push(&pipeline->applied, item, stats);
+    }
+    
+    spsc_ring_push(&pipeline->applied, NULL, stats);
+    stats->seconds = elapsed_seconds(&start);
+    return NULL;
+}
+
+void ingest_log_stage(struct ingest_pipeline* pipeline) {
+    struct stage_stats* stats = &pipeline->stats[3];
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    
+    struct ingest_item* item;
+    while ((item = spsc_ring_pop(&pipeline->applied, stats)) != NULL) {
+        log_command(&pipeline->session, &item->command, &item->result);
+        arena_reset(&item->arena);
+        stats->items++;
+        spsc_ring_push(&pipeline->free_items, item, stats);
+    }
+    
+    stats->seconds = elapsed_seconds(&start);
+}
+
+/*
+ * RUN_INGEST_PIPELINE
+ * 
+ * Purpose: Execute a command script on the four-stage pipeline
+ * Parameters:
+ *   - script_ptr: one command per line
+ *   - data_path/history_path: files the commands work on
+ *   - output_ptr: receives one answer line per command
+ *   - audit: log recording every command, or NULL
+ *   - stats: INGEST_STAGES counters (parse, validate, apply, log), may be NULL
+ * Returns: number of failed commands, or -1 on error
+ */
+long run_ingest_pipeline(FILE* script_ptr, const char* data_path, const char* history_path,
+                         FILE* output_ptr, int publish_view, struct audit_log* audit, struct stage_stats* stats) {
+    static const char* stage_names[INGEST_STAGES] = {"parse", "validate", "apply", "log"};
+    
+    struct ingest_pipeline pipeline;
+    memset(&pipeline, 0, sizeof(pipeline));
+    pipeline.script_ptr = script_ptr;
+    for (int i = 0; i < INGEST_STAGES; i++) pipeline.stats[i].name = stage_names[i];
+    
+    if (!command_session_open(&pipeline.session, data_path, history_path, output_ptr)) return -1;
+    if (publish_view) command_session_publish_view(&pipeline.session, data_path);  // Best effort
+    command_session_audit(&pipeline.session, audit);  // Only the apply stage records
+    
+    pipeline.items = malloc(INGEST_ITEMS * sizeof(struct ingest_item));
+    int ok = (pipeline.items != NULL);
+    ok = spsc_ring_init(&pipeline.free_items, INGEST_ITEMS) && ok;
+    ok = spsc_ring_init(&pipeline.parsed, INGEST_RING_SIZE) && ok;
+    ok = spsc_ring_init(&pipeline.validated, INGEST_RING_SIZE) && ok;
+    ok = spsc_ring_init(&pipeline.applied, INGEST_RING_SIZE) && ok;
+    
+    long failed = -1;
+    if (ok) {
+        for (int i = 0; i < INGEST_ITEMS; i++) {
+            arena_init(&pipeline.items[i].arena, LISTING_SIZE);
+            spsc_ring_try_push(&pipeline.free_items, &pipeline.items[i]);
+        }
+        
+        pthread_t threads[INGEST_STAGES - 1];
+        void* (*stages[INGEST_STAGES - 1])(void*) = {
+            ingest_parse_stage, ingest_validate_stage, ingest_apply_stage
+        };
+        struct spsc_ring* outputs[INGEST_STAGES - 1] = {
+            &pipeline.parsed, &pipeline.validated, &pipeline.applied
+        };
+        
+        // Start from the back, so if a thread cannot be created the
+        // stages behind it are already running and can be stopped by
+        // sending them the end marker in its place
+        int missing_stage = -1;
+        for (int i = INGEST_STAGES - 2; i >= 0; i--) {
+            if (pthread_create(&threads[i], NULL, stages[i], &pipeline) != 0) {
+                missing_stage = i;
+                break;
+            }
+        }
+        if (missing_stage >= 0) {
+            printf("Error: Could not start the ingest pipeline threads.\n");
+            spsc_ring_push(outputs[missing_stage], NULL, &pipeline.stats[missing_stage]);
+        }
+        
+        ingest_log_stage(&pipeline);  // The calling thread logs
+        for (int i = missing_stage + 1; i < INGEST_STAGES - 1; i++) pthread_join(threads[i], NULL);
+        if (missing_stage < 0) failed = pipeline.session.failed;
+    }
+    
+    spsc_ring_destroy(&pipeline.free_items);
+    spsc_ring_destroy(&pipeline.parsed);
+    spsc_ring_destroy(&pipeline.validated);
+    spsc_ring_destroy(&pipeline.applied);
+    for (int i = 0; ok && i < INGEST_ITEMS; i++) arena_release(&pipeline.items[i].arena);
+    free(pipeline.items);
+    command_session_close(&pipeline.session);
+    
+    if (stats != NULL) memcpy(stats, pipeline.stats, sizeof(pipeline.stats));
+    return failed;
+}
+
+/*
+ * HOT ACCOUNTS
+ * 
+ * Merchant and clearing accounts can get thousands of small updates a
+ * second from many threads. Updating the record each time would make
+ * every one of them wait for the same read-modify-write. Instead a
+ * tracked ("hot") account collects deltas in HOT_STRIPES counters, one
+ * per CPU, each on its own cache line, so concurrent updates touch
+ * different memory. The deltas are folded into the record - one write
+ * and one combined history entry - every HOT_FOLD_INTERVAL_MS, and
+ * whenever the exact balance is read.
+ * 
+ * Overdraft limit: credits can only raise the balance, so they are
+ * accepted without any check. A debit must first take its amount from
+ * 'headroom_cents', which is the folded balance plus the overdraft
+ * limit minus the debits not yet folded. Credits are only added to the
+ * headroom when they are folded. The headroom can therefore understate
+ * what may be spent, never overstate it. If a debit does not fit, the
+ * account is folded and the debit retried once before it is refused.
+ * 
+ * Status flags: every delta is refused on a frozen or closed account,
+ * and an account without the overdraft flag may only spend its balance,
+ * whatever the store's overdraft limit. The flags are checked on each
+ * delta, so a change takes effect immediately.
+ * 
+ * Folds use the same compare-on-write as other updates, so a change made
+ * outside the hot store (a teller, a script) is picked up and built on
+ * rather than overwritten. Deltas not yet folded are lost if the process
+ * dies, so the fold interval is also the window of updates at risk.
+ */
+
+/*
+ * HOT_STORE_OPEN
+ * 
+ * Purpose: Open the data and history files and start the folder thread
+ * Returns: 1 on success, 0 on failure
+ */
+int hot_store_open(struct hot_store* store, const char* data_path, const char* history_path,
+                   long long overdraft_limit_cents) {
+    memset(store, 0, sizeof(*store));
+    store->overdraft_limit_cents = overdraft_limit_cents;
+    
+    store->data_ptr = fopen(data_path, "rb+");
+    store->history_ptr = (store->data_ptr != NULL) ? fopen(history_path, "ab") : NULL;
+    if (store->history_ptr == NULL) {
+        printf("Error: Could not open '%s' and '%s' for hot account updates.\n", data_path, history_path);
+        if (store->data_ptr != NULL) fclose(store->data_ptr);
+        return 0;
+    }
+    
+    store->flags = account_flags_open(data_path, 0);
+    pthread_mutex_init(&store->file_lock, NULL);
+    pthread_mutex_init(&store->track_lock, NULL);
+    pthread_mutex_init(&store->folder_lock, NULL);
+    pthread_cond_init(&store->folder_wake, NULL);
+    
+    // Without a folder thread deltas are still folded on read and on close
+    store->folder_running = (pthread_create(&store->folder, NULL, hot_store_folder, store) == 0);
+    return 1;
+}
+
+/*
+ * HOT_STORE_CLOSE
+ * 
+ * Purpose: Stop the folder, fold every pending delta and close the files
+ */
+void hot_store_close(struct hot_store* store) {
+    if (store->folder_running) {
+        pthread_mutex_lock(&store->folder_lock);
+        store->stopping = 1;
+        pthread_cond_signal(&store->folder_wake);
+        pthread_mutex_unlock(&store->folder_lock);
+        pthread_join(store->folder, NULL);
+    }
+    
+    hot_store_fold_all(store);
+    
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        if (store->accounts[i] == NULL) continue;
+        pthread_mutex_destroy(&store->accounts[i]->fold_lock);
+        free(store->accounts[i]);
+    }
+    
+    if (store->flags != NULL) account_flags_close(store->flags);
+    fclose(store->history_ptr);
+    fclose(store->data_ptr);
+    pthread_mutex_destroy(&store->file_lock);
+    pthread_mutex_destroy(&store->track_lock);
+    pthread_mutex_destroy(&store->folder_lock);
+    pthread_cond_destroy(&store->folder_wake);
+}
+
+/*
+ * HOT_STORE_TRACK
+ * 
+ * Purpose: Start coalescing updates for an account (or find it if
+ * already tracked)
+ * Returns: the hot account, or NULL if the account does not exist
+ */
+struct hot_account* hot_store_track(struct hot_store* store, unsigned int acct_num) {
+    if (!validate_account_number(acct_num)) return NULL;
+    
+    pthread_mutex_lock(&store->track_lock);
+    struct hot_account* account = store->accounts[acct_num - 1];
+    if (account == NULL) {
+        struct client_data client;
+        pthread_mutex_lock(&store->file_lock);
+        int found = read_client_from_file(store->data_ptr, &client, acct_num - 1) && client.acct_num != 0;
+        pthread_mutex_unlock(&store->file_lock);
+        
+        account = found ? aligned_alloc(64, sizeof(struct hot_account)) : NULL;
+        if (account != NULL) {
+            memset(account, 0, sizeof(*account));
+            account->client = client;
+            account->acct_num = client.acct_num;
+            atomic_init(&account->headroom_cents,
+                        balance_to_cents(client.balance) + store->overdraft_limit_cents);
+            pthread_mutex_init(&account->fold_lock, NULL);
+            store->accounts[acct_num - 1] = account;
+        }
+    }
+    pthread_mutex_unlock(&store->track_lock);
+    return account;
+}
+
+/*
+ * HOT_ACCOUNT_ADD
+ * 
+ * Purpose: Record a delta (+credit/-debit, in cents) for a hot account
+ * Returns: HOT_OK, HOT_REFUSED if the account is frozen or closed,
+ * HOT_OVERDRAFT if the debit was refused, or HOT_IO_ERROR if folding to
+ * make room failed
+ */
+int hot_account_add(struct hot_store* store, struct hot_account* account, long long cents) {
+    unsigned int acct_num = account->acct_num;
+    if (account_flags_refusal(store->flags, COMMAND_UPDATE, acct_num, 0, NULL, 0) != COMMAND_OK) return HOT_REFUSED;
+    
+    int cpu = sched_getcpu();
+    struct delta_stripe* stripe = &account->stripes[(cpu > 0 ? cpu : 0) % HOT_STRIPES];
+    
+    if (cents >= 0) {
+        atomic_fetch_add_explicit(&stripe->credit_cents, cents, memory_order_relaxed);
+        atomic_fetch_add_explicit(&stripe->deltas, 1, memory_order_relaxed);
+        return HOT_OK;
+    }
+    
+    // Take the debit out of the headroom first; fold once if it does not fit.
+    // Without the overdraft flag the overdraft limit part of the headroom is off limits.
+    long long reserved = account_flag(store->flags, acct_num, ACCOUNT_OVERDRAFT) ? 0 : store->overdraft_limit_cents;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        long long headroom = atomic_load(&account->headroom_cents);
+        while (headroom + cents >= reserved) {
+            if (atomic_compare_exchange_weak(&account->headroom_cents, &headroom, headroom + cents)) {
+                atomic_fetch_add_explicit(&stripe->debit_cents, cents, memory_order_relaxed);
+                atomic_fetch_add_explicit(&stripe->deltas, 1, memory_order_relaxed);
+                return HOT_OK;
+            }
+        }
+        if (attempt == 0 && !hot_account_fold(store, account)) return HOT_IO_ERROR;
+    }
+    return HOT_OVERDRAFT;
+}
+
+/*
+ * HOT_ACCOUNT_FOLD
+ * 
+ * Purpose: Move all pending deltas into the record, writing it and one
+ * history entry for their sum
+ * Returns: 1 on success, 0 on a write error (the deltas stay pending)
+ */
+int hot_account_fold(struct hot_store* store, struct hot_account* account) {
+    pthread_mutex_lock(&account->fold_lock);
+    
+    long long credits = 0, debits = 0;
+    long deltas = 0;
+    for (int i = 0; i < HOT_STRIPES; i++) {
+        credits += atomic_exchange(&account->stripes[i].credit_cents, 0);
+        debits += atomic_exchange(&account->stripes[i].debit_cents, 0);
+        deltas += atomic_exchange(&account->stripes[i].deltas, 0);
+    }
+    
+    int success = 1;
+    if (deltas > 0) {
+        struct client_data client;
+        int position = account->client.acct_num - 1;
+        int status = UPDATE_CONFLICT;
+        
+        pthread_mutex_lock(&store->file_lock);
+        for (int attempt = 0; status == UPDATE_CONFLICT && attempt <= UPDATE_RETRY_LIMIT; attempt++) {
+            if (attempt > 0) {
+                // Written outside the hot store: build on that balance, and let
+                // its change count towards what may be debited
+                struct client_data current;
+                if (!read_client_from_file(store->data_ptr, &current, position) ||
+                    current.acct_num != account->client.acct_num) break;
+                atomic_fetch_add(&account->headroom_cents,
+                                 balance_to_cents(current.balance) - balance_to_cents(account->client.balance));
+                account->client = current;
+            }
+            
+            client = account->client;
+            client.balance = (balance_to_cents(client.balance) + credits + debits) / 100.0;
+            status = write_client_if_unchanged(store->data_ptr, &client, position, &account->client);
+        }
+        success = (status == UPDATE_OK);
+        if (success) {
+            append_transaction(store->history_ptr, client.acct_num, (credits + debits) / 100.0, client.balance);
+            fflush(store->history_ptr);
+            account_flags_note_balance(store->flags, client.acct_num, client.balance);
+        }
+        pthread_mutex_unlock(&store->file_lock);
+        
+        if (success) {
+            account->client = client;
+            account->folds++;
+            atomic_fetch_add(&account->headroom_cents, credits);  // Credits are now spendable
+        } else {
+            // Put the sums back so the next fold retries them
+            atomic_fetch_add(&account->stripes[0].credit_cents, credits);
+            atomic_fetch_add(&account->stripes[0].debit_cents, debits);
+            atomic_fetch_add(&account->stripes[0].deltas, deltas);
+        }
+    }
+    
+    pthread_mutex_unlock(&account->fold_lock);
+    return success;
+}
+
+/*
+ * HOT_ACCOUNT_BALANCE
+ * 
+ * Purpose: Exact balance in cents, folding pending deltas first
+ */
+long long hot_account_balance(struct hot_store* store, struct hot_account* account) {
+    hot_account_fold(store, account);
+    
+    pthread_mutex_lock(&account->fold_lock);
+    long long cents = balance_to_cents(account->client.balance);
+    pthread_mutex_unlock(&account->fold_lock);
+    return cents;
+}
+
+/*
+ * HOT_STORE_FOLD_ALL / HOT_STORE_FOLDER
+ * 
+ * Purpose: Fold every tracked account; the folder thread does this
+ * every HOT_FOLD_INTERVAL_MS until the store is closed
+ */
+void hot_store_fold_all(struct hot_store* store) {
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        pthread_mutex_lock(&store->track_lock);
+        struct hot_account* account = store->accounts[i];
+        pthread_mutex_unlock(&store->track_lock);
+        
+        if (account != NULL) hot_account_fold(store, account);
+    }
+}
+
+void* hot_store_folder(void* arg) {
+    struct hot_store* store = arg;
+    
+    pthread_mutex_lock(&store->folder_lock);
+    while (!store->stopping) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_nsec += HOT_FOLD_INTERVAL_MS * 1000000L;
+        if (wake.tv_nsec >= 1000000000L) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&store->folder_wake, &store->folder_lock, &wake);
+        
+        pthread_mutex_unlock(&store->folder_lock);
+        hot_store_fold_all(store);
+        pthread_mutex_lock(&store->folder_lock);
+    }
+    pthread_mutex_unlock(&store->folder_lock);
+    return NULL;
+}
+
+/*
+ * ACCOUNT TABLE
+ * 
+ * Balance inquiries far outnumber updates, so a command session keeps
+ * every record in memory and answers reads from there. Each record has
+ * its own sequence lock: a writer makes the sequence odd, copies the
+ * record in and makes it even again; a reader copies the record out
+ * and keeps the copy only if the sequence was the same even number
+ * before and after. Readers therefore take no lock and write no shared
+ * memory - many threads can read the same record without its cache
+ * line moving between CPUs - and repeat a read only when it overlapped
+ * a write to that very record.
+ * 
+ * The file stays the authority. Writes go to the file first, with the
+ * usual compare-on-write, and are published to the table afterwards.
+ * A change made by another process is not seen by readers until the
+ * record is written here: the compare-on-write then reports a conflict
+ * and the record is refreshed from the file before the retry.
+ * 
+ * The table as a whole has a generation, made odd by a writer for as
+ * long as it is publishing, so all the records of one change (both
+ * sides of a transfer) appear at once to account_table_snapshot.
+ */
+
+/*
+ * ACCOUNT_TABLE_LOAD
+ * 
+ * Purpose: Build a table holding every record of the data file
+ * Returns: the table (free with free()), or NULL on failure
+ */
+struct account_table* account_table_load(FILE* data_ptr) {
+    struct account_table* table = aligned_alloc(64, sizeof(struct account_table));
+    if (table == NULL) return NULL;
+    
+    account_table_init(table);
+    if (!account_table_reload(table, data_ptr)) {
+        free(table);
+        return NULL;
+    }
+    return table;
+}
+
+/*
+ * ACCOUNT_TABLE_INIT / ACCOUNT_TABLE_RELOAD
+ * 
+ * Purpose: Empty a table / refresh every record of it from the data file
+ * Returns (reload): 1 on success, 0 if a record could not be read
+ * 
+ * Slots past the end of a short data file are empty records.
+ */
+void account_table_init(struct account_table* table) {
+    atomic_init(&table->generation, 0);
+    atomic_init(&table->owner, 0);
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        atomic_init(&table->records[i].sequence, 0);
+        for (size_t w = 0; w < TABLE_RECORD_WORDS; w++) atomic_init(&table->records[i].words[w], 0);
+    }
+}
+
+int account_table_reload(struct account_table* table, FILE* data_ptr) {
+    struct client_data clients[MAX_ACCOUNTS];
+    int positions[MAX_ACCOUNTS];
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        if (!read_client_from_file(data_ptr, &clients[i], i)) {
+            if (ferror(data_ptr)) return 0;
+            memset(&clients[i], 0, sizeof(clients[i]));
+        }
+        positions[i] = i;
+    }
+    
+    account_table_publish(table, clients, positions, MAX_ACCOUNTS, 1);
+    return 1;
+}
+
+/*
+ * ACCOUNT_TABLE_READ
+ * 
+ * Purpose: Copy a record out of the table without locking
+ * Returns: number of times the copy had to be repeated because a
+ * writer was in the record (normally 0)
+ */
+int account_table_read(struct account_table* table, int position, struct client_data* client) {
+    struct table_record* record = &table->records[position];
+    unsigned long long words[TABLE_RECORD_WORDS];
+    unsigned int attempts = 0;
+    int retries = 0;
+    
+    for (;;) {
+        unsigned int before = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (size_t i = 0; i < TABLE_RECORD_WORDS; i++) {
+                words[i] = atomic_load_explicit(&record->words[i], memory_order_relaxed);
+            }
+            // The word loads may not move below the second sequence load
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&record->sequence, memory_order_relaxed) == before) break;
+        }
+        retries++;
+        ring_backoff(&attempts);
+    }
+    
+    memcpy(client, words, sizeof(*client));
+    return retries;
+}
+
+/*
+ * ACCOUNT_TABLE_PUBLISH
+ * 
+ * Purpose: Store records that have been written to the file, as one
+ * change of the table
+ * Parameters:
+ *   - clients, positions: 'count' records and where they go
+ *   - from_file: 1 if the records were just read from the file (always stored)
+ * 
+ * Writers take turns by claiming the table's owner field with their
+ * process id and making the generation odd; the records of a transfer
+ * therefore appear together to snapshot readers. Two
+ * sessions sharing a table can finish their file writes in one order
+ * and publish them in the other, so a written record older than the one
+ * in the table (by its version stamp) is ignored.
+ */
+void account_table_publish(struct account_table* table, const struct client_data* clients,
+                           const int* positions, int count, int from_file) {
+    unsigned int attempts = 0;
+    int self = (int)getpid();
+    int owner = 0;
+    while (!atomic_compare_exchange_weak_explicit(&table->owner, &owner, self, memory_order_acquire,
+                                                  memory_order_relaxed)) {
+        ring_backoff(&attempts);
+        owner = 0;
+    }
+    unsigned long generation = atomic_load_explicit(&table->generation, memory_order_relaxed);
+    atomic_store_explicit(&table->generation, generation + 1, memory_order_relaxed);
+    // The odd generation must be visible before any of the new words
+    atomic_thread_fence(memory_order_release);
+    
+    for (int r = 0; r < count; r++) {
+        struct table_record* record = &table->records[positions[r]];
+        unsigned long long words[TABLE_RECORD_WORDS];
+        struct client_data current;
+        for (size_t i = 0; i < TABLE_RECORD_WORDS; i++) {
+            words[i] = atomic_load_explicit(&record->words[i], memory_order_relaxed);
+        }
+        memcpy(&current, words, sizeof(current));
+        
+        // Versions wrap around; anything less than half the range behind is older
+        if (!from_file && (short)(clients[r].version - current.version) < 0) continue;
+        
+        unsigned int sequence = atomic_load_explicit(&record->sequence, memory_order_relaxed);
+        atomic_store_explicit(&record->sequence, sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        memcpy(words, &clients[r], sizeof(words));
+        for (size_t i = 0; i < TABLE_RECORD_WORDS; i++) {
+            atomic_store_explicit(&record->words[i], words[i], memory_order_relaxed);
+        }
+        atomic_store_explicit(&record->sequence, sequence + 2, memory_order_release);
+    }
+    
+    atomic_store_explicit(&table->generation, generation + 2, memory_order_release);
+    atomic_store_explicit(&table->owner, 0, memory_order_release);
+}
+
+/*
+ * ACCOUNT_TABLE_SNAPSHOT
+ * 
+ * Purpose: Copy every record out of the table as of one moment
+ * Returns: the generation the copy belongs to (even); it only grows,
+ * so a caller polling for changes can compare it with the last one
+ */
+unsigned long account_table_snapshot(struct account_table* table, struct client_data* clients) {
+    unsigned int attempts = 0;
+    
+    for (;;) {
+        unsigned long before = atomic_load_explicit(&table->generation, memory_order_acquire);
+        if ((before & 1) == 0) {
+            for (int r = 0; r < MAX_ACCOUNTS; r++) {
+                unsigned long long words[TABLE_RECORD_WORDS];
+                for (size_t i = 0; i < TABLE_RECORD_WORDS; i++) {
+                    words[i] = atomic_load_explicit(&table->records[r].words[i], memory_order_relaxed);
+                }
+                memcpy(&clients[r], words, sizeof(clients[r]));
+            }
+            atomic_thread_fence(memory_order_acquire);
+            if (atomic_load_explicit(&table->generation, memory_order_relaxed) == before) return before;
+        }
+        ring_backoff(&attempts);
+    }
+}
+
+/*
+ * ACCOUNT_TABLE_REFRESH
+ * 
+ * Purpose: Reload one record from the data file into the table
+ * Returns: 1 on success, 0 if the record could not be read
+ */
+int account_table_refresh(struct account_table* table, FILE* data_ptr, int position) {
+    struct client_data client;
+    if (!read_client_from_file(data_ptr, &client, position)) return 0;
+    account_table_publish(table, &client, &position, 1, 1);
+    return 1;
+}
+
+/*
+ * ACCOUNT_TABLE_RECOVER
+ * 
+ * Purpose: End the turn of a writer that died while publishing to a
+ * shared table, which would otherwise leave the generation (and maybe
+ * a record) odd for good and every reader and writer waiting on it
+ * Returns: 1 if a dead writer's turn was ended, 0 if there was none
+ * 
+ * Only a writer opening the view calls this, under the view's lock.
+ * The dead writer's turn is taken over, the records it left odd are
+ * read again from the file before they are made even, and the
+ * generation moves on to the next even number, so pollers see a change.
+ */
+int account_table_recover(struct account_table* table, FILE* data_ptr) {
+    int owner = atomic_load_explicit(&table->owner, memory_order_acquire);
+    if (owner == 0 || kill(owner, 0) == 0 || errno != ESRCH) return 0;
+    if (!atomic_compare_exchange_strong_explicit(&table->owner, &owner, (int)getpid(), memory_order_acquire,
+                                                 memory_order_relaxed)) {
+        return 0;
+    }
+    
+    for (int i = 0; i < MAX_ACCOUNTS; i++) {
+        struct table_record* record = &table->records[i];
+        unsigned int sequence = atomic_load_explicit(&record->sequence, memory_order_relaxed);
+        if ((sequence & 1) == 0) continue;
+        
+        struct client_data client;
+        if (!read_client_from_file(data_ptr, &client, i)) memset(&client, 0, sizeof(client));
+        unsigned long long words[TABLE_RECORD_WORDS];
+        memcpy(words, &client, sizeof(words));
+        for (size_t w = 0; w < TABLE_RECORD_WORDS; w++) {
+            atomic_store_explicit(&record->words[w], words[w], memory_order_relaxed);
+        }
+        atomic_store_explicit(&record->sequence, sequence + 1, memory_order_release);
+    }
+    
+    unsigned long generation = atomic_load_explicit(&table->generation, memory_order_relaxed);
+    atomic_store_explicit(&table->generation, (generation | 1) + 1, memory_order_release);
+    atomic_store_explicit(&table->owner, 0, memory_order_release);
+    return 1;
+}
+
+/*
+ * SHARED VIEW
+ * 
+ * Fraud scoring, dashboards and other local processes want current
+ * balances without each opening and reading the data file. Command
+ * sessions started from the command line therefore keep their account
+ * table in a POSIX shared-memory object named after the data file
+ * (device and inode, so every path to the file finds the same view).
+ * Other processes map it read-only and use account_table_read or
+ * account_table_snapshot on it: a balance is then a few loads from
+ * memory - no system call, no copy through the kernel - and the
+ * sequence locks tell them when to repeat a read. Readers write
+ * nothing, so any number of them cost the writers nothing.
+ * 
+ * The view holds committed records only: a record is published after
+ * its write to the file succeeded. Each writer reloads the whole table
+ * from the file when it opens the view, so the view catches up with
+ * changes made while no writer had it open; changes made by the
+ * interactive menu reach it with the next write to that record. A
+ * writer killed while publishing cannot leave the view stuck: the next
+ * writer to open it ends the dead writer's turn first.
+ */
+
+/*
+ * SHARED_VIEW_NAME
+ * 
+ * Purpose: Name of the shared-memory object holding a data file's view
+ * Returns: 1 on success, 0 if the data file does not exist
+ */
+int shared_view_name(const char* data_path, char* name, size_t size) {
+    struct stat info;
+    if (stat(data_path, &info) != 0) return 0;
+    
+    int written = snprintf(name, size, "/bank-view-%lx-%lx",
+                           (unsigned long)info.st_dev, (unsigned long)info.st_ino);
+    return written > 0 && (size_t)written < size;
+}
+
+/*
+ * SHARED_VIEW_OPEN
+ * 
+ * Purpose: Map a data file's view
+ * Parameters:
+ *   - data_ptr: the open data file, for a writer (the view is created
+ *     if needed and reloaded from it); NULL to map the view read-only
+ * Returns: the view (release with shared_view_close), or NULL if it
+ * could not be mapped or - for a reader - no writer has created it
+ */
+struct shared_view* shared_view_open(const char* data_path, FILE* data_ptr) {
+    char name[VIEW_NAME_SIZE];
+    if (!shared_view_name(data_path, name, sizeof(name))) return NULL;
+    
+    int writable = (data_ptr != NULL);
+    int fd = shm_open(name, writable ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+    if (fd < 0) return NULL;
+    
+    // Writers set the view up one at a time; readers only check 'ready'
+    struct stat info;
+    int ok = (!writable || flock(fd, LOCK_EX) == 0) && fstat(fd, &info) == 0;
+    if (ok && writable && info.st_size == 0) {
+        ok = (ftruncate(fd, sizeof(struct shared_view)) == 0);
+    } else if (ok) {
+        ok = (info.st_size == (off_t)sizeof(struct shared_view));
+    }
+    
+    struct shared_view* view = NULL;
+    if (ok) {
+        void* mapping = mmap(NULL, sizeof(struct shared_view), writable ? PROT_READ | PROT_WRITE : PROT_READ,
+                             MAP_SHARED, fd, 0);
+        view = (mapping == MAP_FAILED) ? NULL : mapping;
+    }
+    
+    if (view != NULL && writable) {
+        // New, or left half set up by a writer that died
+        if (atomic_load_explicit(&view->ready, memory_order_acquire) != 1) {
+            account_table_init(&view->table);
+            memcpy(view->magic, VIEW_MAGIC, sizeof(view->magic));
+            view->record_size = RECORD_SIZE;
+            view->max_accounts = MAX_ACCOUNTS;
+        }
+        
+        // Or left mid-publish by a writer that died
+        account_table_recover(&view->table, data_ptr);
+        
+        if (!account_table_reload(&view->table, data_ptr)) {
+            shared_view_close(view);
+            view = NULL;
+        } else {
+            atomic_store_explicit(&view->ready, 1, memory_order_release);
+        }
+    } else if (view != NULL) {
+        if (atomic_load_explicit(&view->ready, memory_order_acquire) != 1 ||
+            memcmp(view->magic, VIEW_MAGIC, sizeof(view->magic)) != 0 ||
+            view->record_size != RECORD_SIZE || view->max_accounts != MAX_ACCOUNTS) {
+            shared_view_close(view);
+            view = NULL;
+        }
+    }
+    
+    flock(fd, LOCK_UN);  // The mapping keeps the file open, so closing alone would not unlock it
+    close(fd);
+    return view;
+}
+
+void shared_view_close(struct shared_view* view) {
+    munmap(view, sizeof(struct shared_view));
+}
+
+/*
+ * SHARED_VIEW_REMOVE
+ * 
+ * Purpose: Delete a data file's view (mappings already made stay valid)
+ * Returns: 1 if a view was removed
+ */
+int shared_view_remove(const char* data_path) {
+    char name[VIEW_NAME_SIZE];
+    return shared_view_name(data_path, name, sizeof(name)) && shm_unlink(name) == 0;
+}
+
+/*
+ * PRINT_SHARED_VIEW
+ * 
+ * Purpose: Print one account, or every active account, from the view
+ * ("version3 view"), the way a reading process would use it
+ * Returns: 1 on success, 0 if there is no view
+ */
+int print_shared_view(const char* data_path, unsigned int acct_num, FILE* output_ptr) {
+    struct shared_view* view = shared_view_open(data_path, NULL);
+    if (view == NULL) {
+        fprintf(output_ptr, "ERR IO_ERROR no shared view of '%s' (run a command on it first)\n", data_path);
+        return 0;
+    }
+    
+    int found = 1;
+    if (acct_num != 0) {
+        struct client_data client;
+        found = validate_account_number(acct_num);
+        if (found) account_table_read(&view->table, acct_num - 1, &client);
+        found = found && client.acct_num != 0;
+        if (found) {
+            fprintf(output_ptr, "OK %u %s %s %.2f\n", client.acct_num, client.last_name,
+                    client.first_name, client.balance);
+        } else {
+            fprintf(output_ptr, "ERR NOT_FOUND account %u not found\n", acct_num);
+        }
+    } else {
+        struct client_data clients[MAX_ACCOUNTS];
+        unsigned long generation = account_table_snapshot(&view->table, clients);
+        long listed = 0;
+        for (int i = 0; i < MAX_ACCOUNTS; i++) {
+            if (clients[i].acct_num == 0) continue;
+            fprintf(output_ptr, "%u %s %s %.2f\n", clients[i].acct_num, clients[i].last_name,
+                    clients[i].first_name, clients[i].balance);
+            listed++;
+        }
+        fprintf(output_ptr, "OK %ld generation %lu\n", listed, generation / 2);
+    }
+    
+    shared_view_close(view);
+    return found;
+}
+
+/*
+ * ACCOUNT STATUS FLAGS
+ * 
+ * Whether an account is frozen, closed, or allowed to go below zero is
+ * asked before every update, transfer and delete, so the answer must
+ * cost less than the record read it may save. Each flag is a bitmap
+ * with one bit per account number, all three in "<data file>.flags",
+ * which every process maps shared: a check is one load from memory,
+ * no lock and no system call, and a freeze made by "version3 freeze"
+ * is seen at once by every running session.
+ * 
+ * Flags are changed with atomic OR/AND on whole 64-bit words, so a
+ * list of accounts costs one atomic operation per run of accounts in
+ * the same word rather than one per account. A command that has
+ * already passed the check when an account is frozen still finishes.
+ * 
+ * A data file without a flag file behaves as before: nothing is frozen
+ * or closed and every account may be overdrawn. When the flag file is
+ * created every account starts with ACCOUNT_OVERDRAFT set, for the
+ * same reason.
+ * 
+ * The same file holds the index of overdrawn accounts used by the
+ * overdraft fee job, kept up to date by account_flags_note_balance.
+ */
+
+/*
+ * ACCOUNT_FLAGS_OPEN
+ * 
+ * Purpose: Map the status flags of a data file
+ * Parameters: create - 1 to create the flag file if it does not exist yet
+ * Returns: the flags (release with account_flags_close), or NULL if
+ * there is no flag file (and create is 0) or it cannot be mapped
+ */
+struct account_flags* account_flags_open(const char* data_path, int create) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, FLAGS_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return NULL;
+    
+    int fd = open(path, O_RDWR | (create ? O_CREAT : 0), 0644);
+    if (fd < 0) return NULL;
+    
+    // The first opener sets the defaults; others wait for it on the lock
+    struct stat info;
+    int ok = flock(fd, LOCK_EX) == 0 && fstat(fd, &info) == 0;
+    if (ok && info.st_size == 0) {
+        ok = (ftruncate(fd, sizeof(struct account_flags)) == 0);
+    } else if (ok) {
+        ok = (info.st_size == (off_t)sizeof(struct account_flags));
+    }
+    
+    struct account_flags* flags = NULL;
+    if (ok) {
+        void* mapping = mmap(NULL, sizeof(struct account_flags), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        flags = (mapping == MAP_FAILED) ? NULL : mapping;
+    }
+    
+    if (flags != NULL && atomic_load_explicit(&flags->ready, memory_order_acquire) != 1) {
+        memcpy(flags->magic, FLAGS_MAGIC, sizeof(flags->magic));
+        flags->max_account = MAX_ACCOUNT_NUM;
+        flags->words = FLAG_WORDS;
+        for (unsigned int acct_num = MIN_ACCOUNT_NUM; acct_num <= MAX_ACCOUNT_NUM; acct_num++) {
+            atomic_fetch_or_explicit(&flags->bits[ACCOUNT_OVERDRAFT][acct_num / 64], 1ULL << (acct_num % 64),
+                                     memory_order_relaxed);
+        }
+        atomic_store_explicit(&flags->ready, 1, memory_order_release);
+    } else if (flags != NULL && (memcmp(flags->magic, FLAGS_MAGIC, sizeof(flags->magic)) != 0 ||
+                                 flags->max_account != MAX_ACCOUNT_NUM || flags->words != FLAG_WORDS)) {
+        account_flags_close(flags);
+        flags = NULL;
+    }
+    
+    flock(fd, LOCK_UN);  // The mapping keeps the file open, so closing alone would not unlock it
+    close(fd);
+    return flags;
+}
+
+void account_flags_close(struct account_flags* flags) {
+    munmap(flags, sizeof(struct account_flags));
+}
+
+/*
+ * ACCOUNT_FLAG
+ * 
+ * Purpose: Test one flag of one account
+ * Returns: 1 if set; without flags (NULL), 1 for ACCOUNT_OVERDRAFT and
+ * 0 for the others
+ */
+int account_flag(const struct account_flags* flags, unsigned int acct_num, int flag) {
+    if (flags == NULL || acct_num > MAX_ACCOUNT_NUM) return flag == ACCOUNT_OVERDRAFT;
+    
+    unsigned long long word = atomic_load_explicit(&flags->bits[flag][acct_num / 64], memory_order_acquire);
+    return (int)((word >> (acct_num % 64)) & 1);
+}
+
+/*
+ * ACCOUNT_FLAGS_SET
+ * 
+ * Purpose: Set (on = 1) or clear one flag for a list of accounts
+ * Returns: number of accounts whose flag actually changed
+ * 
+ * Invalid account numbers are skipped. The change is flushed to the
+ * flag file before returning.
+ */
+long account_flags_set(struct account_flags* flags, int flag, const unsigned int* accounts, long count, int on) {
+    long changed = 0;
+    long i = 0;
+    while (i < count) {
+        if (!validate_account_number(accounts[i])) {
+            i++;
+            continue;
+        }
+        
+        // Neighbouring accounts in the same word go in together
+        unsigned int word = accounts[i] / 64;
+        unsigned long long mask = 0;
+        while (i < count && validate_account_number(accounts[i]) && accounts[i] / 64 == word) {
+            mask |= 1ULL << (accounts[i] % 64);
+            i++;
+        }
+        
+        atomic_ullong* bits = &flags->bits[flag][word];
+        unsigned long long before = on ? atomic_fetch_or_explicit(bits, mask, memory_order_acq_rel)
+                                       : atomic_fetch_and_explicit(bits, ~mask, memory_order_acq_rel);
+        changed += __builtin_popcountll(on ? mask & ~before : mask & before);
+    }
+    
+    msync(flags, sizeof(struct account_flags), MS_SYNC);
+    return changed;
+}
+
+/*
+ * ACCOUNT_FLAGS_REFUSAL
+ * 
+ * Purpose: Check a command against the frozen and closed flags of the
+ * accounts it involves (both sides of a transfer)
+ * Returns: COMMAND_OK, COMMAND_FROZEN or COMMAND_CLOSED, described in
+ * 'detail' unless it is NULL
+ * 
+ * Updates and transfers need open, unfrozen accounts; a delete only an
+ * unfrozen one, so closed accounts can be cleared out.
+ */
+int account_flags_refusal(const struct account_flags* flags, int command_type, unsigned int acct_num,
+                          unsigned int target_acct, char* detail, size_t size) {
+    if (flags == NULL) return COMMAND_OK;
+    if (command_type != COMMAND_UPDATE && command_type != COMMAND_TRANSFER && command_type != COMMAND_DELETE) {
+        return COMMAND_OK;
+    }
+    
+    unsigned int accounts[2] = {acct_num, target_acct};
+    int involved = (command_type == COMMAND_TRANSFER) ? 2 : 1;
+    for (int i = 0; i < involved; i++) {
+        int status = COMMAND_OK;
+        if (account_flag(flags, accounts[i], ACCOUNT_FROZEN)) {
+            status = COMMAND_FROZEN;
+        } else if (command_type != COMMAND_DELETE && account_flag(flags, accounts[i], ACCOUNT_CLOSED)) {
+            status = COMMAND_CLOSED;
+        }
+        
+        if (status != COMMAND_OK) {
+            if (detail != NULL) {
+                snprintf(detail, size, "account %u is %s", accounts[i],
+                         (status == COMMAND_FROZEN) ? "frozen" : "closed");
+            }
+            return status;
+        }
+    }
+    return COMMAND_OK;
+}
+
+/*
+ * ACCOUNT_FLAGS_NOTE_BALANCE
+ * 
+ * Purpose: Add an account to the overdrawn index if a write has just
+ * left it below zero (does nothing without flags)
+ * 
+ * The word is only written when the bit is not set yet, so an account
+ * that stays overdrawn costs one load per write.
+ */
+void account_flags_note_balance(struct account_flags* flags, unsigned int acct_num, double balance) {
+    if (flags == NULL || balance >= 0 || acct_num > MAX_ACCOUNT_NUM) return;
+    
+    atomic_ullong* word = &flags->overdrawn[acct_num / 64];
+    unsigned long long bit = 1ULL << (acct_num % 64);
+    if ((atomic_load_explicit(word, memory_order_relaxed) & bit) == 0) {
+        atomic_fetch_or_explicit(word, bit, memory_order_release);
+    }
+}
+
+/*
+ * ACCOUNT_FLAGS_INVALIDATE_INDEX
+ * 
+ * Purpose: Tell the next overdraft run to rebuild the overdrawn index,
+ * after records were written without account_flags_note_balance
+ */
+void account_flags_invalidate_index(const char* data_path) {
+    struct account_flags* flags = account_flags_open(data_path, 0);
+    if (flags == NULL) return;
+    
+    atomic_store_explicit(&flags->indexed, 0, memory_order_release);
+    account_flags_close(flags);
+}
+
+const char* account_flag_name(int flag) {
+    switch (flag) {
+        case ACCOUNT_FROZEN:    return "frozen";
+        case ACCOUNT_CLOSED:    return "closed";
+        case ACCOUNT_OVERDRAFT: return "overdraft";
+        default:                return "unknown";
+    }
+}
+
+/*
+ * READ_ACCOUNT_LIST
+ * 
+ * Purpose: Account numbers given as arguments, or one per word on
+ * stdin if the only argument is "-"
+ * Returns: number of accounts in '*accounts' (free it), or -1 if one
+ * was not a valid account number (reported on stdout)
+ */
+long read_account_list(int count, char* arguments[], unsigned int** accounts) {
+    int from_stdin = (count == 1 && strcmp(arguments[0], "-") == 0);
+    long capacity = from_stdin ? MAX_ACCOUNTS : count;
+    long listed = 0;
+    unsigned int* list = malloc(capacity * sizeof(*list));
+    if (list == NULL) return -1;
+    
+    for (long i = 0;; i++) {
+        char token[32];
+        const char* text;
+        if (from_stdin) {
+            if (scanf("%31s", token) != 1) break;
+            text = token;
+        } else {
+            if (i >= count) break;
+            text = arguments[i];
+        }
+        
+        char* end;
+        unsigned long acct_num = strtoul(text, &end, 10);
+        if (*end != '\0' || acct_num > MAX_ACCOUNT_NUM || !validate_account_number((unsigned int)acct_num)) {
+            printf("ERR BAD_ACCOUNT '%s' is not an account number\n", text);
+            free(list);
+            return -1;
+        }
+        
+        if (listed == capacity) {
+            unsigned int* grown = realloc(list, 2 * capacity * sizeof(*list));
+            if (grown == NULL) {
+                free(list);
+                return -1;
+            }
+            list = grown;
+            capacity *= 2;
+        }
+        list[listed++] = (unsigned int)acct_num;
+    }
+    
+    *accounts = list;
+    return listed;
+}
+
+/*
+ * RUN_FLAG_COMMAND
+ * 
+ * Purpose: "version3 freeze/unfreeze/flag": set or clear one flag for
+ * a list of accounts, creating the flag file if needed
+ * Returns: process exit status (0 on success)
+ */
+int run_flag_command(const char* data_path, int flag, int on, int count, char* arguments[]) {
+    unsigned int* accounts;
+    long listed = read_account_list(count, arguments, &accounts);
+    if (listed < 0) return 1;
+    
+    struct account_flags* flags = account_flags_open(data_path, 1);
+    if (flags == NULL) {
+        printf("ERR IO_ERROR could not open the status flags of '%s'\n", data_path);
+        free(accounts);
+        return 1;
+    }
+    
+    long changed = account_flags_set(flags, flag, accounts, listed, on);
+    account_flags_close(flags);
+    free(accounts);
+    
+    printf("OK %ld of %ld accounts changed (%s %s)\n", changed, listed, account_flag_name(flag), on ? "on" : "off");
+    return 0;
+}
+
+/*
+ * PRINT_ACCOUNT_FLAGS
+ * 
+ * Purpose: List the accounts whose flags differ from the defaults
+ * ("version3 flags")
+ * Returns: 1 on success, 0 if the flag file cannot be opened
+ */
+int print_account_flags(const char* data_path, FILE* output_ptr) {
+    struct account_flags* flags = account_flags_open(data_path, 0);
+    if (flags == NULL) {
+        fprintf(output_ptr, "OK 0 (no status flags for '%s')\n", data_path);
+        return access(data_path, F_OK) == 0;
+    }
+    
+    long listed = 0;
+    for (unsigned int acct_num = MIN_ACCOUNT_NUM; acct_num <= MAX_ACCOUNT_NUM; acct_num++) {
+        int frozen = account_flag(flags, acct_num, ACCOUNT_FROZEN);
+        int closed = account_flag(flags, acct_num, ACCOUNT_CLOSED);
+        int overdraft = account_flag(flags, acct_num, ACCOUNT_OVERDRAFT);
+        if (!frozen && !closed && overdraft) continue;
+        
+        fprintf(output_ptr, "%u%s%s%s\n", acct_num, frozen ? " frozen" : "", closed ? " closed" : "",
+                overdraft ? "" : " no-overdraft");
+        listed++;
+    }
+    fprintf(output_ptr, "OK %ld\n", listed);
+    
+    account_flags_close(flags);
+    return 1;
+}
+
+/*
+ * VELOCITY CHECKS
+ * 
+ * Fraud rules of the form "no more than N debits, or $X debited, from
+ * one account in the last hour" are checked on every debit: an update
+ * taking money out or the paying side of a transfer applied by a
+ * session, a balance lowered from the menu, a standing order. The
+ * limits are set with "version3 velocity" and kept in
+ * "<data file>.velocity", which is read when a tracker is opened.
+ * 
+ * Each account has a velocity_window: a ring of VELOCITY_BUCKETS
+ * one-minute buckets, each holding the number and sum of the debits
+ * made in its minute and tagged with that minute's number. A check adds
+ * up the buckets whose minute lies in the last hour and compares the
+ * sums plus the new debit with the limits, so it costs a pass over 60
+ * buckets in memory, with no lock and no system call (the time comes
+ * from the coarse clock, which the vDSO serves from memory). The hour
+ * is measured to the minute: a debit counts for between 59 and 60
+ * minutes.
+ * 
+ * The windows of all accounts live in "<data file>.debits", which every
+ * process maps shared, like the status flags, so a limit counts the
+ * debits of every exec, ingest, service and teller process and of
+ * every single command. Recording a debit takes an open-file-
+ * description lock on the account's window (released by the kernel if
+ * the process dies); a bucket from an older minute is emptied before
+ * its new minute's tag is published, so a check never adds up the
+ * debits of an hour ago.
+ * 
+ * A debit is checked before it is made and recorded after, so two
+ * processes debiting the same account at the same moment can both pass
+ * the check: the limit can be exceeded by the debits in flight at once.
+ */
+
+/*
+ * VELOCITY_RULES_READ
+ * 
+ * Purpose: The velocity limits of a data file
+ * Returns: 1 if it has limits, 0 if not (no limits file, or not one)
+ */
+int velocity_rules_read(const char* data_path, struct velocity_rules* rules) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, VELOCITY_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return 0;
+    
+    FILE* rules_ptr = fopen(path, "rb");
+    if (rules_ptr == NULL) return 0;
+    int ok = fread(rules, sizeof(*rules), 1, rules_ptr) == 1 &&
+             memcmp(rules->magic, VELOCITY_MAGIC, sizeof(rules->magic)) == 0;
+    fclose(rules_ptr);
+    return ok;
+}
+
+/*
+ * VELOCITY_RULES_WRITE
+ * 
+ * Purpose: Set the velocity limits of a data file (rules = NULL removes
+ * them); trackers opened from then on use them
+ * Returns: 1 on success, 0 on failure
+ */
+int velocity_rules_write(const char* data_path, const struct velocity_rules* rules) {
+    char path[1024], temporary[1040];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, VELOCITY_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return 0;
+    if (rules == NULL) return remove(path) == 0 || access(path, F_OK) != 0;
+    
+    // Written aside and renamed, so a session never reads half a file
+    snprintf(temporary, sizeof(temporary), "%s.new", path);
+    struct velocity_rules stored = *rules;
+    memcpy(stored.magic, VELOCITY_MAGIC, sizeof(stored.magic));
+    FILE* rules_ptr = fopen(temporary, "wb");
+    if (rules_ptr == NULL) return 0;
+    int ok = fwrite(&stored, sizeof(stored), 1, rules_ptr) == 1;
+    ok = (fclose(rules_ptr) == 0) && ok;
+    return ok && rename(temporary, path) == 0;
+}
+
+/*
+ * VELOCITY_TRACKER_OPEN
+ * 
+ * Purpose: Read the velocity limits of a data file and map its recent
+ * debits, creating the debits file if needed
+ * Returns: the tracker (release with velocity_tracker_close), or NULL
+ * if the data file has no limits or the debits cannot be mapped
+ */
+struct velocity_tracker* velocity_tracker_open(const char* data_path) {
+    struct velocity_rules rules;
+    if (!velocity_rules_read(data_path, &rules)) return NULL;
+    
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, DEBITS_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return NULL;
+    
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+    
+    // The first opener writes the header; others wait for it on the lock
+    struct stat info;
+    int ok = flock(fd, LOCK_EX) == 0 && fstat(fd, &info) == 0;
+    if (ok && info.st_size == 0) {
+        ok = (ftruncate(fd, sizeof(struct velocity_windows)) == 0);
+    } else if (ok) {
+        ok = (info.st_size == (off_t)sizeof(struct velocity_windows));
+    }
+    
+    struct velocity_windows* shared = NULL;
+    if (ok) {
+        void* mapping = mmap(NULL, sizeof(struct velocity_windows), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        shared = (mapping == MAP_FAILED) ? NULL : mapping;
+    }
+    
+    // All-zero buckets are tagged with minute 0, long out of any window
+    if (shared != NULL && atomic_load_explicit(&shared->ready, memory_order_acquire) != 1) {
+        memcpy(shared->magic, DEBITS_MAGIC, sizeof(shared->magic));
+        shared->max_accounts = MAX_ACCOUNTS;
+        shared->buckets = VELOCITY_BUCKETS;
+        atomic_store_explicit(&shared->ready, 1, memory_order_release);
+    } else if (shared != NULL && (memcmp(shared->magic, DEBITS_MAGIC, sizeof(shared->magic)) != 0 ||
+                                  shared->max_accounts != MAX_ACCOUNTS || shared->buckets != VELOCITY_BUCKETS)) {
+        munmap(shared, sizeof(struct velocity_windows));
+        shared = NULL;
+    }
+    flock(fd, LOCK_UN);
+    
+    struct velocity_tracker* tracker = (shared != NULL) ? calloc(1, sizeof(*tracker)) : NULL;
+    if (tracker == NULL) {
+        if (shared != NULL) munmap(shared, sizeof(struct velocity_windows));
+        close(fd);
+        return NULL;
+    }
+    tracker->rules = rules;
+    tracker->shared = shared;
+    tracker->fd = fd;
+    return tracker;
+}
+
+void velocity_tracker_close(struct velocity_tracker* tracker) {
+    munmap(tracker->shared, sizeof(struct velocity_windows));
+    close(tracker->fd);
+    free(tracker);
+}
+
+/*
+ * VELOCITY_NOW
+ * 
+ * Purpose: Seconds since the epoch, from the coarse clock (a memory
+ * read, accurate to a few milliseconds)
+ */
+long long velocity_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME_COARSE, &now);
+    return (long long)now.tv_sec;
+}
+
+/*
+ * COMMAND_DEBIT_CENTS
+ * 
+ * Purpose: What a command takes out of its account (command->acct_num),
+ * 0 if it takes nothing
+ */
+long long command_debit_cents(const struct command* command) {
+    if (command->type == COMMAND_TRANSFER) return command->cents;
+    if (command->type == COMMAND_UPDATE && command->cents < 0) return -command->cents;
+    return 0;
+}
+
+/*
+ * VELOCITY_WINDOW_SUMS
+ * 
+ * Purpose: Number and sum of the debits in the hour that ends with
+ * bucket number 'bucket'
+ */
+void velocity_window_sums(struct velocity_window* window, long long bucket, long long* debits, long long* cents) {
+    *debits = 0;
+    *cents = 0;
+    for (int slot = 0; slot < VELOCITY_BUCKETS; slot++) {
+        long long number = atomic_load_explicit(&window->bucket_number[slot], memory_order_acquire);
+        if (number > bucket - VELOCITY_BUCKETS && number <= bucket) {
+            *debits += atomic_load_explicit(&window->bucket_debits[slot], memory_order_relaxed);
+            *cents += atomic_load_explicit(&window->bucket_cents[slot], memory_order_relaxed);
+        }
+    }
+}
+
+/*
+ * VELOCITY_CHECK
+ * 
+ * Purpose: Whether 'debits' more debits totalling 'cents' from an
+ * account at time 'now' stay within the limits (more than one when a
+ * batch checks debits it has not recorded yet)
+ * Returns: COMMAND_OK, or COMMAND_VELOCITY described in 'detail'
+ * 
+ * A check records nothing: velocity_record does, once the debit has
+ * been made.
+ */
+int velocity_check(struct velocity_tracker* tracker, unsigned int acct_num, long long debits, long long cents,
+                   long long now, char* detail, size_t size) {
+    tracker->checks++;
+    long long recent_debits, recent_cents;
+    velocity_window_sums(&tracker->shared->windows[acct_num - 1], now / VELOCITY_BUCKET_SECONDS, &recent_debits,
+                         &recent_cents);
+    debits += recent_debits;
+    long long total = cents + recent_cents;
+    
+    const struct velocity_rules* rules = &tracker->rules;
+    if (rules->max_debits > 0 && debits > rules->max_debits) {
+        snprintf(detail, size, "account %u would make %lld debits in an hour (limit %lld)", acct_num, debits,
+                 rules->max_debits);
+    } else if (rules->max_cents > 0 && total > rules->max_cents) {
+        snprintf(detail, size, "account %u would have %.2f debited in an hour (limit %.2f)", acct_num,
+                 total / 100.0, rules->max_cents / 100.0);
+    } else {
+        return COMMAND_OK;
+    }
+    tracker->refusals++;
+    return COMMAND_VELOCITY;
+}
+
+/*
+ * VELOCITY_RECORD
+ * 
+ * Purpose: Count a debit made from an account at time 'now'
+ */
+void velocity_record(struct velocity_tracker* tracker, unsigned int acct_num, long long cents, long long now) {
+    long long bucket = now / VELOCITY_BUCKET_SECONDS;
+    struct velocity_window* window = &tracker->shared->windows[acct_num - 1];
+    
+    // Recorders of the same account, in any process, take turns
+    struct flock range;
+    memset(&range, 0, sizeof(range));
+    range.l_type = F_WRLCK;
+    range.l_whence = SEEK_SET;
+    range.l_start = (off_t)((char*)window - (char*)tracker->shared);
+    range.l_len = (off_t)sizeof(*window);
+#ifdef F_OFD_SETLKW
+    int command = F_OFD_SETLKW;
+#else
+    int command = F_SETLKW;  // Process-wide: threads share these locks
+#endif
+    if (fcntl(tracker->fd, command, &range) != 0) return;  // Unrecorded rather than refused
+    
+    int slot = (int)(bucket % VELOCITY_BUCKETS);
+    if (atomic_load_explicit(&window->bucket_number[slot], memory_order_relaxed) != bucket) {
+        // The slot's old minute is an hour or more ago: empty it before its new tag shows
+        atomic_store_explicit(&window->bucket_debits[slot], 0, memory_order_relaxed);
+        atomic_store_explicit(&window->bucket_cents[slot], 0, memory_order_relaxed);
+        atomic_store_explicit(&window->bucket_number[slot], bucket, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&window->bucket_debits[slot], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&window->bucket_cents[slot], cents, memory_order_relaxed);
+    
+    range.l_type = F_UNLCK;
+    fcntl(tracker->fd, command, &range);
+}
+
+/*
+ * RUN_VELOCITY_COMMAND
+ * 
+ * Purpose: "version3 velocity": show the limits, set them
+ * ("<debits> <amount>", 0 for no limit) or remove them ("off")
+ * Returns: process exit status (0 on success)
+ */
+int run_velocity_command(const char* data_path, int count, char* arguments[]) {
+    struct velocity_rules rules;
+    memset(&rules, 0, sizeof(rules));
+    
+    if (count == 1 && strcmp(arguments[0], "off") == 0) {
+        if (!velocity_rules_write(data_path, NULL)) {
+            printf("ERR IO_ERROR could not remove the velocity limits of '%s'\n", data_path);
+            return 1;
+        }
+        printf("OK no velocity limits\n");
+        return 0;
+    }
+    
+    if (count == 2) {
+        char* end;
+        size_t error_position;
+        rules.max_debits = strtoll(arguments[0], &end, 10);
+        if (*end != '\0' || rules.max_debits < 0 ||
+            parse_amount_cents(arguments[1], strlen(arguments[1]), &rules.max_cents, &error_position) != AMOUNT_OK ||
+            rules.max_cents < 0) {
+            printf("Usage: version3 velocity [<debits> <amount> | off]\n");
+            return 1;
+        }
+        if (!velocity_rules_write(data_path, &rules)) {
+            printf("ERR IO_ERROR could not write the velocity limits of '%s'\n", data_path);
+            return 1;
+        }
+    } else if (count != 0) {
+        printf("Usage: version3 velocity [<debits> <amount> | off]\n");
+        return 1;
+    }
+    
+    if (!velocity_rules_read(data_path, &rules)) {
+        printf("OK no velocity limits\n");
+    } else {
+        printf("OK at most %lld debits and %.2f debited per account per hour (0 = no limit)\n", rules.max_debits,
+               rules.max_cents / 100.0);
+    }
+    return 0;
+}
+
+/*
+ * AUDIT TRAIL
+ * 
+ * Every command a session applies - reads, refusals and failures
+ * included - is recorded as a 32-byte audit_event in
+ * "<data file>.audit". Writing and syncing the file for each command
+ * would cost more than the command itself, so recording is split in
+ * two:
+ * 
+ * - the thread running a session puts the event in its own ring
+ *   (audit_ring, a single-producer/single-consumer queue like the
+ *   ingest pipeline's, but holding the events themselves). That is a
+ *   clock read, a 32-byte copy and one release store: no lock, no
+ *   system call, no cache line shared with other recording threads;
+ * - one writer thread per process (audit_log) wakes every window_ms,
+ *   writes whatever the rings hold straight from ring memory and
+ *   calls fdatasync once for the whole batch.
+ * 
+ * window_ms is the loss window: a crash loses at most the events of
+ * the last window_ms plus one write and sync. "version3
+ * --audit-window <ms>" sets it; 0 makes the writer sync as fast as it
+ * can. Events are never dropped: a thread that finds its ring full
+ * waits for the writer (counted in audit_stats.full_waits).
+ * 
+ * Rings are never unlinked while the log is open. A session that
+ * closes hands its ring back, and the next session to attach takes it
+ * over, so a long-running process with short sessions keeps as many
+ * rings as it ever had sessions open at once.
+ * 
+ * The interactive menu writes its events directly (audit_append): one
+ * teller at human speed does not need the rings.
+ */
+
+/*
+ * AUDIT_LOG_OPEN
+ * 
+ * Purpose: Open a data file's audit trail for appending and start its
+ * writer thread
+ * Returns: the log (stop it with audit_log_close), or NULL on error
+ */
+struct audit_log* audit_log_open(const char* data_path, long window_ms) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, AUDIT_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return NULL;
+    
+    struct audit_log* log = calloc(1, sizeof(struct audit_log));
+    if (log == NULL) return NULL;
+    
+    log->fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    log->window_ms = (window_ms > 0) ? window_ms : 0;
+    log->ok = 1;
+    atomic_init(&log->rings, NULL);
+    if (log->fd < 0 || pthread_create(&log->writer, NULL, audit_writer, log) != 0) {
+        if (log->fd >= 0) close(log->fd);
+        free(log);
+        return NULL;
+    }
+    return log;
+}
+
+/*
+ * AUDIT_LOG_CLOSE
+ * 
+ * Purpose: Write out every recorded event, stop the writer and close
+ * the file. Sessions recording into the log must be closed first.
+ * Returns: 1 if every event was written and synced (also for NULL)
+ */
+int audit_log_close(struct audit_log* log, struct audit_stats* stats) {
+    if (log == NULL) return 1;
+    
+    atomic_store_explicit(&log->stopping, 1, memory_order_release);
+    pthread_join(log->writer, NULL);
+    
+    struct audit_ring* ring = atomic_load_explicit(&log->rings, memory_order_acquire);
+    while (ring != NULL) {
+        struct audit_ring* next = ring->next;
+        log->stats.full_waits += ring->full_waits;
+        free(ring);
+        ring = next;
+    }
+    
+    if (close(log->fd) != 0) log->ok = 0;
+    if (stats != NULL) *stats = log->stats;
+    int ok = log->ok;
+    free(log);
+    return ok;
+}
+
+/*
+ * AUDIT_RING_ATTACH / AUDIT_RING_DETACH
+ * 
+ * Purpose: Take a ring to record into (a returned one if there is
+ * one), and hand it back
+ * Returns: the ring, or NULL if none could be allocated
+ */
+struct audit_ring* audit_ring_attach(struct audit_log* log) {
+    struct audit_ring* ring = atomic_load_explicit(&log->rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        int free_ring = 0;
+        if (atomic_compare_exchange_strong_explicit(&ring->in_use, &free_ring, 1,
+                                                    memory_order_acquire, memory_order_relaxed)) {
+            return ring;
+        }
+    }
+    
+    ring = aligned_alloc(64, sizeof(struct audit_ring));
+    if (ring == NULL) return NULL;
+    memset(ring, 0, sizeof(*ring));
+    ring->id = (unsigned short)(atomic_fetch_add_explicit(&log->ring_count, 1, memory_order_relaxed) + 1);
+    atomic_init(&ring->in_use, 1);
+    
+    // Publish it at the head of the list; the writer picks it up on its next round
+    ring->next = atomic_load_explicit(&log->rings, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&log->rings, &ring->next, ring,
+                                                  memory_order_release, memory_order_relaxed));
+    return ring;
+}
+
+void audit_ring_detach(struct audit_ring* ring) {
+    atomic_store_explicit(&ring->in_use, 0, memory_order_release);
+}
+
+/*
+ * AUDIT_EVENT_FILL
+ * 
+ * Purpose: The event for a finished command (ring and sequence are
+ * left 0)
+ */
+void audit_event_fill(struct audit_event* event, const struct command* command, int status) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    
+    memset(event, 0, sizeof(*event));
+    event->time_ns = (long long)now.tv_sec * 1000000000LL + now.tv_nsec;
+    event->type = (unsigned char)command->type;
+    event->status = (unsigned char)status;
+    event->acct_num = command->acct_num;
+    event->target_acct = command->target_acct;
+    event->cents = command->cents;
+}
+
+/*
+ * AUDIT_RECORD
+ * 
+ * Purpose: Record a finished command in the calling thread's ring,
+ * waiting only if the ring is full
+ */
+void audit_record(struct audit_ring* ring, const struct command* command, int status) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == AUDIT_RING_SIZE) {
+        ring->full_waits++;
+        unsigned int attempts = 0;
+        while (tail - atomic_load_explicit(&ring->head, memory_order_acquire) == AUDIT_RING_SIZE) {
+            ring_backoff(&attempts);
+        }
+    }
+    
+    struct audit_event* event = &ring->events[tail & (AUDIT_RING_SIZE - 1)];
+    audit_event_fill(event, command, status);
+    event->ring = ring->id;
+    event->sequence = ring->sequence++;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+/*
+ * AUDIT_APPEND
+ * 
+ * Purpose: Write one event straight to a data file's audit trail
+ * (ring 0), for callers without an audit_log
+ * Returns: 1 on success, 0 on failure
+ */
+int audit_append(const char* data_path, const struct command* command, int status) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, AUDIT_SUFFIX);
+    if (length <= 0 || (size_t)length >= sizeof(path)) return 0;
+    
+    int fd = open(path, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0) return 0;
+    
+    struct audit_event event;
+    audit_event_fill(&event, command, status);
+    int ok = write(fd, &event, sizeof(event)) == (ssize_t)sizeof(event) && fdatasync(fd) == 0;
+    return (close(fd) == 0) && ok;
+}
+
+/*
+ * AUDIT_LOG_DRAIN
+ * 
+ * Purpose: Write every event waiting in the rings to the audit file
+ * Parameters: oldest_ns - set to the earliest time_ns written (left
+ * alone if nothing was written)
+ * Returns: number of events written
+ * 
+ * A ring's events are written from the ring itself, in at most two
+ * pieces (before and after the wrap), and only then is the room given
+ * back to the recording thread. After a failed write the events are
+ * dropped anyway, so recording threads never wait on a broken disk;
+ * the failure is reported by audit_log_close.
+ */
+long audit_log_drain(struct audit_log* log, long long* oldest_ns) {
+    long drained = 0;
+    struct audit_ring* ring = atomic_load_explicit(&log->rings, memory_order_acquire);
+    for (; ring != NULL; ring = ring->next) {
+        size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+        if (head == tail) continue;
+        
+        long long first_ns = ring->events[head & (AUDIT_RING_SIZE - 1)].time_ns;
+        if (drained == 0 || first_ns < *oldest_ns) *oldest_ns = first_ns;
+        drained += (long)(tail - head);
+        
+        while (head != tail) {
+            size_t start = head & (AUDIT_RING_SIZE - 1);
+            size_t count = tail - head;
+            if (count > AUDIT_RING_SIZE - start) count = AUDIT_RING_SIZE - start;
+            
+            size_t size = count * sizeof(struct audit_event);
+            if (write(log->fd, &ring->events[start], size) != (ssize_t)size) log->ok = 0;
+            log->stats.writes++;
+            head += count;
+        }
+        atomic_store_explicit(&ring->head, head, memory_order_release);
+    }
+    
+    log->stats.events += drained;
+    return drained;
+}
+
+/*
+ * AUDIT_WRITER
+ * 
+ * Purpose: Thread function of an audit_log: drain the rings and sync
+ * the file every window_ms, and a last time once the log is closing
+ */
+void* audit_writer(void* arg) {
+    struct audit_log* log = arg;
+    struct timespec pause = {log->window_ms / 1000, (log->window_ms % 1000) * 1000000L};
+    
+    for (;;) {
+        // Anything recorded before 'stopping' was set is drained below
+        int stopping = atomic_load_explicit(&log->stopping, memory_order_acquire);
+        
+        long long oldest_ns = 0;
+        if (audit_log_drain(log, &oldest_ns) > 0) {
+            if (fdatasync(log->fd) != 0) log->ok = 0;
+            log->stats.syncs++;
+            
+            struct timespec now;
+            clock_gettime(CLOCK_REALTIME, &now);
+            double lag_ms = ((long long)now.tv_sec * 1000000000LL + now.tv_nsec - oldest_ns) / 1e6;
+            if (lag_ms > log->stats.max_lag_ms) log->stats.max_lag_ms = lag_ms;
+        }
+        if (stopping) break;
+        
+        if (log->window_ms > 0) {
+            nanosleep(&pause, NULL);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/*
+ * PRINT_AUDIT_TRAIL
+ * 
+ * Purpose: Print a data file's audit trail, one event per line
+ * ("version3 audit")
+ * Returns: 1 on success, 0 if there is no audit trail
+ */
+int print_audit_trail(const char* data_path, FILE* output_ptr) {
+    char path[1024];
+    int length = snprintf(path, sizeof(path), "%s%s", data_path, AUDIT_SUFFIX);
+    FILE* audit_ptr = (length > 0 && (size_t)length < sizeof(path)) ? fopen(path, "rb") : NULL;
+    if (audit_ptr == NULL) {
+        fprintf(output_ptr, "ERR IO_ERROR no audit trail for '%s'\n", data_path);
+        return 0;
+    }
+    
+    struct audit_event event;
+    long listed = 0;
+    while (fread(&event, sizeof(event), 1, audit_ptr) == 1) {
+        time_t seconds = (time_t)(event.time_ns / 1000000000LL);
+        struct tm local;
+        char when[32];
+        localtime_r(&seconds, &local);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &local);
+        
+        fprintf(output_ptr, "%s.%06lld %u/%u %s %s %u", when, (event.time_ns % 1000000000LL) / 1000,
+                event.ring, event.sequence, command_name(event.type), command_status_name(event.status),
+                event.acct_num);
+        if (event.type == COMMAND_TRANSFER) fprintf(output_ptr, " %u", event.target_acct);
+        if (event.type == COMMAND_CREATE || event.type == COMMAND_UPDATE || event.type == COMMAND_TRANSFER) {
+            fprintf(output_ptr, " %.2f", event.cents / 100.0);
+        }
+        fputc('\n', output_ptr);
+        listed++;
+    }
+    fprintf(output_ptr, "OK %ld\n", listed);
+    
+    fclose(audit_ptr);
+    return 1;
+}
+
+/*
+ * ASYNCHRONOUS CLIENT
+ * 
+ * Programs embedding the account store used to block in every read and
+ * write of the data file. An account_client instead takes requests
+ * (read, update, transfer, or any other command) without blocking and
+ * reports each one back through a callback, so a caller can have
+ * thousands outstanding while one service thread does the work.
+ * 
+ * Submitting pushes the request onto a lock-free stack with a single
+ * compare-and-swap; the request itself is the queue node, so nothing
+ * is allocated. The service thread takes the whole stack at once,
+ * restores submission order and runs the batch on its command session:
+ * reads come from the in-memory account table, writes go to the data
+ * file with compare-on-write, and the history entries of the batch are
+ * flushed together. Callbacks run on the service thread and must not
+ * block; they may submit further requests (e.g. the next step of a
+ * workflow), which is how a chain of operations is written without a
+ * thread per chain.
+ */
+
+/*
+ * ACCOUNT_CLIENT_OPEN
+ * 
+ * Purpose: Open a session on the data file and start the service thread
+ * Returns: 1 on success, 0 on failure
+ */
+int account_client_open(struct account_client* client, const char* data_path, const char* history_path) {
+    memset(client, 0, sizeof(*client));
+    if (!command_session_open(&client->session, data_path, history_path, stderr)) return 0;
+    object_pool_init(&client->requests, sizeof(struct account_request));
+    object_pool_init(&client->buffers, LISTING_SIZE);
+    
+    atomic_init(&client->submitted, NULL);
+    atomic_init(&client->outstanding, 0);
+    pthread_mutex_init(&client->lock, NULL);
+    pthread_cond_init(&client->wake, NULL);
+    pthread_cond_init(&client->idle, NULL);
+    
+    if (pthread_create(&client->service, NULL, account_client_service, client) != 0) {
+        printf("Error: Could not start the account client service thread.\n");
+        object_pool_destroy(&client->requests);
+        object_pool_destroy(&client->buffers);
+        pthread_mutex_destroy(&client->lock);
+        pthread_cond_destroy(&client->wake);
+        pthread_cond_destroy(&client->idle);
+        command_session_close(&client->session);
+        return 0;
+    }
+    return 1;
+}
+
+/*
+ * ACCOUNT_CLIENT_CLOSE
+ * 
+ * Purpose: Finish every outstanding request, then stop the service thread
+ */
+void account_client_close(struct account_client* client) {
+    account_client_drain(client);
+    
+    pthread_mutex_lock(&client->lock);
+    client->stopping = 1;
+    pthread_cond_signal(&client->wake);
+    pthread_mutex_unlock(&client->lock);
+    pthread_join(client->service, NULL);
+    
+    object_pool_destroy(&client->requests);
+    object_pool_destroy(&client->buffers);
+    pthread_mutex_destroy(&client->lock);
+    pthread_cond_destroy(&client->wake);
+    pthread_cond_destroy(&client->idle);
+    command_session_close(&client->session);
+}
+
+/*
+ * ACCOUNT_CLIENT_NEW_REQUEST / ACCOUNT_CLIENT_FREE_REQUEST
+ * 
+ * Purpose: Take a zeroed request from the client's pool / give it back
+ * Parameters:
+ *   - cache: the calling thread's pool cache (0 is the service thread,
+ *     so callbacks free with 0; every other thread needs its own index
+ *     below POOL_CACHES)
+ * Returns (new): the request, or NULL if out of memory
+ * 
+ * The rows of a "list" on a pooled request stay valid until the
+ * request is freed. Requests may be freed on any thread, typically in
+ * their callback.
+ */
+struct account_request* account_client_new_request(struct account_client* client, int cache) {
+    struct account_request* request = object_pool_get(&client->requests, cache);
+    if (request != NULL) {
+        memset(request, 0, sizeof(*request));
+        request->pooled = 1;
+    }
+    return request;
+}
+
+void account_client_free_request(struct account_client* client, int cache, struct account_request* request) {
+    object_pool_put(&client->buffers, cache, request->buffer);
+    object_pool_put(&client->requests, cache, request);
+}
+
+/*
+ * ACCOUNT_CLIENT_SUBMIT
+ * 
+ * Purpose: Queue a request whose command is filled in (from any thread)
+ * 
+ * The request must stay valid until it completes. The rows of a "list"
+ * command (result.listing) are only valid inside the callback, unless
+ * the request came from account_client_new_request.
+ */
+void account_client_submit(struct account_client* client, struct account_request* request) {
+    memset(&request->result, 0, sizeof(request->result));
+    atomic_store_explicit(&request->finished, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&client->outstanding, 1, memory_order_relaxed);
+    
+    struct account_request* head = atomic_load_explicit(&client->submitted, memory_order_relaxed);
+    do {
+        request->next = head;
+    } while (!atomic_compare_exchange_weak_explicit(&client->submitted, &head, request,
+                                                    memory_order_release, memory_order_relaxed));
+    
+    // Only the request that made the queue non-empty has to wake the service thread
+    if (head == NULL) {
+        pthread_mutex_lock(&client->lock);
+        pthread_cond_signal(&client->wake);
+        pthread_mutex_unlock(&client->lock);
+    }
+}
+
+/*
+ * ACCOUNT_CLIENT_READ / _UPDATE / _TRANSFER
+ * 
+ * Purpose: Fill in a request for one operation and submit it
+ */
+void account_client_read(struct account_client* client, struct account_request* request, unsigned int acct_num,
+                         account_callback done, void* context) {
+    memset(&request->command, 0, sizeof(request->command));
+    request->command.type = COMMAND_READ;
+    request->command.acct_num = acct_num;
+    request->done = done;
+    request->context = context;
+    account_client_submit(client, request);
+}
+
+void account_client_update(struct account_client* client, struct account_request* request, unsigned int acct_num,
+                           long long cents, account_callback done, void* context) {
+    memset(&request->command, 0, sizeof(request->command));
+    request->command.type = COMMAND_UPDATE;
+    request->command.acct_num = acct_num;
+    request->command.cents = cents;
+    request->done = done;
+    request->context = context;
+    account_client_submit(client, request);
+}
+
+void account_client_transfer(struct account_client* client, struct account_request* request,
+                             unsigned int from_acct, unsigned int to_acct, long long cents,
+                             account_callback done, void* context) {
+    memset(&request->command, 0, sizeof(request->command));
+    request->command.type = COMMAND_TRANSFER;
+    request->command.acct_num = from_acct;
+    request->command.target_acct = to_acct;
+    request->command.cents = cents;
+    request->done = done;
+    request->context = context;
+    account_client_submit(client, request);
+}
+
+/*
+ * ACCOUNT_CLIENT_DRAIN
+ * 
+ * Purpose: Wait until every submitted request has completed (not from
+ * a callback)
+ */
+void account_client_drain(struct account_client* client) {
+    pthread_mutex_lock(&client->lock);
+    while (atomic_load_explicit(&client->outstanding, memory_order_acquire) > 0) {
+        pthread_cond_wait(&client->idle, &client->lock);
+    }
+    pthread_mutex_unlock(&client->lock);
+}
+
+/*
+ * ACCOUNT_CLIENT_SERVICE
+ * 
+ * Purpose: Service thread - run queued requests in batches until stopped
+ */
+void* account_client_service(void* arg) {
+    struct account_client* client = arg;
+    
+    for (;;) {
+        struct account_request* batch = atomic_exchange_explicit(&client->submitted, NULL, memory_order_acquire);
+        if (batch == NULL) {
+            pthread_mutex_lock(&client->lock);
+            while (atomic_load_explicit(&client->submitted, memory_order_relaxed) == NULL && !client->stopping) {
+                pthread_cond_wait(&client->wake, &client->lock);
+            }
+            int stop = client->stopping && atomic_load_explicit(&client->submitted, memory_order_relaxed) == NULL;
+            pthread_mutex_unlock(&client->lock);
+            if (stop) break;
+            continue;
+        }
+        
+        // The stack hands the requests back newest first
+        struct account_request* ordered = NULL;
+        while (batch != NULL) {
+            struct account_request* next = batch->next;
+            batch->next = ordered;
+            ordered = batch;
+            batch = next;
+        }
+        client->batches++;
+        
+        long finished = 0;
+        while (ordered != NULL) {
+            struct account_request* request = ordered;
+            ordered = request->next;  // The callback may reuse the request
+            
+            struct command_result* result = &request->result;
+            result->arena = &client->session.arena;
+            if (request->command.type == COMMAND_LIST && request->pooled) {
+                if (request->buffer == NULL) request->buffer = object_pool_get(&client->buffers, 0);
+                result->listing = request->buffer;
+            } else if (request->command.type == COMMAND_LIST) {
+                result->listing = object_pool_get(&client->buffers, 0);
+            }
+            result->status = validate_command(&request->command, result);
+            if (result->status == COMMAND_OK) result->status = apply_command(&client->session, &request->command, result);
+            log_command_history(&client->session, &request->command, result);
+            client->session.executed++;
+            if (result->status != COMMAND_OK) client->session.failed++;
+            
+            // Neither may be touched after the callback, which may free or resubmit the request
+            char* buffer = request->pooled ? NULL : result->listing;
+            if (request->done != NULL) {
+                request->done(request, request->context);
+            } else {
+                if (buffer != NULL) result->listing = NULL;
+                atomic_store_explicit(&request->finished, 1, memory_order_release);
+            }
+            object_pool_put(&client->buffers, 0, buffer);
+            arena_reset(&client->session.arena);
+            finished++;
+        }
+        fflush(client->session.history_ptr);
+        client->completed += finished;
+        
+        if (atomic_fetch_sub_explicit(&client->outstanding, finished, memory_order_acq_rel) == finished) {
+            pthread_mutex_lock(&client->lock);
+            pthread_cond_broadcast(&client->idle);
+            pthread_mutex_unlock(&client->lock);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * RUN_BATCH_COMMAND
+ * 
+ * Purpose: Dispatch a non-interactive command given on the command line
+ * Returns: process exit status (0 on success)
+ */
+int run_batch_command(int argc, char* argv[]) {
+    const char* data_path = DATA_FILE;
+    long audit_window_ms = AUDIT_WINDOW_MS;
+    while (argc > 3 && (strcmp(argv[1], "--data") == 0 || strcmp(argv[1], "--audit-window") == 0)) {
+        if (strcmp(argv[1], "--data") == 0) {
+            data_path = argv[2];
+        } else {
+            audit_window_ms = atol(argv[2]);
+        }
+        argc -= 2;
+        argv += 2;  // argv[1] is the command again
+    }
+    
+    // Commands that change accounts are audited
+    int audited = strcmp(argv[1], "exec") == 0 || strcmp(argv[1], "ingest") == 0 ||
+                  strcmp(argv[1], "run-orders") == 0 || command_type(argv[1], strlen(argv[1])) != 0;
+    struct audit_log* audit = audited ? audit_log_open(data_path, audit_window_ms) : NULL;
+    if (audited && audit == NULL) {
+        printf("Error: Could not open the audit trail of '%s'\n", data_path);
+        return 1;
+    }
+    
+    if (strcmp(argv[1], "exec") == 0) {
+        FILE* script_ptr = (argc > 2 && strcmp(argv[2], "-") != 0) ? fopen(argv[2], "r") : stdin;
+        if (script_ptr == NULL) {
+            printf("Error: Could not open script '%s'\n", argv[2]);
+            audit_log_close(audit, NULL);
+            return 1;
+        }
+        
+        setvbuf(stdout, NULL, _IOFBF, COMMAND_OUTPUT_BUFFER);
+        long failed = run_command_script(script_ptr, data_path, HISTORY_FILE, stdout, 1, audit);
+        if (script_ptr != stdin) fclose(script_ptr);
+        if (!audit_log_close(audit, NULL)) fprintf(stderr, "Error: Could not write the audit trail\n");
+        return (failed == 0) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "ingest") == 0) {
+        FILE* script_ptr = (argc > 2 && strcmp(argv[2], "-") != 0) ? fopen(argv[2], "r") : stdin;
+        if (script_ptr == NULL) {
+            printf("Error: Could not open script '%s'\n", argv[2]);
+            audit_log_close(audit, NULL);
+            return 1;
+        }
+        
+        setvbuf(stdout, NULL, _IOFBF, COMMAND_OUTPUT_BUFFER);
+        struct stage_stats stats[INGEST_STAGES];
+        long failed = run_ingest_pipeline(script_ptr, data_path, HISTORY_FILE, stdout, 1, audit, stats);
+        if (script_ptr != stdin) fclose(script_ptr);
+        struct audit_stats audit_stats;
+        int audit_ok = audit_log_close(audit, &audit_stats);
+        if (failed < 0) return 1;
+        
+        // Counters go to stderr so stdout stays a clean answer stream
+        for (int i = 0; i < INGEST_STAGES; i++) {
+            fprintf(stderr, "%-9s %9ld commands in %.3f s (%.0f/sec), waited %ld times on a full ring, %ld on an empty one\n",
+                    stats[i].name, stats[i].items, stats[i].seconds,
+                    stats[i].seconds > 0 ? stats[i].items / stats[i].seconds : 0.0,
+                    stats[i].full_waits, stats[i].empty_waits);
+        }
+        fprintf(stderr, "audit     %9ld events in %ld writes and %ld syncs, at most %.1f ms from command to disk%s\n",
+                audit_stats.events, audit_stats.writes, audit_stats.syncs, audit_stats.max_lag_ms,
+                audit_ok ? "" : " (FAILED)");
+        return (failed == 0) ? 0 : 1;
+    }
+    
+    if (command_type(argv[1], strlen(argv[1])) != 0) {
+        // Rebuild the command line from the arguments
+        char line[MAX_COMMAND_LINE] = "";
+        size_t length = 0;
+        for (int i = 1; i < argc; i++) {
+            int written = snprintf(line + length, sizeof(line) - length, "%s%s", (i > 1) ? " " : "", argv[i]);
+            if (written < 0 || (size_t)written >= sizeof(line) - length) {
+                printf("ERR BAD_SYNTAX command too long\n");
+                audit_log_close(audit, NULL);
+                return 1;
+            }
+            length += written;
+        }
+        
+        struct command_session session;
+        int status = COMMAND_IO_ERROR;
+        if (command_session_open(&session, data_path, HISTORY_FILE, stdout)) {
+            command_session_publish_view(&session, data_path);  // Best effort
+            command_session_audit(&session, audit);
+            status = execute_command_line(&session, line, length);
+            command_session_close(&session);
+        }
+        if (!audit_log_close(audit, NULL)) fprintf(stderr, "Error: Could not write the audit trail\n");
+        return (status == COMMAND_OK) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "run-orders") == 0) {
+        struct order_summary summary;
+        long executed = run_standing_orders(data_path, HISTORY_FILE, (long long)time(NULL), audit, stdout, &summary);
+        int audit_ok = audit_log_close(audit, NULL);
+        
+        printf("Made %ld of %ld due standing orders ($%.2f, %ld refused) in %ld batches in %.3f s (%.0f orders/sec)\n",
+               summary.executed, summary.due, summary.cents / 100.0, summary.refused, summary.batches,
+               summary.seconds, summary.seconds > 0 ? summary.due / summary.seconds : 0.0);
+        if (summary.next_due > 0) {
+            time_t when = (time_t)summary.next_due;
+            struct tm local;
+            char due[32];
+            localtime_r(&when, &local);
+            strftime(due, sizeof(due), "%Y-%m-%d %H:%M:%S", &local);
+            printf("Next order due %s (%ld active)\n", due, summary.orders);
+        }
+        if (!audit_ok) fprintf(stderr, "Error: Could not write the audit trail\n");
+        return (executed < 0) ? 1 : 0;
+    }
+    
+    if (strcmp(argv[1], "order") == 0 && argc > 5) {
+        struct standing_order order;
+        memset(&order, 0, sizeof(order));
+        struct command command = {.type = COMMAND_TRANSFER};
+        struct command_result result;
+        memset(&result, 0, sizeof(result));
+        size_t error_position;
+        command.acct_num = (unsigned int)strtoul(argv[2], NULL, 10);
+        command.target_acct = (unsigned int)strtoul(argv[3], NULL, 10);
+        if (parse_amount_cents(argv[4], strlen(argv[4]), &command.cents, &error_position) != AMOUNT_OK ||
+            !parse_order_interval(argv[5], &order.interval)) {
+            printf("Usage: version3 order <from> <to> <amount> <every: 12h, 1d, 2w...> [<times>]\n");
+            return 1;
+        }
+        int status = validate_command(&command, &result);
+        if (status != COMMAND_OK) {
+            printf("ERR %s %s\n", command_status_name(status), result.detail);
+            return 1;
+        }
+        
+        order.from_acct = command.acct_num;
+        order.to_acct = command.target_acct;
+        order.cents = command.cents;
+        order.next_due = (long long)time(NULL);  // First due at the next run
+        order.remaining = (argc > 6 && atol(argv[6]) > 0) ? atol(argv[6]) : ORDER_UNTIL_CANCELLED;
+        long id = add_standing_orders(data_path, &order, 1);
+        if (id < 0) {
+            printf("ERR IO_ERROR could not write the standing orders of '%s'\n", data_path);
+            return 1;
+        }
+        printf("OK order %ld: %u -> %u %.2f every %s\n", id, order.from_acct, order.to_acct, order.cents / 100.0,
+               argv[5]);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "orders") == 0) {
+        return print_standing_orders(data_path, stdout) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "cancel-order") == 0 && argc > 2) {
+        if (!cancel_standing_order(data_path, (unsigned int)strtoul(argv[2], NULL, 10))) {
+            printf("ERR NOT_FOUND no active order %s\n", argv[2]);
+            return 1;
+        }
+        printf("OK order %s cancelled\n", argv[2]);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "view") == 0) {
+        unsigned int acct_num = (argc > 2) ? (unsigned int)strtoul(argv[2], NULL, 10) : 0;
+        return print_shared_view(data_path, acct_num, stdout) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "migrate") == 0) {
+        struct schema_migrator migrator;
+        long batch = (argc > 2) ? atol(argv[2]) : 0;
+        long pause_ms = (argc > 3) ? atol(argv[3]) : 0;
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (!schema_migrator_start(&migrator, data_path, batch, pause_ms)) return 1;
+        schema_migrator_join(&migrator);
+        
+        printf("Upgraded %ld records in %ld passes (%ld retried after a conflict) in %.3f s\n",
+               migrator.migrated, migrator.passes, migrator.conflicts, elapsed_seconds(&start));
+        if (!migrator.ok) printf("Error: Could not migrate '%s'\n", data_path);
+        return migrator.ok ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "details") == 0 && argc > 2) {
+        unsigned int acct_num = (unsigned int)strtoul(argv[2], NULL, 10);
+        FILE* file_ptr = validate_account_number(acct_num) ? fopen(data_path, "rb") : NULL;
+        if (file_ptr == NULL) {
+            printf("ERR BAD_ACCOUNT no such account\n");
+            return 1;
+        }
+        FILE* extension_ptr = open_extension_file(data_path, 0);
+        struct client_data client;
+        struct client_extension extension;
+        int found = read_client_extended(file_ptr, extension_ptr, acct_num - 1, &client, &extension) &&
+                    client.acct_num != 0;
+        if (extension_ptr != NULL) fclose(extension_ptr);
+        fclose(file_ptr);
+        if (!found) {
+            printf("ERR NOT_FOUND account %u does not exist\n", acct_num);
+            return 1;
+        }
+        
+        static const char* statuses[] = {"active", "dormant", "closed"};
+        printf("OK %u %s %s %.2f format=%s status=%s currency=%.3s opened=%d overdraft_limit=%.2f\n",
+               client.acct_num, client.last_name, client.first_name, client.balance,
+               client.format == RECORD_FORMAT_EXTENDED ? "extended" : "base",
+               extension.status <= ACCOUNT_STATUS_CLOSED ? statuses[extension.status] : "unknown",
+               extension.currency, extension.open_date, extension.overdraft_limit_cents / 100.0);
+        return 0;
+    }
+    
+    if ((strcmp(argv[1], "freeze") == 0 || strcmp(argv[1], "unfreeze") == 0) && argc > 2) {
+        return run_flag_command(data_path, ACCOUNT_FROZEN, argv[1][0] == 'f', argc - 2, argv + 2);
+    }
+    
+    if (strcmp(argv[1], "flag") == 0 && argc > 4) {
+        int flag = 0;
+        while (flag < ACCOUNT_FLAG_COUNT && strcmp(argv[2], account_flag_name(flag)) != 0) flag++;
+        int on = (strcmp(argv[3], "on") == 0);
+        if (flag == ACCOUNT_FLAG_COUNT || (!on && strcmp(argv[3], "off") != 0)) {
+            printf("Usage: version3 flag <frozen|closed|overdraft> <on|off> <account>... | -\n");
+            return 1;
+        }
+        return run_flag_command(data_path, flag, on, argc - 4, argv + 4);
+    }
+    
+    if (strcmp(argv[1], "flags") == 0) {
+        return print_account_flags(data_path, stdout) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "velocity") == 0) {
+        return run_velocity_command(data_path, argc - 2, argv + 2);
+    }
+    
+    if (strcmp(argv[1], "audit") == 0) {
+        return print_audit_trail(data_path, stdout) ? 0 : 1;
+    }
+    
+    if (strcmp(argv[1], "statements") == 0) {
+        const char* output_path = (argc > 2) ? argv[2] : STATEMENT_FILE;
+        struct batch_stats stats;
+        long count = generate_statements(data_path, HISTORY_FILE, output_path, &stats);
+        if (count < 0) return 1;
+        
+        // Report on stderr so "-" output stays a clean statement stream
+        fprintf(stderr, "Statements written: %ld in %.3f s (%.0f statements/sec)\n",
+                stats.records, stats.seconds,
+                stats.seconds > 0 ? stats.records / stats.seconds : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "import") == 0 && argc > 2) {
+        int threads = (argc > 3) ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        struct batch_stats stats;
+        if (import_clients_text(argv[2], data_path, threads, stdout, &stats) < 0) return 1;
+        
+        printf("Imported %ld records (%ld rows rejected) in %.3f s (%.0f rows/sec)\n",
+               stats.records, stats.rejected, stats.seconds,
+               stats.seconds > 0 ? stats.records / stats.seconds : 0.0);
+        printf("Parser temporaries: %ld arena allocations, %ld malloc calls\n", stats.allocations, stats.mallocs);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "report") == 0) {
+        int threads = (argc > 2) ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        struct account_summary summary;
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long scanned = summarize_accounts(data_path, threads, &summary);
+        if (scanned < 0) return 1;
+        double seconds = elapsed_seconds(&start);
+        
+        printf("Accounts:      %ld\n", summary.accounts);
+        printf("Overdrawn:     %ld\n", summary.overdrawn);
+        printf("Total balance: $%.2f\n", summary.total_cents / 100.0);
+        printf("Scanned %ld records in %.3f s (%.0f records/sec)\n",
+               scanned, seconds, seconds > 0 ? scanned / seconds : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "interest") == 0 && argc > 2) {
+        struct interest_tiers tiers;
+        if (!parse_interest_tiers(argc - 2, argv + 2, &tiers)) {
+            printf("Usage: version3 interest <rate%%> [<balance>:<rate%%>]... (at most %d tiers)\n",
+                   INTEREST_MAX_TIERS);
+            return 1;
+        }
+        
+        struct interest_summary summary;
+        long scanned = accrue_interest(data_path, HISTORY_FILE, (int)sysconf(_SC_NPROCESSORS_ONLN), &tiers, &summary);
+        printf("Credited $%.2f of interest to %ld accounts (%ld records scanned, %ld grains skipped) "
+               "in %.3f s (%.0f records/sec)\n",
+               summary.interest_cents / 100.0, summary.accounts, summary.records, summary.grains_skipped,
+               summary.seconds, summary.seconds > 0 ? summary.records / summary.seconds : 0.0);
+        if (scanned < 0) printf("Error: The interest run did not complete\n");
+        return (scanned < 0) ? 1 : 0;
+    }
+    
+    if (strcmp(argv[1], "fees") == 0 && argc > 2) {
+        int rebuild = (strcmp(argv[2], "--rebuild") == 0);
+        struct overdraft_fees fees;
+        if (!parse_overdraft_fees(argc - 2 - rebuild, argv + 2 + rebuild, &fees)) {
+            printf("Usage: version3 fees [--rebuild] <fee> [<rate%%> [<cap>]]\n");
+            return 1;
+        }
+        
+        printf("%-6s %-15s %-10s %12s %10s %12s\n", "Acct#", "Last Name", "First Name", "Balance", "Fee", "New Balance");
+        printf("====================================================================\n");
+        struct overdraft_summary summary;
+        long charged = charge_overdraft_fees(data_path, HISTORY_FILE, &fees, rebuild, stdout, &summary);
+        printf("====================================================================\n");
+        printf("Charged $%.2f of fees to %ld overdrawn accounts; $%.2f is now overdrawn\n",
+               summary.fee_cents / 100.0, summary.charged, summary.overdrawn_cents / 100.0);
+        printf("Index: %ld candidates, %ld no longer overdrawn, %ld closed%s, in %.3f s\n", summary.candidates,
+               summary.cleared, summary.skipped, summary.rebuilt ? ", rebuilt with a scan" : "", summary.seconds);
+        if (charged < 0) printf("Error: The overdraft run did not complete\n");
+        return (charged < 0) ? 1 : 0;
+    }
+    
+    if (strcmp(argv[1], "build-store") == 0 && argc > 2) {
+        int encode_names = (strcmp(argv[2], "--names") == 0);
+        if (encode_names && argc < 4) {
+            printf("Usage: version3 build-store [--names] <file> [store]\n");
+            return 1;
+        }
+        const char* text_path = argv[2 + encode_names];
+        const char* store_path = (argc > 3 + encode_names) ? argv[3 + encode_names] : STORE_FILE;
+        struct batch_stats stats;
+        long stored = build_store_file(text_path, store_path, (int)sysconf(_SC_NPROCESSORS_ONLN),
+                                       encode_names, stdout, &stats);
+        if (stored < 0) return 1;
+        
+        printf("Stored %ld records in '%s' (%ld rows rejected) in %.3f s (%.0f rows/sec)\n",
+               stats.records, store_path, stats.rejected, stats.seconds,
+               stats.seconds > 0 ? stats.records / stats.seconds : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(argv[1], "last-names") == 0 || (strcmp(argv[1], "find-name") == 0 && argc > 2)) {
+        int grouping = (argv[1][0] == 'l');
+        const char* store_path = (argc > 3 - grouping) ? argv[3 - grouping] : STORE_FILE;
+        struct store_file store;
+        if (!store_file_open(&store, store_path)) {
+            printf("Error: '%s' is not a store file\n", store_path);
+            return 1;
+        }
+        
+        struct timespec start;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        long count = 0;
+        if (grouping) {
+            struct name_dictionary groups;
+            long* counts = name_dictionary_init(&groups) ? store_file_group_last_names(&store, &groups) : NULL;
+            for (unsigned int id = 0; counts != NULL && id < groups.count; id++) {
+                printf("%8ld %s\n", counts[id], name_text(&groups, id));
+            }
+            count = (counts != NULL) ? (long)groups.count : -1;
+            free(counts);
+            name_dictionary_free(&groups);
+        } else {
+            long found = store_file_find_last_name(&store, argv[2], NULL, 0);
+            struct client_data* matches = malloc((found > 0 ? found : 1) * sizeof(struct client_data));
+            count = (matches != NULL) ? store_file_find_last_name(&store, argv[2], matches, found) : -1;
+            for (long i = 0; i < count; i++) {
+                printf("%u %s %s %.2f\n", matches[i].acct_num, matches[i].last_name,
+                       matches[i].first_name, matches[i].balance);
+            }
+            free(matches);
+        }
+        double seconds = elapsed_seconds(&start);
+        
+        fprintf(stderr, "%ld %s from %llu records (%s store) in %.3f s\n", count,
+                grouping ? "last names" : "accounts", store.header.record_count,
+                store.header.record_format == STORE_FORMAT_NAMES ? "dictionary-encoded" : "plain", seconds);
+        store_file_close(&store);
+        return (count >= 0) ? 0 : 1;
+    }
+    
+    printf("Unknown command '%s'\n", argv[1]);
+    return 1;
+}
+
+/*
+ * DEMONSTRATION FUNCTION
+ * 
+ * Purpose: Show CRUD operations in action with sample data
+ */
+void demonstrate_crud_operations(void) {
+    printf("\n1. Creating Sample Accounts (CREATE):\n");
+    
+    // Sample data for demonstration
+    struct sample_account {
+        unsigned int acct_num;
+        const char* last_name;
+        const char* first_name;
+        double balance;
+    } samples[] = {
+        {1, "Smith", "John", 1500.75},
+        {5, "Johnson", "Mary", -250.50},
+        {10, "Williams", "Bob", 3200.00},
+        {25, "Davis", "Alice", 0.00}
+    };
+    
+    int num_samples = sizeof(samples) / sizeof(samples[0]);
+    
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) return;
+    
+    for (int i = 0; i < num_samples; i++) {
+        struct client_data client;
+        initialize_client(&client, samples[i].acct_num, samples[i].last_name,
+                         samples[i].first_name, samples[i].balance);
+        
+        int position = samples[i].acct_num - 1;
+        if (write_client_to_file(file_ptr, &client, position)) {
+            printf("✅ Created account #%u for %s %s\n", 
+                   client.acct_num, client.first_name, client.last_name);
+        }
+    }
+    
+    close_data_file(file_ptr);
+    
+    printf("\n2. Reading Account Information (READ):\n");
+    file_ptr = open_data_file("rb");
+    if (file_ptr != NULL) {
+        struct client_data client;
+        if (read_client_from_file(file_ptr, &client, 0) && client.acct_num != 0) {
+            printf("Account #1 details:\n");
+            display_client(&client);
+        }
+        close_data_file(file_ptr);
+    }
+    
+    printf("\n3. Updating Account Balance (UPDATE):\n");
+    file_ptr = open_data_file("rb+");
+    if (file_ptr != NULL) {
+        struct client_data client;
+        if (read_client_from_file(file_ptr, &client, 4) && client.acct_num != 0) {
+            printf("Before update:\n");
+            display_client(&client);
+            
+            // Simulate a deposit
+            client.balance += 500.0;
+            
+            if (write_client_to_file(file_ptr, &client, 4)) {
+                log_transaction(client.acct_num, 500.0, client.balance);
+                printf("After $500 deposit:\n");
+                display_client(&client);
+            }
+        }
+        close_data_file(file_ptr);
+    }
+    
+    printf("\n4. Displaying All Accounts:\n");
+    display_all_accounts();
+    
+    printf("\n5. Account Existence Check:\n");
+    printf("Account #1 exists: %s\n", account_exists(1) ? "Yes" : "No");
+    printf("Account #50 exists: %s\n", account_exists(50) ? "Yes" : "No");
+}
+
+/*
+ * TESTING FUNCTIONS
+ * Unit tests for CRUD operations
+ */
+
+/*
+ * WRITE_TEST_DATA_FILE
+ * 
+ * Purpose: Create a data file of MAX_ACCOUNTS empty records with
+ * 'accounts' at the positions their account numbers give them
+ * Returns: 1 on success, 0 if the file could not be written
+ */
+int write_test_data_file(const char* path, const struct client_data* accounts, int count) {
+    struct client_data records[MAX_ACCOUNTS];
+    memset(records, 0, sizeof(records));
+    for (int i = 0; i < count; i++) {
+        if (!validate_account_number(accounts[i].acct_num)) return 0;
+        records[accounts[i].acct_num - 1] = accounts[i];
+    }
+    
+    FILE* file_ptr = fopen(path, "wb");
+    if (file_ptr == NULL) return 0;
+    int written = fwrite(records, RECORD_SIZE, MAX_ACCOUNTS, file_ptr) == MAX_ACCOUNTS;
+    return (fclose(file_ptr) == 0) && written;
+}
+
+int test_crud_operations(void) {
+    printf("Test 1: CRUD Operations... ");
+    
+    // Test CREATE
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) {
+        printf("FAILED - Could not open file\n");
+        return 0;
+    }
+    
+    struct client_data test_client;
+    initialize_client(&test_client, 99, "TestLast", "TestFirst", 100.0);
+    
+    if (!write_client_to_file(file_ptr, &test_client, 98)) {
+        printf("FAILED - Could not create record\n");
+        close_data_file(file_ptr);
+        return 0;
+    }
+    
+    // Test READ
+    struct client_data read_client;
+    if (!read_client_from_file(file_ptr, &read_client, 98)) {
+        printf("FAILED - Could not read record\n");
+        close_data_file(file_ptr);
+        return 0;
+    }
+    
+    // Test UPDATE
+    read_client.balance += 50.0;
+    if (!write_client_to_file(file_ptr, &read_client, 98)) {
+        printf("FAILED - Could not update record\n");
+        close_data_file(file_ptr);
+        return 0;
+    }
+    
+    // Test DELETE (write empty record)
+    struct client_data empty_client = CLIENT_RECORD(0, "", "", 0.0);
+    if (!write_client_to_file(file_ptr, &empty_client, 98)) {
+        printf("FAILED - Could not delete record\n");
+        close_data_file(file_ptr);
+        return 0;
+    }
+    
+    close_data_file(file_ptr);
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_input_validation(void) {
+    printf("Test 2: Input Validation... ");
+    
+    // Test account number validation
+    if (!validate_account_number(50) || validate_account_number(0) || validate_account_number(101)) {
+        printf("FAILED - Account number validation\n");
+        return 0;
+    }
+    
+    // Test name validation
+    if (!validate_name("Smith") || validate_name("") || validate_name("123")) {
+        printf("FAILED - Name validation\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_account_management(void) {
+    printf("Test 3: Account Management... ");
+    
+    // Create test account
+    FILE* file_ptr = open_data_file("rb+");
+    if (file_ptr == NULL) {
+        printf("FAILED - Could not open file\n");
+        return 0;
+    }
+    
+    struct client_data test_account = CLIENT_RECORD(77, "Manager", "Test", 200.0);
+    write_client_to_file(file_ptr, &test_account, 76);
+    close_data_file(file_ptr);
+    
+    // Test account_exists function
+    if (!account_exists(77)) {
+        printf("FAILED - account_exists returned false for existing account\n");
+        return 0;
+    }
+    
+    if (account_exists(88)) {  // Should not exist
+        printf("FAILED - account_exists returned true for non-existing account\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_statement_generation(void) {
+    printf("Test 4: Statement Generation... ");
+    
+    // Two active accounts with an empty slot between them
+    FILE* data_ptr = fopen("test_statements.dat", "wb");
+    FILE* history_ptr = fopen("test_history.dat", "wb");
+    if (data_ptr == NULL || history_ptr == NULL) {
+        printf("FAILED - Could not create test files\n");
+        if (data_ptr) fclose(data_ptr);
+        if (history_ptr) fclose(history_ptr);
+        return 0;
+    }
+    
+    struct client_data clients[3];
+    memset(clients, 0, sizeof(clients));
+    initialize_client(&clients[0], 1, "First", "Client", 100.0);
+    initialize_client(&clients[2], 3, "Third", "Client", -25.0);
+    fwrite(clients, RECORD_SIZE, 3, data_ptr);
+    
+    struct transaction_record entries[2] = {
+        {3, (long long)time(NULL), -50.0, 25.0},
+        {3, (long long)time(NULL), -50.0, -25.0}
+    };
+    fwrite(entries, sizeof(struct transaction_record), 2, history_ptr);
+    fclose(data_ptr);
+    fclose(history_ptr);
+    
+    long count = generate_statements("test_statements.dat", "test_history.dat", "test_statements.txt", NULL);
+    
+    // Account 3's statement must list both transactions
+    int transactions = 0;
+    char line[128];
+    FILE* output_ptr = fopen("test_statements.txt", "r");
+    while (output_ptr != NULL && fgets(line, sizeof(line), output_ptr) != NULL) {
+        if (strstr(line, "-50.00") != NULL) transactions++;
+    }
+    if (output_ptr) fclose(output_ptr);
+    
+    remove("test_statements.dat");
+    remove("test_history.dat");
+    remove("test_statements.txt");
+    
+    if (count != 2 || transactions != 2) {
+        printf("FAILED - Expected 2 statements with 2 transactions, got %ld and %d\n", count, transactions);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_bulk_import(void) {
+    printf("Test 5: Bulk Import... ");
+    
+    FILE* text_ptr = fopen("test_import.txt", "w");
+    if (text_ptr == NULL) {
+        printf("FAILED - Could not create import file\n");
+        return 0;
+    }
+    fprintf(text_ptr, "100 Jones      900.00\r\n");
+    fprintf(text_ptr, "200 Banco      -211.5\r\n"); // Line 2: past the last account
+    fprintf(text_ptr, "\r\n");                     // Blank line is skipped
+    fprintf(text_ptr, "30 Camilo      abc\r\n");   // Line 4: bad balance
+    fprintf(text_ptr, "100,Again,1.00\r\n");       // Line 5: duplicate account
+    fprintf(text_ptr, "4,Smith, 12");                // Last line without newline
+    fclose(text_ptr);
+    
+    // Account 4 already exists, and an edit of it is in progress
+    struct client_data existing;
+    memset(&existing, 0, sizeof(existing));
+    initialize_client(&existing, 4, "Smyth", "Anna", 10.0);
+    existing.version = 7;
+    if (!write_test_data_file("test_import.dat", &existing, 1)) {
+        printf("FAILED - Could not create data file\n");
+        remove("test_import.txt");
+        return 0;
+    }
+    
+    struct batch_stats stats;
+    FILE* report_ptr = tmpfile();
+    long imported = import_clients_text("test_import.txt", "test_import.dat", 2, report_ptr, &stats);
+    
+    char report[128] = "";
+    if (report_ptr != NULL) {
+        rewind(report_ptr);
+        size_t length = fread(report, 1, sizeof(report) - 1, report_ptr);
+        report[length] = '\0';
+        fclose(report_ptr);
+    }
+    
+    struct client_data client;
+    int correct = 0;
+    FILE* data_ptr = fopen("test_import.dat", "rb");
+    if (data_ptr != NULL) {
+        fseek(data_ptr, 99 * RECORD_SIZE, SEEK_SET);
+        correct = (fread(&client, RECORD_SIZE, 1, data_ptr) == 1 &&
+                   client.acct_num == 100 && strcmp(client.last_name, "Jones") == 0 &&
+                   client.balance == 900.00);
+        fseek(data_ptr, 3 * RECORD_SIZE, SEEK_SET);
+        correct = correct && (fread(&client, RECORD_SIZE, 1, data_ptr) == 1 && client.acct_num == 4 &&
+                              strcmp(client.last_name, "Smith") == 0 && client.version == 8);
+        fclose(data_ptr);
+    }
+    
+    // The edit started before the import must not overwrite it
+    data_ptr = fopen("test_import.dat", "rb+");
+    if (data_ptr != NULL) {
+        struct client_data edited = existing;
+        edited.balance = 20.0;
+        correct = correct && write_client_if_unchanged(data_ptr, &edited, 3, &existing) == UPDATE_CONFLICT;
+        fclose(data_ptr);
+    } else {
+        correct = 0;
+    }
+    
+    remove("test_import.txt");
+    remove("test_import.dat");
+    
+    if (imported != 2 || stats.rejected != 3 || !correct) {
+        printf("FAILED - Expected 2 imported and 3 rejected, got %ld and %ld\n", imported, stats.rejected);
+        return 0;
+    }
+    
+    if (strcmp(report, "line 2: invalid row (account 200 is outside 1-100)\n"
+                       "line 4: invalid row\nline 5: duplicate account 100\n") != 0) {
+        printf("FAILED - Unexpected import report:\n%s", report);
+        return 0;
+    }
+    
+    // Importing into a new file leaves it usable by the command interface
+    text_ptr = fopen("test_import.txt", "w");
+    if (text_ptr != NULL) {
+        fprintf(text_ptr, "5 Fresh 1.00\n");
+        fclose(text_ptr);
+    }
+    remove("test_import.dat");
+    imported = import_clients_text("test_import.txt", "test_import.dat", 1, NULL, NULL);
+    
+    FILE* script_ptr = tmpfile();
+    FILE* output_ptr = tmpfile();
+    char output[128] = "";
+    if (imported == 1 && script_ptr != NULL && output_ptr != NULL) {
+        fputs("read 5\ncreate 50 New Client\n", script_ptr);
+        rewind(script_ptr);
+        run_command_script(script_ptr, "test_import.dat", "test_import_history.dat", output_ptr, 0, NULL);
+        rewind(output_ptr);
+        size_t length = fread(output, 1, sizeof(output) - 1, output_ptr);
+        output[length] = '\0';
+    }
+    if (script_ptr != NULL) fclose(script_ptr);
+    if (output_ptr != NULL) fclose(output_ptr);
+    remove("test_import.txt");
+    remove("test_import.dat");
+    remove("test_import_history.dat");
+    
+    if (strcmp(output, "OK 5 Fresh  1.00\nOK 50 New Client 0.00\n") != 0) {
+        printf("FAILED - Commands on a newly imported file gave:\n%s", output);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_store_builder(void) {
+    printf("Test 6: Store File Builder... ");
+    
+    // Unsorted input spanning several data pages, plus one duplicate
+    FILE* text_ptr = fopen("test_store.txt", "w");
+    if (text_ptr == NULL) {
+        printf("FAILED - Could not create input file\n");
+        return 0;
+    }
+    for (int i = 0; i < 1000; i++) {
+        fprintf(text_ptr, "%d Client %d.50\n", (i * 7919) % 1000 * 3 + 1, i);
+    }
+    fprintf(text_ptr, "1 Again 5.00\n");
+    fclose(text_ptr);
+    
+    struct batch_stats stats;
+    long stored = build_store_file("test_store.txt", "test_store.store", 1, 0, NULL, &stats);
+    
+    struct store_file store;
+    struct client_data client;
+    int correct = store_file_open(&store, "test_store.store");
+    for (unsigned int acct = 1; correct && acct <= 3000; acct++) {
+        int found = store_file_find(&store, acct, &client);
+        correct = (acct % 3 == 1) ? (found && client.acct_num == acct) : !found;
+    }
+    correct = correct && store_file_find(&store, 1, &client) && strcmp(client.last_name, "Client") == 0;
+    store_file_close(&store);
+    
+    remove("test_store.txt");
+    remove("test_store.store");
+    
+    if (stored != 1000 || stats.rejected != 1 || !correct) {
+        printf("FAILED - Stored %ld records, %ld rejected, lookups %s\n",
+               stored, stats.rejected, correct ? "correct" : "wrong");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_name_normalization(void) {
+    printf("Test 7: Name Normalization... ");
+    
+    struct client_data clients[6];
+    const char* names[6] = {"Smith", "  O'Brien ", "Lopez-Diaz\t", "R2D2", "   ", "Van Dyke"};
+    const unsigned char expected_valid[6] = {1, 1, 1, 0, 0, 1};
+    const char* expected_names[6] = {"Smith", "O'Brien", "Lopez-Diaz", "R2D2", "", "Van Dyke"};
+    
+    for (int i = 0; i < 6; i++) {
+        initialize_client(&clients[i], i + 1, names[i], "", 0.0);
+    }
+    
+    unsigned char valid[6];
+    size_t valid_count = normalize_names_batch(clients[0].last_name, sizeof(struct client_data),
+                                               sizeof(clients[0].last_name), 6, valid);
+    
+    for (int i = 0; i < 6; i++) {
+        if (valid[i] != expected_valid[i] || strcmp(clients[i].last_name, expected_names[i]) != 0) {
+            printf("FAILED - '%s' gave '%s' (valid %d)\n", names[i], clients[i].last_name, valid[i]);
+            return 0;
+        }
+    }
+    
+    // Single-string helpers agree with the batch path, including long input
+    char long_name[64] = "  Wolfeschlegelsteinhausen-Bergerdorff   ";
+    if (valid_count != 4 || trim_name(long_name) != 36 || !validate_name(long_name) ||
+        validate_name("Jones!") || validate_name("Tab\tName")) {
+        printf("FAILED - Single name helpers\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_amount_parsing(void) {
+    printf("Test 8: Amount Parsing... ");
+    
+    struct amount_case {
+        const char* text;
+        int status;
+        long long cents;        // Expected value when status is AMOUNT_OK
+        size_t position;        // Expected error offset otherwise
+    } cases[] = {
+        {"-1234.56", AMOUNT_OK, -123456, 0},
+        {"+25.00\n", AMOUNT_OK, 2500, 0},
+        {"  0.1 ", AMOUNT_OK, 10, 0},
+        {"7", AMOUNT_OK, 700, 0},
+        {".5", AMOUNT_OK, 50, 0},
+        {"", AMOUNT_EMPTY, 0, 0},
+        {"-", AMOUNT_EMPTY, 0, 1},
+        {"12a.00", AMOUNT_BAD_CHARACTER, 0, 2},
+        {"1,000", AMOUNT_BAD_CHARACTER, 0, 1},
+        {"1.234", AMOUNT_TOO_MANY_DECIMALS, 0, 4},
+        {"12345678901234", AMOUNT_OUT_OF_RANGE, 0, 13}
+    };
+    int num_cases = sizeof(cases) / sizeof(cases[0]);
+    
+    for (int i = 0; i < num_cases; i++) {
+        long long cents = 0;
+        size_t position = 0;
+        int status = parse_amount_cents(cases[i].text, strlen(cases[i].text), &cents, &position);
+        int correct = (status == cases[i].status) &&
+                      (status == AMOUNT_OK ? cents == cases[i].cents : position == cases[i].position);
+        if (!correct) {
+            printf("FAILED - '%s' gave status %d, cents %lld, position %zu\n",
+                   cases[i].text, status, cents, position);
+            return 0;
+        }
+    }
+    
+    // Batch mode: fast-path lines, fallback lines, then a bad line
+    const char* batch = "-1234.56\n999999999999.99\n+5\n0.07\n17.10\n12x.00\n3.00\n";
+    long long expected[5] = {-123456, 99999999999999LL, 500, 7, 1710};
+    long long cents[8];
+    struct amount_error error;
+    long parsed = parse_amounts_batch(batch, strlen(batch), cents, 8, &error);
+    
+    if (parsed != 5 || memcmp(cents, expected, sizeof(expected)) != 0 ||
+        error.status != AMOUNT_BAD_CHARACTER || error.line != 6 || error.position != 2) {
+        printf("FAILED - Batch parsed %ld amounts, error %d at line %ld character %zu\n",
+               parsed, error.status, error.line, error.position);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/*
+ * RUN_TEST_SCRIPT
+ * 
+ * Purpose: Run the scripted-command test script on a fresh data file
+ * with run_command_script or run_ingest_pipeline and check the answers
+ * and the history entries
+ * Returns: 1 if everything matched, 0 otherwise
+ */
+int run_test_script(int pipelined) {
+    // Start from an empty data file
+    if (!write_test_data_file("test_commands.dat", NULL, 0)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    const char* script =
+        "create 17 Smith John 100.00\n"
+        "update 17 +25.00\n"
+        "  update 17 -0.10\r\n"
+        "\n"
+        "# comments are skipped\n"
+        "create 17 Again Who\n"
+        "update 18 5\n"
+        "update 17 12a\n"
+        "read 101\n"
+        "transfer 17 3 10.00\n"
+        "create 3 Doe Jane\n"
+        "transfer 17 3 10.00\n"
+        "delete 17\n"
+        "read 17\n"
+        "list\n"
+        "bogus 1";
+    const char* expected =
+        "OK 17 Smith John 100.00\n"
+        "OK 17 Smith John 125.00\n"
+        "OK 17 Smith John 124.90\n"
+        "ERR EXISTS account 17 already exists\n"
+        "ERR NOT_FOUND account 18 not found\n"
+        "ERR BAD_AMOUNT Unexpected character at character 3 of '12a'\n"
+        "ERR BAD_ACCOUNT account 101 is outside 1-100\n"
+        "ERR NOT_FOUND account 3 not found\n"
+        "OK 3 Doe Jane 0.00\n"
+        "OK 17 Smith John 114.90 3 Doe Jane 10.00\n"
+        "OK 17 deleted\n"
+        "ERR NOT_FOUND account 17 not found\n"
+        "3 Doe Jane 10.00\n"
+        "OK 1\n"
+        "ERR BAD_SYNTAX unknown command 'bogus'\n";
+    
+    FILE* script_ptr = tmpfile();
+    FILE* output_ptr = tmpfile();
+    long failed = -1;
+    char output[1024] = "";
+    if (script_ptr != NULL && output_ptr != NULL) {
+        fputs(script, script_ptr);
+        rewind(script_ptr);
+        if (pipelined) {
+            failed = run_ingest_pipeline(script_ptr, "test_commands.dat", "test_commands_history.dat",
+                                         output_ptr, 0, NULL, NULL);
+        } else {
+            failed = run_command_script(script_ptr, "test_commands.dat", "test_commands_history.dat",
+                                        output_ptr, 0, NULL);
+        }
+        
+        rewind(output_ptr);
+        size_t length = fread(output, 1, sizeof(output) - 1, output_ptr);
+        output[length] = '\0';
+    }
+    if (script_ptr != NULL) fclose(script_ptr);
+    if (output_ptr != NULL) fclose(output_ptr);
+    
+    // Two updates and both sides of the transfer were logged
+    long history_count;
+    struct transaction_record* history = load_history("test_commands_history.dat", &history_count);
+    int history_correct = (history_count == 4 && history[2].acct_num == 17 && history[2].amount == -10.0);
+    free(history);
+    
+    remove("test_commands.dat");
+    remove("test_commands_history.dat");
+    
+    if (strcmp(output, expected) != 0) {
+        printf("FAILED - Unexpected output:\n%s", output);
+        return 0;
+    }
+    
+    if (failed != 7 || !history_correct) {
+        printf("FAILED - Expected 7 failed commands and 4 history entries, got %ld and %ld\n",
+               failed, history_count);
+        return 0;
+    }
+    
+    return 1;
+}
+
+int test_command_script(void) {
+    printf("Test 9: Scripted Commands... ");
+    
+    if (!run_test_script(0)) return 0;
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_ingest_pipeline(void) {
+    printf("Test 10: Ingest Pipeline... ");
+    
+    // The pipeline must give exactly the answers of the sequential run
+    if (!run_test_script(1)) return 0;
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test task: add its number to a shared total, splitting off children first */
+struct pool_test_task {
+    atomic_long* total;
+    long value;
+    struct pool_test_task* children;
+    int child_count;
+};
+
+void pool_test_task(struct work_pool* pool, int worker, void* arg) {
+    struct pool_test_task* task = arg;
+    for (int i = 0; i < task->child_count; i++) {
+        work_pool_submit(pool, worker, pool_test_task, &task->children[i]);
+    }
+    atomic_fetch_add(task->total, task->value);
+}
+
+int test_work_pool(void) {
+    printf("Test 11: Work-Stealing Pool... ");
+    
+    // 10 parents each queue 100 children from inside the pool
+    struct pool_test_task parents[10];
+    struct pool_test_task children[10][100];
+    atomic_long total;
+    atomic_init(&total, 0);
+    
+    for (int p = 0; p < 10; p++) {
+        for (int c = 0; c < 100; c++) {
+            children[p][c] = (struct pool_test_task){&total, p * 100 + c + 1, NULL, 0};
+        }
+        parents[p] = (struct pool_test_task){&total, 0, children[p], 100};
+    }
+    
+    struct work_pool* pool = work_pool_create(4);
+    if (pool == NULL) {
+        printf("FAILED - Could not create pool\n");
+        return 0;
+    }
+    for (int p = 0; p < 10; p++) work_pool_submit(pool, 0, pool_test_task, &parents[p]);
+    work_pool_wait(pool);
+    work_pool_destroy(pool);
+    
+    if (atomic_load(&total) != 1000L * 1001 / 2) {
+        printf("FAILED - Tasks added up to %ld\n", atomic_load(&total));
+        return 0;
+    }
+    
+    // A sparse data file spanning several scan grains: one account every 1000 slots
+    FILE* data_ptr = fopen("test_pool.dat", "wb");
+    if (data_ptr == NULL) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    for (int i = 0; i < 3 * SCAN_GRAIN + 17; i++) {
+        struct client_data client = CLIENT_RECORD(0, "", "", 0.0);
+        if (i % 1000 == 0) initialize_client(&client, i + 1, "Pool", "Test", (i % 2000 == 0) ? 10.25 : -0.25);
+        fwrite(&client, RECORD_SIZE, 1, data_ptr);
+    }
+    fclose(data_ptr);
+    
+    struct account_summary single, parallel;
+    long scanned_single = summarize_accounts("test_pool.dat", 1, &single);
+    long scanned_parallel = summarize_accounts("test_pool.dat", 4, &parallel);
+    remove("test_pool.dat");
+    
+    // Accounts 1, 1001, ..., 12001: seven at 10.25 and six at -0.25
+    if (scanned_single != 3 * SCAN_GRAIN + 17 || scanned_parallel != scanned_single ||
+        single.accounts != 13 || single.overdrawn != 6 || single.total_cents != 7025 ||
+        memcmp(&single, &parallel, sizeof(single)) != 0) {
+        printf("FAILED - Summary %ld accounts, %ld overdrawn, %lld cents\n",
+               parallel.accounts, parallel.overdrawn, parallel.total_cents);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test thread: apply 'count' deltas of 'cents' to a hot account */
+struct hot_test_thread {
+    struct hot_store* store;
+    struct hot_account* account;
+    long long cents;
+    int count;
+    int refused;
+};
+
+void* hot_test_worker(void* arg) {
+    struct hot_test_thread* job = arg;
+    for (int i = 0; i < job->count; i++) {
+        if (hot_account_add(job->store, job->account, job->cents) != HOT_OK) job->refused++;
+    }
+    return NULL;
+}
+
+int test_hot_accounts(void) {
+    printf("Test 12: Hot Account Coalescing... ");
+    
+    struct client_data accounts[1];
+    memset(accounts, 0, sizeof(accounts));
+    initialize_client(&accounts[0], 42, "Merchant", "Corner", 5.00);
+    if (!write_test_data_file("test_hot.dat", accounts, 1)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    struct hot_store store;
+    if (!hot_store_open(&store, "test_hot.dat", "test_hot_history.dat", 1000)) {
+        printf("FAILED - Could not open hot store\n");
+        return 0;
+    }
+    struct hot_account* account = hot_store_track(&store, 42);
+    int untracked = (hot_store_track(&store, 43) == NULL);
+    
+    // 4000 one-cent debits against $5.00 + $10.00 overdraft: exactly 1500 fit
+    struct hot_test_thread jobs[4];
+    pthread_t threads[4];
+    int refused = 0;
+    for (int phase = 0; phase < 2 && account != NULL; phase++) {
+        for (int i = 0; i < 4; i++) {
+            jobs[i] = (struct hot_test_thread){&store, account, phase == 0 ? -1 : 1, 1000, 0};
+            pthread_create(&threads[i], NULL, hot_test_worker, &jobs[i]);
+        }
+        for (int i = 0; i < 4; i++) {
+            pthread_join(threads[i], NULL);
+            refused += jobs[i].refused;
+        }
+        if (phase == 0 && hot_account_balance(&store, account) != -1000) refused = -1;
+    }
+    long long balance = (account != NULL) ? hot_account_balance(&store, account) : 0;
+    hot_store_close(&store);
+    
+    // The record holds the folded balance and the history adds up to the change
+    struct client_data client;
+    FILE* data_ptr = fopen("test_hot.dat", "rb");
+    int stored = (data_ptr != NULL && read_client_from_file(data_ptr, &client, 41) &&
+                  client.balance == 30.00);
+    if (data_ptr != NULL) fclose(data_ptr);
+    
+    long history_count;
+    struct transaction_record* history = load_history("test_hot_history.dat", &history_count);
+    double logged = 0.0;
+    for (long i = 0; i < history_count; i++) logged += history[i].amount;
+    free(history);
+    
+    remove("test_hot.dat");
+    remove("test_hot_history.dat");
+    
+    if (account == NULL || !untracked || refused != 2500 || balance != 3000 || !stored ||
+        history_count < 1 || logged < 24.995 || logged > 25.005) {
+        printf("FAILED - %d debits refused, balance %lld cents, %ld history entries\n",
+               refused, balance, history_count);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test thread: run "update 9 +0.01" repeatedly on a session of its own */
+struct occ_test_thread {
+    int count;
+    int succeeded;
+};
+
+void* occ_test_worker(void* arg) {
+    struct occ_test_thread* job = arg;
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (output_ptr == NULL || !command_session_open(&session, "test_occ.dat", "test_occ_history.dat", output_ptr)) {
+        if (output_ptr != NULL) fclose(output_ptr);
+        return NULL;
+    }
+    
+    for (int i = 0; i < job->count; i++) {
+        if (execute_command_line(&session, "update 9 +0.01", 14) == COMMAND_OK) job->succeeded++;
+    }
+    
+    command_session_close(&session);
+    fclose(output_ptr);
+    return NULL;
+}
+
+int test_optimistic_updates(void) {
+    printf("Test 13: Optimistic Updates... ");
+    
+    struct client_data accounts[1];
+    memset(accounts, 0, sizeof(accounts));
+    initialize_client(&accounts[0], 9, "Stamp", "Version", 100.00);
+    FILE* data_ptr = write_test_data_file("test_occ.dat", accounts, 1) ? fopen("test_occ.dat", "rb+") : NULL;
+    if (data_ptr == NULL) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    // Two editors start from the same snapshot; the second one must lose
+    struct client_data snapshot, first, second;
+    int correct = read_client_from_file(data_ptr, &snapshot, 8);
+    first = snapshot;
+    first.balance = 150.00;
+    second = snapshot;
+    second.balance = 175.00;
+    correct = correct && write_client_if_unchanged(data_ptr, &first, 8, &snapshot) == UPDATE_OK &&
+              first.version == (unsigned short)(snapshot.version + 1) &&
+              write_client_if_unchanged(data_ptr, &second, 8, &snapshot) == UPDATE_CONFLICT;
+    fclose(data_ptr);
+    
+    // Concurrent read-modify-write from four sessions: no update may be lost
+    struct occ_test_thread jobs[4];
+    pthread_t threads[4];
+    int succeeded = 0;
+    for (int i = 0; i < 4; i++) {
+        jobs[i] = (struct occ_test_thread){250, 0};
+        pthread_create(&threads[i], NULL, occ_test_worker, &jobs[i]);
+    }
+    for (int i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+        succeeded += jobs[i].succeeded;
+    }
+    
+    struct client_data client;
+    data_ptr = fopen("test_occ.dat", "rb");
+    correct = correct && data_ptr != NULL && read_client_from_file(data_ptr, &client, 8) &&
+              balance_to_cents(client.balance) == 15000 + succeeded;
+    if (data_ptr != NULL) fclose(data_ptr);
+    
+    remove("test_occ.dat");
+    remove("test_occ_history.dat");
+    
+    // Retries make conflicts rare, but only a lost update is an error
+    if (!correct || succeeded == 0) {
+        printf("FAILED - %d of 1000 concurrent updates applied, balance %.2f\n", succeeded, client.balance);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test thread: read account 9 from the table until told to stop */
+struct table_test_reader {
+    struct account_table* table;
+    atomic_int* stop;
+    long reads;
+    long torn;              // Copies whose version and balance do not belong together
+};
+
+void* table_test_reader(void* arg) {
+    struct table_test_reader* job = arg;
+    struct client_data client;
+    
+    while (!atomic_load(job->stop)) {
+        account_table_read(job->table, 8, &client);
+        // Every "update 9 +0.01" adds one cent and one version
+        if (client.acct_num != 9 || balance_to_cents(client.balance) - 10000 != client.version) job->torn++;
+        job->reads++;
+    }
+    return NULL;
+}
+
+int test_account_table(void) {
+    printf("Test 14: Lock-Free Account Table... ");
+    
+    struct client_data accounts[1];
+    memset(accounts, 0, sizeof(accounts));
+    initialize_client(&accounts[0], 9, "Seq", "Lock", 100.00);
+    if (!write_test_data_file("test_table.dat", accounts, 1)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (output_ptr == NULL || !command_session_open(&session, "test_table.dat", "test_table_history.dat", output_ptr)) {
+        printf("FAILED - Could not open session\n");
+        if (output_ptr != NULL) fclose(output_ptr);
+        remove("test_table.dat");
+        return 0;
+    }
+    
+    // Readers check every copy while the session keeps writing the record
+    atomic_int stop = 0;
+    struct table_test_reader jobs[3];
+    pthread_t threads[3];
+    int started = 0;
+    for (int i = 0; i < 3; i++) {
+        jobs[i] = (struct table_test_reader){session.table, &stop, 0, 0};
+        if (pthread_create(&threads[i], NULL, table_test_reader, &jobs[i]) == 0) started++;
+    }
+    
+    int updated = 0;
+    for (int i = 0; i < 2000; i++) {
+        if (execute_command_line(&session, "update 9 +0.01", 14) == COMMAND_OK) updated++;
+    }
+    
+    atomic_store(&stop, 1);
+    long reads = 0, torn = 0;
+    for (int i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        reads += jobs[i].reads;
+        torn += jobs[i].torn;
+    }
+    
+    // A change made behind the table's back is picked up by the next write
+    struct client_data client, outside;
+    FILE* data_ptr = fopen("test_table.dat", "rb+");
+    int correct = (data_ptr != NULL && read_client_from_file(data_ptr, &outside, 8));
+    if (correct) {
+        outside.balance = 50.00;
+        outside.version++;
+        correct = write_client_to_file(data_ptr, &outside, 8);
+        fclose(data_ptr);
+    }
+    correct = correct && execute_command_line(&session, "update 9 +1.00", 14) == COMMAND_OK;
+    account_table_read(session.table, 8, &client);
+    correct = correct && balance_to_cents(client.balance) == 5100 &&
+              client.version == (unsigned short)(outside.version + 1);
+    
+    command_session_close(&session);
+    fclose(output_ptr);
+    remove("test_table.dat");
+    remove("test_table_history.dat");
+    
+    if (updated != 2000 || torn != 0 || !correct) {
+        printf("FAILED - %d updates, %ld of %ld reads torn, refresh %s\n",
+               updated, torn, reads, correct ? "worked" : "failed");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_shared_view(void) {
+    printf("Test 15: Shared-Memory View... ");
+    
+    struct client_data accounts[2];
+    memset(accounts, 0, sizeof(accounts));
+    initialize_client(&accounts[0], 4, "Shared", "Ann", 40.00);
+    initialize_client(&accounts[1], 5, "Shared", "Bob", 50.00);
+    if (!write_test_data_file("test_view.dat", accounts, 2)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    shared_view_remove("test_view.dat");  // Left over from an earlier run on the same inode
+    
+    // No view until a writer publishes one
+    int correct = (shared_view_open("test_view.dat", NULL) == NULL);
+    
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (output_ptr == NULL || !command_session_open(&session, "test_view.dat", "test_view_history.dat", output_ptr)) {
+        printf("FAILED - Could not open session\n");
+        if (output_ptr != NULL) fclose(output_ptr);
+        remove("test_view.dat");
+        return 0;
+    }
+    correct = correct && command_session_publish_view(&session, "test_view.dat");
+    
+    // A second, read-only mapping stands in for another process
+    struct shared_view* reader = shared_view_open("test_view.dat", NULL);
+    struct client_data clients[MAX_ACCOUNTS];
+    unsigned long before = 0, after = 0;
+    if (reader != NULL) {
+        before = account_table_snapshot(&reader->table, clients);
+        correct = correct && balance_to_cents(clients[3].balance) == 4000 && clients[4].acct_num == 5;
+    }
+    
+    correct = correct && execute_command_line(&session, "transfer 4 5 15.00", 18) == COMMAND_OK;
+    
+    if (reader != NULL) {
+        // Both sides of the transfer appear in one new generation
+        after = account_table_snapshot(&reader->table, clients);
+        correct = correct && after == before + 2 &&
+                  balance_to_cents(clients[3].balance) == 2500 && balance_to_cents(clients[4].balance) == 6500;
+        shared_view_close(reader);
+    }
+    
+    // A writer killed while publishing left its turn taken and account 4 half written
+    pid_t dead = fork();
+    if (dead == 0) _exit(0);
+    if (dead > 0) waitpid(dead, NULL, 0);
+    struct account_table* table = &session.view->table;
+    unsigned long stuck = atomic_load(&table->generation) + 1;
+    atomic_store(&table->owner, (int)dead);
+    atomic_store(&table->generation, stuck);
+    atomic_store(&table->records[3].sequence, atomic_load(&table->records[3].sequence) + 1);
+    atomic_store(&table->records[3].words[0], 0);
+    
+    // The next writer to open the view ends that turn, and writing goes on
+    FILE* data_ptr = fopen("test_view.dat", "rb");
+    struct shared_view* rescuer = (dead > 0 && data_ptr != NULL) ? shared_view_open("test_view.dat", data_ptr) : NULL;
+    struct client_data client;
+    correct = correct && rescuer != NULL && atomic_load(&table->owner) == 0 &&
+              atomic_load(&table->generation) > stuck && (atomic_load(&table->generation) & 1) == 0 &&
+              account_table_read(table, 3, &client) == 0 && client.acct_num == 4 &&
+              balance_to_cents(client.balance) == 2500 &&
+              execute_command_line(&session, "update 4 +1.00", 14) == COMMAND_OK;
+    if (rescuer != NULL) shared_view_close(rescuer);
+    if (data_ptr != NULL) fclose(data_ptr);
+    
+    command_session_close(&session);
+    fclose(output_ptr);
+    correct = correct && shared_view_remove("test_view.dat");
+    remove("test_view.dat");
+    remove("test_view_history.dat");
+    
+    if (reader == NULL || !correct) {
+        printf("FAILED - View %s, generation %lu -> %lu\n",
+               reader != NULL ? "mapped" : "not mapped", before, after);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test callbacks: count successes; follow an update with a read of the same account */
+struct async_test_state {
+    struct account_client* client;
+    struct account_request follow_up;
+    long ok;
+};
+
+void async_test_done(struct account_request* request, void* context) {
+    struct async_test_state* state = context;
+    if (request->result.status == COMMAND_OK) state->ok++;
+}
+
+void async_test_chain(struct account_request* request, void* context) {
+    struct async_test_state* state = context;
+    async_test_done(request, context);
+    account_client_read(state->client, &state->follow_up, request->command.acct_num, async_test_done, state);
+}
+
+int test_async_client(void) {
+    printf("Test 16: Asynchronous Client... ");
+    
+    struct client_data accounts[4];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 4; i++) initialize_client(&accounts[i], i + 1, "Async", "Client", 100.00);
+    if (!write_test_data_file("test_async.dat", accounts, 4)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    struct account_client client;
+    struct account_request* requests = calloc(3000, sizeof(struct account_request));
+    if (requests == NULL || !account_client_open(&client, "test_async.dat", "test_async_history.dat")) {
+        printf("FAILED - Could not start client\n");
+        free(requests);
+        remove("test_async.dat");
+        return 0;
+    }
+    
+    // 3000 requests in flight at once: updates, transfers around four accounts, polled reads
+    struct async_test_state state;
+    memset(&state, 0, sizeof(state));
+    state.client = &client;
+    for (int i = 0; i < 3000; i++) {
+        unsigned int acct_num = i % 4 + 1;
+        if (i % 3 == 0) {
+            account_client_update(&client, &requests[i], acct_num, 1, async_test_done, &state);
+        } else if (i % 3 == 1) {
+            account_client_transfer(&client, &requests[i], acct_num, acct_num % 4 + 1, 5, async_test_done, &state);
+        } else {
+            account_client_read(&client, &requests[i], acct_num, NULL, NULL);
+        }
+    }
+    struct account_request chained;
+    memset(&chained, 0, sizeof(chained));
+    account_client_update(&client, &chained, 2, 100, async_test_chain, &state);
+    account_client_drain(&client);
+    
+    int polled = 0;
+    for (int i = 2; i < 3000; i += 3) {
+        if (atomic_load(&requests[i].finished) && requests[i].result.status == COMMAND_OK) polled++;
+    }
+    int follow_up_correct = (state.follow_up.result.status == COMMAND_OK && state.follow_up.result.client.acct_num == 2);
+    long completed = client.completed;
+    account_client_close(&client);
+    free(requests);
+    
+    // Transfers only move money; every update added one cent (plus the chained dollar)
+    long long total_cents = 0;
+    struct client_data record;
+    FILE* data_ptr = fopen("test_async.dat", "rb");
+    for (int i = 0; data_ptr != NULL && i < 4; i++) {
+        if (read_client_from_file(data_ptr, &record, i)) total_cents += balance_to_cents(record.balance);
+    }
+    if (data_ptr != NULL) fclose(data_ptr);
+    remove("test_async.dat");
+    remove("test_async_history.dat");
+    
+    if (state.ok != 2002 || polled != 1000 || completed != 3002 || !follow_up_correct ||
+        total_cents != 40000 + 1000 + 100) {
+        printf("FAILED - %ld callbacks OK, %d polled reads, %ld completed, total %.2f\n",
+               state.ok, polled, completed, total_cents / 100.0);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_arena_allocator(void) {
+    printf("Test 17: Arena Allocator... ");
+    
+    // The same requests after a reset reuse the same memory
+    struct arena arena;
+    arena_init(&arena, 1024);
+    char* first = arena_alloc(&arena, 100);
+    char* grown = arena_grow(&arena, first, 100, 400);
+    char* large = arena_alloc(&arena, 5000);
+    long mallocs = arena.mallocs;
+    arena_reset(&arena);
+    char* again = arena_alloc(&arena, 100);
+    arena_grow(&arena, again, 100, 400);
+    char* large_again = arena_alloc(&arena, 5000);
+    
+    int correct = (first != NULL && ((size_t)first % ARENA_ALIGNMENT) == 0 && grown == first &&
+                   large != NULL && mallocs == 2 && again == first && large_again == large &&
+                   arena.mallocs == mallocs);
+    arena_release(&arena);
+    
+    // Commands, lists included, stop calling malloc once the session's arena has grown
+    struct client_data accounts[MAX_ACCOUNTS / 2];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < MAX_ACCOUNTS / 2; i++) initialize_client(&accounts[i], 2 * i + 1, "Arena", "Test", 10.00);
+    if (!write_test_data_file("test_arena.dat", accounts, MAX_ACCOUNTS / 2)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (output_ptr == NULL || !command_session_open(&session, "test_arena.dat", "test_arena_history.dat", output_ptr)) {
+        printf("FAILED - Could not open session\n");
+        if (output_ptr != NULL) fclose(output_ptr);
+        remove("test_arena.dat");
+        return 0;
+    }
+    
+    correct = correct && execute_command_line(&session, "list", 4) == COMMAND_OK;
+    long warm_mallocs = session.arena.mallocs;
+    long warm_allocations = session.arena.allocations;
+    for (int i = 0; i < 300; i++) {
+        execute_command_line(&session, "list", 4);
+        execute_command_line(&session, "update 3 +0.01", 14);
+        execute_command_line(&session, "read 5", 6);
+    }
+    correct = correct && session.arena.mallocs == warm_mallocs && warm_mallocs == 1 &&
+              session.arena.allocations == warm_allocations + 300;
+    
+    command_session_close(&session);
+    fclose(output_ptr);
+    remove("test_arena.dat");
+    remove("test_arena_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - %ld malloc calls after warm-up (expected %ld)\n", session.arena.mallocs, warm_mallocs);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test callback: free the request on the service thread (cache 0) */
+void pool_test_done(struct account_request* request, void* context) {
+    account_client_free_request(context, 0, request);
+}
+
+/* Test thread: submit pooled updates in rounds, using its own cache */
+struct pool_test_caller {
+    struct account_client* client;
+    int cache;
+};
+
+void* pool_test_caller(void* arg) {
+    struct pool_test_caller* job = arg;
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 100; i++) {
+            struct account_request* request = account_client_new_request(job->client, job->cache);
+            if (request == NULL) return NULL;
+            account_client_update(job->client, request, job->cache, 1, pool_test_done, job->client);
+        }
+        account_client_drain(job->client);
+    }
+    return NULL;
+}
+
+int test_object_pools(void) {
+    printf("Test 18: Object Pools... ");
+    
+    struct client_data accounts[3];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 3; i++) initialize_client(&accounts[i], i + 1, "Pool", "Test", 0.00);
+    if (!write_test_data_file("test_pool.dat", accounts, 3)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    struct account_client client;
+    if (!account_client_open(&client, "test_pool.dat", "test_pool_history.dat")) {
+        printf("FAILED - Could not start client\n");
+        remove("test_pool.dat");
+        return 0;
+    }
+    
+    // Three callers; every request is freed by the service thread and travels back
+    struct pool_test_caller jobs[3];
+    pthread_t threads[3];
+    int started = 0;
+    for (int i = 0; i < 3; i++) {
+        jobs[i] = (struct pool_test_caller){&client, i + 1};
+        if (pthread_create(&threads[i], NULL, pool_test_caller, &jobs[i]) == 0) started++;
+    }
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    
+    // A pooled "list" keeps its rows after completing, until the request is freed
+    struct account_request* list = account_client_new_request(&client, 4);
+    int correct = (started == 3 && list != NULL);
+    if (list != NULL) {
+        list->command.type = COMMAND_LIST;
+        account_client_submit(&client, list);
+        account_client_drain(&client);
+        correct = correct && atomic_load(&list->finished) && list->result.status == COMMAND_OK &&
+                  list->result.listing != NULL &&
+                  strcmp(list->result.listing, "1 Pool Test 20.00\n2 Pool Test 20.00\n3 Pool Test 20.00\n") == 0;
+        account_client_free_request(&client, 4, list);
+    }
+    
+    struct pool_stats requests, buffers;
+    object_pool_stats(&client.requests, &requests);
+    object_pool_stats(&client.buffers, &buffers);
+    account_client_close(&client);
+    remove("test_pool.dat");
+    remove("test_pool_history.dat");
+    
+    // Each caller needs at most 100 requests at once: 4 blocks of 32, then only reuse
+    correct = correct && requests.gets == 6001 && requests.remote_puts == 6000 &&
+              requests.mallocs <= 3 * 4 + 1 && requests.hits >= requests.gets - requests.mallocs * POOL_REFILL &&
+              buffers.gets == 1 && buffers.puts == 1;
+    if (!correct) {
+        printf("FAILED - %ld gets, %ld hits, %ld remote puts, %ld mallocs\n",
+               requests.gets, requests.hits, requests.remote_puts, requests.mallocs);
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_name_dictionary(void) {
+    printf("Test 19: Name Dictionary... ");
+    
+    // Interning: same name, same id; enough names to grow the hash table
+    struct name_dictionary names;
+    int correct = name_dictionary_init(&names);
+    if (correct) {
+        correct = name_intern(&names, "Smith") == 0 && name_intern(&names, "Jones") == 1 &&
+                  name_intern(&names, "Smith") == 0 && name_find(&names, "Brown") == NAME_ID_NONE;
+        char name[16];
+        for (int i = 0; correct && i < 5000; i++) {
+            snprintf(name, sizeof(name), "Name%d", i);
+            correct = (name_intern(&names, name) == (unsigned int)i + 2);
+        }
+        correct = correct && name_find(&names, "Name4321") == 4323 &&
+                  strcmp(name_text(&names, 4323), "Name4321") == 0 && name_find(&names, "Jones") == 1;
+        name_dictionary_free(&names);
+    }
+    
+    // The same rows as a plain and as a dictionary-encoded store
+    static const char* surnames[] = {"Smith", "Jones", "Garcia", "Chen", "Okafor", "Silva", "Novak"};
+    FILE* text_ptr = fopen("test_names.txt", "w");
+    if (text_ptr == NULL) {
+        printf("FAILED - Could not create input file\n");
+        return 0;
+    }
+    for (int i = 0; i < 3000; i++) {
+        fprintf(text_ptr, "%d %s %d.25\n", 3000 - i, surnames[(i * 3) % 7], i);
+    }
+    fclose(text_ptr);
+    
+    long plain_stored = build_store_file("test_names.txt", "test_plain.store", 1, 0, NULL, NULL);
+    long encoded_stored = build_store_file("test_names.txt", "test_names.store", 1, 1, NULL, NULL);
+    remove("test_names.txt");
+    
+    struct store_file plain, encoded;
+    int plain_open = store_file_open(&plain, "test_plain.store");
+    int encoded_open = store_file_open(&encoded, "test_names.store");
+    correct = correct && plain_stored == 3000 && encoded_stored == 3000 && plain_open && encoded_open &&
+              encoded.header.record_format == STORE_FORMAT_NAMES && encoded.header.name_count == 8 &&  // 7 + ""
+              encoded.size < plain.size * 2 / 3;
+    
+    // Lookups, search and grouping agree between the two
+    struct client_data a, b;
+    for (unsigned int acct = 1; correct && acct <= 3000; acct += 37) {
+        correct = store_file_find(&plain, acct, &a) && store_file_find(&encoded, acct, &b) &&
+                  memcmp(&a, &b, sizeof(a)) == 0;
+    }
+    struct client_data matches[3000];
+    long found = correct ? store_file_find_last_name(&encoded, "Garcia", matches, 3000) : 0;
+    correct = correct && found > 0 && found == store_file_find_last_name(&plain, "Garcia", NULL, 0) &&
+              strcmp(matches[found - 1].last_name, "Garcia") == 0 && matches[0].acct_num < matches[1].acct_num &&
+              store_file_find_last_name(&encoded, "Nobody", NULL, 0) == 0;
+    
+    struct name_dictionary plain_groups, encoded_groups;
+    long* plain_counts = NULL;
+    long* encoded_counts = NULL;
+    if (correct && name_dictionary_init(&plain_groups) && name_dictionary_init(&encoded_groups)) {
+        plain_counts = store_file_group_last_names(&plain, &plain_groups);
+        encoded_counts = store_file_group_last_names(&encoded, &encoded_groups);
+        long total = 0;
+        correct = plain_counts != NULL && encoded_counts != NULL &&
+                  plain_groups.count == 7 && encoded_groups.count == 7;
+        for (unsigned int id = 0; correct && id < 7; id++) {
+            correct = strcmp(name_text(&plain_groups, id), name_text(&encoded_groups, id)) == 0 &&
+                      plain_counts[id] == encoded_counts[id];
+            total += encoded_counts[id];
+        }
+        correct = correct && total == 3000 && encoded_counts[name_find(&encoded_groups, "Garcia")] == found;
+        name_dictionary_free(&plain_groups);
+        name_dictionary_free(&encoded_groups);
+    }
+    free(plain_counts);
+    free(encoded_counts);
+    
+    if (plain_open) store_file_close(&plain);
+    if (encoded_open) store_file_close(&encoded);
+    remove("test_plain.store");
+    remove("test_names.store");
+    
+    if (!correct) {
+        printf("FAILED - Plain and dictionary-encoded stores disagree\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_record_schema(void) {
+    printf("Test 20: Record Schema... ");
+    
+    struct client_data client = CLIENT_RECORD(42, "Schema", "Test", -12.5);
+    client_set_version(&client, 7);
+    client_set_first_name(&client, "Truncatedname");  // 13 chars into char[10]
+    
+    // Three records packed back to back, then unpacked
+    unsigned char packed[3 * CLIENT_PACKED_SIZE];
+    unsigned char* out = packed;
+    for (int i = 0; i < 3; i++) {
+        client_set_acct_num(&client, 42 + i);
+        out = client_data_pack(&client, out);
+    }
+    struct client_data copies[3];
+    const unsigned char* in = packed;
+    for (int i = 0; i < 3; i++) in = client_data_unpack(&copies[i], in);
+    
+    int correct = (CLIENT_PACKED_SIZE == 40 && out == packed + sizeof(packed) && in == out &&
+                   CLIENT_OFFSET_acct_num == offsetof(struct client_data, acct_num) &&
+                   CLIENT_OFFSET_last_name == offsetof(struct client_data, last_name) &&
+                   CLIENT_OFFSET_first_name == offsetof(struct client_data, first_name) &&
+                   strcmp(client_first_name(&client), "Truncated") == 0);
+    for (int i = 0; correct && i < 3; i++) {
+        correct = client_acct_num(&copies[i]) == 42u + i && client_version(&copies[i]) == 7 &&
+                  client_balance(&copies[i]) == -12.5 && strcmp(client_last_name(&copies[i]), "Schema") == 0 &&
+                  strcmp(copies[i].first_name, "Truncated") == 0;
+    }
+    
+    if (!correct) {
+        printf("FAILED - Packed record did not round-trip\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test thread: a teller that knows nothing about extensions, updating while the migrator runs */
+void* schema_test_teller(void* arg) {
+    FILE* file_ptr = fopen(arg, "rb+");
+    for (int i = 0; file_ptr != NULL && i < 300; i++) {
+        int position = i % 10;
+        int status;
+        do {
+            struct client_data snapshot, client;
+            if (!read_client_from_file(file_ptr, &snapshot, position)) break;
+            client = snapshot;
+            client.balance += 1.0;
+            status = write_client_if_unchanged(file_ptr, &client, position, &snapshot);
+        } while (status == UPDATE_CONFLICT);
+    }
+    if (file_ptr != NULL) fclose(file_ptr);
+    return NULL;
+}
+
+int test_schema_evolution(void) {
+    printf("Test 21: Schema Evolution... ");
+    
+    char extension_name[64];
+    extension_path("test_schema.dat", extension_name, sizeof(extension_name));
+    struct client_data accounts[10];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 10; i++) initialize_client(&accounts[i], i + 1, "Schema", "Test", 100.00);
+    accounts[5].format = 85;  // Padding left by an older program
+    accounts[6].format = RECORD_FORMAT_EXTENDED;
+    FILE* file_ptr = write_test_data_file("test_schema.dat", accounts, 10) ? fopen("test_schema.dat", "rb+") : NULL;
+    if (file_ptr == NULL) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    // Without an extension file there is nothing to upgrade into
+    FILE* extension_ptr = open_extension_file("test_schema.dat", 0);
+    int correct = (extension_ptr == NULL);
+    if (extension_ptr == NULL) extension_ptr = open_extension_file("test_schema.dat", 1);
+    correct = correct && extension_ptr != NULL;
+    
+    // A base record reads with defaults, without touching the extension file
+    struct client_data client, snapshot;
+    struct client_extension extension;
+    struct stat info;
+    correct = correct && read_client_extended(file_ptr, extension_ptr, 2, &client, &extension) &&
+              client.format == RECORD_FORMAT_BASE && extension.overdraft_limit_cents == DEFAULT_OVERDRAFT_LIMIT_CENTS &&
+              memcmp(extension.currency, "USD", 3) == 0 && stat(extension_name, &info) == 0 && info.st_size == 0;
+    
+    // So does a record whose stray format byte claims an extension that is not there
+    correct = correct && read_client_extended(file_ptr, extension_ptr, 6, &client, &extension) &&
+              client.format == RECORD_FORMAT_BASE && extension.acct_num == 7 &&
+              extension.overdraft_limit_cents == DEFAULT_OVERDRAFT_LIMIT_CENTS;
+    correct = correct && read_client_extended(file_ptr, extension_ptr, 2, &client, &extension);
+    
+    // Writing it upgrades it
+    int position = 2;
+    snapshot = client;
+    client.balance += 5.0;
+    correct = correct && write_clients_upgrading(file_ptr, extension_ptr, &client, &snapshot, &position, 1) == UPDATE_OK &&
+              read_client_extended(file_ptr, extension_ptr, 2, &client, &extension) &&
+              client.format == RECORD_FORMAT_EXTENDED && client.balance == 105.0 &&
+              extension.acct_num == 3 && extension.open_date == 0;
+    
+    // Changing extended fields
+    struct client_extension changed;
+    default_extension(&(struct client_data)CLIENT_RECORD(5, "", "", 0.0), 20240101, &changed);
+    changed.status = ACCOUNT_STATUS_DORMANT;
+    changed.overdraft_limit_cents = 123400;
+    memcpy(changed.currency, "EUR", 3);
+    correct = correct && set_client_extension(file_ptr, extension_ptr, 4, &changed) == UPDATE_OK &&
+              set_client_extension(file_ptr, extension_ptr, 50, &changed) == UPDATE_FAILED;
+    fclose(extension_ptr);
+    fclose(file_ptr);
+    
+    // The migrator upgrades the other 8 records (stray format bytes too) while a teller keeps updating all 10
+    struct schema_migrator migrator;
+    pthread_t teller;
+    int teller_started = (pthread_create(&teller, NULL, schema_test_teller, "test_schema.dat") == 0);
+    int migrator_started = schema_migrator_start(&migrator, "test_schema.dat", 2, 1);
+    if (teller_started) pthread_join(teller, NULL);
+    if (migrator_started) schema_migrator_join(&migrator);
+    correct = correct && teller_started && migrator_started && migrator.ok && migrator.migrated == 8;
+    
+    // A command session on a migrating file creates extended records
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (correct && output_ptr != NULL && command_session_open(&session, "test_schema.dat", "test_schema_history.dat", output_ptr)) {
+        const char* line = "create 11 New Client 5.00";
+        correct = execute_command_line(&session, line, strlen(line)) == COMMAND_OK;
+        command_session_close(&session);
+    } else {
+        correct = 0;
+    }
+    if (output_ptr != NULL) fclose(output_ptr);
+    
+    file_ptr = fopen("test_schema.dat", "rb");
+    extension_ptr = open_extension_file("test_schema.dat", 0);
+    for (int i = 0; correct && i < 11; i++) {
+        double expected_balance = (i == 10) ? 5.0 : (i == 2) ? 135.0 : 130.0;
+        correct = read_client_extended(file_ptr, extension_ptr, i, &client, &extension) &&
+                  client.format == RECORD_FORMAT_EXTENDED && extension.acct_num == (unsigned int)i + 1 &&
+                  client.balance == expected_balance;
+        if (i == 4) correct = correct && memcmp(extension.currency, "EUR", 3) == 0 && extension.overdraft_limit_cents == 123400;
+        if (i == 10) correct = correct && extension.open_date == today_date();
+    }
+    if (extension_ptr != NULL) fclose(extension_ptr);
+    if (file_ptr != NULL) fclose(file_ptr);
+    remove("test_schema.dat");
+    remove(extension_name);
+    remove("test_schema_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Records were not upgraded correctly\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_account_flags(void) {
+    printf("Test 22: Account Status Flags... ");
+    
+    remove("test_flags.dat.flags");  // Left over from an interrupted run
+    struct client_data accounts[10];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 10; i++) initialize_client(&accounts[i], i + 1, "Flag", "Test", 100.00);
+    if (!write_test_data_file("test_flags.dat", accounts, 10)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    // Without a flag file nothing is refused
+    int correct = account_flags_open("test_flags.dat", 0) == NULL &&
+                  account_flags_refusal(NULL, COMMAND_DELETE, 3, 0, NULL, 0) == COMMAND_OK &&
+                  account_flag(NULL, 3, ACCOUNT_FROZEN) == 0 && account_flag(NULL, 3, ACCOUNT_OVERDRAFT) == 1;
+    
+    // Bulk changes count only the accounts that changed and skip invalid ones
+    struct account_flags* flags = account_flags_open("test_flags.dat", 1);
+    unsigned int frozen[] = {3, 5, 5, 0, 7, 64, 200};
+    unsigned int closed[] = {2};
+    unsigned int no_overdraft[] = {4};
+    correct = correct && flags != NULL && account_flag(flags, 64, ACCOUNT_OVERDRAFT) &&
+              account_flags_set(flags, ACCOUNT_FROZEN, frozen, 7, 1) == 4 &&
+              account_flags_set(flags, ACCOUNT_FROZEN, frozen, 2, 1) == 0 &&
+              account_flags_set(flags, ACCOUNT_CLOSED, closed, 1, 1) == 1 &&
+              account_flags_set(flags, ACCOUNT_OVERDRAFT, no_overdraft, 1, 0) == 1 &&
+              account_flag(flags, 64, ACCOUNT_FROZEN) && !account_flag(flags, 63, ACCOUNT_FROZEN) &&
+              !account_flag(flags, 4, ACCOUNT_OVERDRAFT) && account_flag(flags, 1, ACCOUNT_OVERDRAFT);
+    
+    // Commands against flagged accounts are refused before touching the records
+    struct {
+        const char* line;
+        int status;
+    } cases[] = {
+        {"update 3 +1.00", COMMAND_FROZEN},
+        {"delete 5", COMMAND_FROZEN},
+        {"transfer 1 7 1.00", COMMAND_FROZEN},
+        {"update 2 +1.00", COMMAND_CLOSED},
+        {"transfer 2 1 1.00", COMMAND_CLOSED},
+        {"read 3", COMMAND_OK},
+        {"update 4 -100.01", COMMAND_NO_OVERDRAFT},
+        {"transfer 4 1 100.01", COMMAND_NO_OVERDRAFT},
+        {"update 4 -100.00", COMMAND_OK},
+        {"update 1 -500.00", COMMAND_OK},
+        {"delete 2", COMMAND_OK},
+    };
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    int opened = correct && output_ptr != NULL &&
+                 command_session_open(&session, "test_flags.dat", "test_flags_history.dat", output_ptr);
+    for (size_t i = 0; opened && i < sizeof(cases) / sizeof(cases[0]); i++) {
+        correct = correct && execute_command_line(&session, cases[i].line, strlen(cases[i].line)) == cases[i].status;
+    }
+    
+    // Unfreezing takes effect for the running session at once
+    unsigned int thawed[] = {3};
+    const char* line = "update 3 +1.00";
+    correct = correct && opened && account_flags_set(flags, ACCOUNT_FROZEN, thawed, 1, 0) == 1 &&
+              execute_command_line(&session, line, strlen(line)) == COMMAND_OK;
+    if (opened) command_session_close(&session);
+    if (output_ptr != NULL) fclose(output_ptr);
+    if (flags != NULL) account_flags_close(flags);
+    
+    // The flags are still there when the file is mapped again
+    flags = account_flags_open("test_flags.dat", 0);
+    correct = correct && flags != NULL && account_flag(flags, 5, ACCOUNT_FROZEN) && !account_flag(flags, 3, ACCOUNT_FROZEN) &&
+              account_flag(flags, 2, ACCOUNT_CLOSED) && !account_flag(flags, 4, ACCOUNT_OVERDRAFT);
+    if (flags != NULL) account_flags_close(flags);
+    
+    struct client_data client;
+    FILE* file_ptr = fopen("test_flags.dat", "rb");
+    correct = correct && file_ptr != NULL &&
+              read_client_from_file(file_ptr, &client, 2) && client.balance == 101.00 &&
+              read_client_from_file(file_ptr, &client, 3) && client.balance == 0.00 &&
+              read_client_from_file(file_ptr, &client, 0) && client.balance == -400.00 &&
+              read_client_from_file(file_ptr, &client, 1) && client.acct_num == 0;
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    // Hot accounts check the same flags on every delta: $100.00 + $50.00 overdraft on account 6, none on 4
+    struct hot_store store;
+    int hot = correct && hot_store_open(&store, "test_flags.dat", "test_flags_history.dat", 5000);
+    struct hot_account* hot_frozen = hot ? hot_store_track(&store, 5) : NULL;
+    struct hot_account* hot_limited = hot ? hot_store_track(&store, 4) : NULL;
+    struct hot_account* hot_open = hot ? hot_store_track(&store, 6) : NULL;
+    correct = correct && hot && hot_frozen != NULL && hot_limited != NULL && hot_open != NULL &&
+              hot_account_add(&store, hot_frozen, 100) == HOT_REFUSED &&
+              hot_account_add(&store, hot_limited, -1) == HOT_OVERDRAFT &&
+              hot_account_add(&store, hot_limited, 100) == HOT_OK &&
+              hot_account_add(&store, hot_limited, -100) == HOT_OK &&
+              hot_account_add(&store, hot_limited, -1) == HOT_OVERDRAFT &&
+              hot_account_add(&store, hot_open, -15000) == HOT_OK &&
+              hot_account_add(&store, hot_open, -1) == HOT_OVERDRAFT;
+    if (hot) hot_store_close(&store);
+    remove("test_flags.dat");
+    remove("test_flags.dat.flags");
+    remove("test_flags_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Flagged accounts were not handled correctly\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+/* Test thread: record 'count' numbered events for account 'thread + 11' */
+struct audit_test_thread {
+    struct audit_log* log;
+    unsigned int thread;
+    long count;
+};
+
+void* audit_test_recorder(void* arg) {
+    struct audit_test_thread* recorder = arg;
+    struct audit_ring* ring = audit_ring_attach(recorder->log);
+    if (ring == NULL) return NULL;
+    
+    struct command command = {.type = COMMAND_UPDATE, .acct_num = recorder->thread + 11};
+    for (long i = 0; i < recorder->count; i++) {
+        command.cents = i;
+        audit_record(ring, &command, COMMAND_OK);
+    }
+    audit_ring_detach(ring);
+    return NULL;
+}
+
+int test_audit_trail(void) {
+    printf("Test 23: Audit Trail... ");
+    
+    remove("test_audit.dat.audit");  // Left over from an interrupted run
+    struct client_data accounts[10];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 10; i++) initialize_client(&accounts[i], i + 1, "Audit", "Test", 100.00);
+    if (!write_test_data_file("test_audit.dat", accounts, 10)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    // 4 threads record at once, each more than its ring holds
+    struct audit_log* log = audit_log_open("test_audit.dat", 2);
+    struct audit_test_thread recorders[4];
+    pthread_t threads[4];
+    int started = 0;
+    while (log != NULL && started < 4) {
+        recorders[started].log = log;
+        recorders[started].thread = (unsigned int)started;
+        recorders[started].count = 20000;
+        if (pthread_create(&threads[started], NULL, audit_test_recorder, &recorders[started]) != 0) break;
+        started++;
+    }
+    for (int i = 0; i < started; i++) pthread_join(threads[i], NULL);
+    int correct = (log != NULL && started == 4);
+    
+    // A session records every command it applies, refused or not
+    const char* lines[] = {"update 1 +1.00", "delete 99", "transfer 1 2 0.50", "read 3"};
+    int statuses[] = {COMMAND_OK, COMMAND_NOT_FOUND, COMMAND_OK, COMMAND_OK};
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    if (correct && output_ptr != NULL &&
+        command_session_open(&session, "test_audit.dat", "test_audit_history.dat", output_ptr)) {
+        command_session_audit(&session, log);
+        for (int i = 0; i < 4; i++) {
+            correct = correct && execute_command_line(&session, lines[i], strlen(lines[i])) == statuses[i];
+        }
+        command_session_close(&session);
+    } else {
+        correct = 0;
+    }
+    if (output_ptr != NULL) fclose(output_ptr);
+    
+    struct audit_stats stats;
+    correct = audit_log_close(log, &stats) && correct;
+    long expected = 4 * 20000 + 4;
+    correct = correct && stats.events == expected && stats.syncs > 0;
+    correct = correct && audit_append("test_audit.dat", &(struct command){.type = COMMAND_DELETE, .acct_num = 5},
+                                      COMMAND_OK);
+    
+    // Each ring's events are on disk complete and in order, and so are each thread's and
+    // the session's (rings are written one after the other, so those may interleave)
+    unsigned int next_sequence[5] = {0};
+    long long next_cents[4] = {0};
+    struct audit_event events[4];
+    int session_events = 0;
+    long count = 0;
+    FILE* audit_ptr = fopen("test_audit.dat.audit", "rb");
+    struct audit_event event;
+    while (correct && audit_ptr != NULL && fread(&event, sizeof(event), 1, audit_ptr) == 1) {
+        unsigned int thread = event.acct_num - 11;
+        if (count >= expected) {
+            correct = event.ring == 0 && event.type == COMMAND_DELETE && event.acct_num == 5;
+        } else {
+            correct = event.ring >= 1 && event.ring <= 4 && event.sequence == next_sequence[event.ring]++;
+        }
+        if (correct && count < expected && thread < 4) {
+            correct = event.cents == next_cents[thread]++;
+        } else if (correct && count < expected) {
+            correct = session_events < 4;
+            if (correct) events[session_events++] = event;
+        }
+        count++;
+    }
+    if (audit_ptr != NULL) fclose(audit_ptr);
+    correct = correct && count == expected + 1 && session_events == 4 &&
+              events[0].type == COMMAND_UPDATE && events[0].status == COMMAND_OK && events[0].cents == 100 &&
+              events[1].type == COMMAND_DELETE && events[1].status == COMMAND_NOT_FOUND && events[1].acct_num == 99 &&
+              events[2].type == COMMAND_TRANSFER && events[2].target_acct == 2 && events[2].cents == 50 &&
+              events[3].type == COMMAND_READ && events[3].acct_num == 3;
+    for (int i = 0; correct && i < 4; i++) correct = next_cents[i] == 20000;
+    
+    remove("test_audit.dat");
+    remove("test_audit.dat.audit");
+    remove("test_audit_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Audit events were lost or out of order\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_interest_accrual(void) {
+    printf("Test 24: Interest Accrual... ");
+    
+    // 0.1% up to $1,000, 0.15% up to $10,000, 0.2% above
+    struct interest_tiers tiers;
+    char* arguments[] = {"0.1", "1000.00:0.15", "10000.00:0.2"};
+    int correct = parse_interest_tiers(3, arguments, &tiers) && tiers.rate[1] == 1500 &&
+                  tiers.floor_cents[2] == 1000000 && !parse_interest_tiers(2, (char*[]){"0.1", "0.2"}, &tiers) &&
+                  parse_interest_tiers(3, arguments, &tiers);
+    
+    // Rates are read exactly: four decimals at most, no exponents, no "nan"
+    long rate;
+    correct = correct && parse_rate_percent("0.0001", &rate) && rate == 1 && parse_rate_percent(".5", &rate) &&
+              rate == 5000 && parse_rate_percent("100", &rate) && rate == INTEREST_RATE_UNIT &&
+              !parse_rate_percent("0.00001", &rate) && !parse_rate_percent("100.0001", &rate) &&
+              !parse_rate_percent("nan", &rate) && !parse_rate_percent("inf", &rate) &&
+              !parse_rate_percent("0x1p1", &rate) && !parse_rate_percent("1e1", &rate) &&
+              !parse_rate_percent("-1", &rate) && !parse_rate_percent(".", &rate) && !parse_rate_percent("", &rate);
+    correct = correct && interest_cents(150000, &tiers) == 175 && interest_cents(-5000, &tiers) == 0 &&
+              interest_cents(2000000, &tiers) == 100 + 1350 + 2000;
+    
+    // The SIMD column matches the integer reference, tier edges and rounding ties included
+    struct interest_tiers half = {1, {0}, {500000}};  // 50%: odd cents give ties
+    double cents[1000], interest[1000];
+    unsigned int seed = 12345;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        cents[i] = (i < 20) ? i : (i < 40) ? 999990 + i : (double)(seed % 500000000u) - 1000000.0;
+    }
+    accrue_interest_column(cents, interest, 1000, &tiers);
+    for (int i = 0; correct && i < 1000; i++) correct = interest[i] == (double)interest_cents((long long)cents[i], &tiers);
+    accrue_interest_column(cents, interest, 1000, &half);
+    for (int i = 0; correct && i < 1000; i++) correct = interest[i] == (double)interest_cents((long long)cents[i], &half);
+    correct = correct && interest[1] == 0 && interest[3] == 2 && interest[5] == 2;
+    
+    // A file of several grains: every third record in use, the second grain all overdrawn
+    long records = 2 * SCAN_GRAIN + 100;
+    FILE* file_ptr = fopen("test_interest.dat", "wb");
+    if (file_ptr == NULL) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    for (long i = 0; i < records; i++) {
+        struct client_data client = CLIENT_RECORD(0, "", "", 0.0);
+        if (i % 3 == 0) {
+            double balance = (i >= SCAN_GRAIN && i < 2 * SCAN_GRAIN) ? -1.0 - i : (i % 7) * 3333.33 - 5000.0;
+            initialize_client(&client, (unsigned int)i + 1, "Interest", "Test", balance);
+        }
+        fwrite(&client, RECORD_SIZE, 1, file_ptr);
+    }
+    fclose(file_ptr);
+    remove("test_interest_history.dat");
+    
+    // Account 7 is closed and earns nothing
+    struct account_flags* flags = account_flags_open("test_interest.dat", 1);
+    unsigned int closed[] = {7};
+    correct = correct && flags != NULL && account_flags_set(flags, ACCOUNT_CLOSED, closed, 1, 1) == 1;
+    if (flags != NULL) account_flags_close(flags);
+    
+    struct interest_summary summary;
+    long scanned = accrue_interest("test_interest.dat", "test_interest_history.dat", 2, &tiers, &summary);
+    correct = correct && scanned == records && summary.grains_skipped == 1;
+    
+    long credited = 0;
+    long long paid = 0;
+    file_ptr = fopen("test_interest.dat", "rb");
+    struct client_data client;
+    for (long i = 0; correct && file_ptr != NULL && i < records; i++) {
+        correct = fread(&client, RECORD_SIZE, 1, file_ptr) == 1;
+        if (!correct || i % 3 != 0) continue;
+        
+        long long before = (i >= SCAN_GRAIN && i < 2 * SCAN_GRAIN) ? -100 - 100 * i
+                         : balance_to_cents((i % 7) * 3333.33 - 5000.0);
+        long long due = (i == 6) ? 0 : interest_cents(before, &tiers);
+        correct = balance_to_cents(client.balance) == before + due && client.version == (due > 0);
+        credited += (due > 0);
+        paid += due;
+    }
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    // One history entry per credit
+    long entries;
+    struct transaction_record* history = load_history("test_interest_history.dat", &entries);
+    long long history_cents = 0;
+    for (long i = 0; history != NULL && i < entries; i++) history_cents += balance_to_cents(history[i].amount);
+    free(history);
+    correct = correct && credited > 0 && summary.accounts == credited && summary.interest_cents == paid &&
+              entries == credited && history_cents == paid;
+    
+    remove("test_interest.dat");
+    remove("test_interest.dat.flags");
+    remove("test_interest_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Interest was not credited exactly\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_overdraft_fees(void) {
+    printf("Test 25: Overdraft Fees... ");
+    
+    // $25.00 plus 1% of the amount overdrawn, at most $26.00
+    struct overdraft_fees fees;
+    int correct = parse_overdraft_fees(3, (char*[]){"25.00", "1", "26.00"}, &fees) && fees.rate == 10000 &&
+                  !parse_overdraft_fees(1, (char*[]){"-1.00"}, &fees) &&
+                  parse_overdraft_fees(3, (char*[]){"25.00", "1", "26.00"}, &fees);
+    correct = correct && overdraft_fee_cents(1000, &fees) == 2510 && overdraft_fee_cents(20000, &fees) == 2600 &&
+              overdraft_fee_cents(0, &fees) == 0;
+    
+    // Accounts 5 and 70 are overdrawn, 12 is overdrawn but closed, 9 is in credit
+    remove("test_fees.dat.flags");
+    remove("test_fees_history.dat");
+    struct client_data accounts[4];
+    memset(accounts, 0, sizeof(accounts));
+    initialize_client(&accounts[0], 5, "Fee", "Test", -10.00);
+    initialize_client(&accounts[1], 9, "Fee", "Test", 50.00);
+    initialize_client(&accounts[2], 12, "Fee", "Test", -5.00);
+    initialize_client(&accounts[3], 70, "Fee", "Test", -200.00);
+    if (!write_test_data_file("test_fees.dat", accounts, 4)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    struct account_flags* flags = account_flags_open("test_fees.dat", 1);
+    unsigned int closed[] = {12};
+    correct = correct && flags != NULL && account_flags_set(flags, ACCOUNT_CLOSED, closed, 1, 1) == 1;
+    if (flags != NULL) account_flags_close(flags);
+    
+    // The first run builds the index with a scan
+    struct overdraft_summary summary;
+    correct = correct && charge_overdraft_fees("test_fees.dat", "test_fees_history.dat", &fees, 0, NULL, &summary) == 2 &&
+              summary.rebuilt && summary.candidates == 3 && summary.skipped == 1 && summary.cleared == 0 &&
+              summary.fee_cents == 2510 + 2600 && summary.overdrawn_cents == 3510 + 22600 + 500;
+    
+    // Commands keep the index: 9 goes below zero, 5 is paid back
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    int opened = correct && output_ptr != NULL &&
+                 command_session_open(&session, "test_fees.dat", "test_fees_history.dat", output_ptr);
+    const char* lines[] = {"update 9 -80.00", "update 5 +100.00"};
+    for (int i = 0; opened && i < 2; i++) {
+        correct = correct && execute_command_line(&session, lines[i], strlen(lines[i])) == COMMAND_OK;
+    }
+    if (opened) command_session_close(&session);
+    if (output_ptr != NULL) fclose(output_ptr);
+    
+    // The second run uses the index alone and drops account 5 from it
+    correct = correct && charge_overdraft_fees("test_fees.dat", "test_fees_history.dat", &fees, 0, NULL, &summary) == 2 &&
+              !summary.rebuilt && summary.candidates == 4 && summary.cleared == 1 && summary.skipped == 1 &&
+              summary.fee_cents == 2530 + 2600;
+    flags = account_flags_open("test_fees.dat", 0);
+    correct = correct && flags != NULL && (atomic_load(&flags->overdrawn[0]) == ((1ULL << 9) | (1ULL << 12))) &&
+              atomic_load(&flags->overdrawn[1]) == (1ULL << (70 - 64));
+    if (flags != NULL) account_flags_close(flags);
+    
+    struct client_data client;
+    FILE* file_ptr = fopen("test_fees.dat", "rb");
+    long long expected[][2] = {{5, 6490}, {9, -5530}, {12, -500}, {70, -25200}};
+    for (int i = 0; correct && file_ptr != NULL && i < 4; i++) {
+        correct = read_client_from_file(file_ptr, &client, (int)expected[i][0] - 1) &&
+                  balance_to_cents(client.balance) == expected[i][1];
+    }
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    // An import leaves the index stale, so the next run rebuilds it
+    account_flags_invalidate_index("test_fees.dat");
+    correct = correct && charge_overdraft_fees("test_fees.dat", "test_fees_history.dat", &fees, 0, NULL, &summary) == 2 &&
+              summary.rebuilt && summary.candidates == 3;
+    
+    // Six fees and the two updates in the history, the fees as debits
+    long entries;
+    struct transaction_record* history = load_history("test_fees_history.dat", &entries);
+    long long debits = 0;
+    for (long i = 0; history != NULL && i < entries; i++) {
+        if (history[i].amount < 0) debits -= balance_to_cents(history[i].amount);
+    }
+    free(history);
+    correct = correct && entries == 8 && debits == 8000 + 2510 + 2600 + 2530 + 2600 + 2555 + 2600;
+    
+    remove("test_fees.dat");
+    remove("test_fees.dat.flags");
+    remove("test_fees_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Overdraft fees were not charged as expected\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_standing_orders(void) {
+    printf("Test 26: Standing Orders... ");
+    
+    long long seconds;
+    int correct = parse_order_interval("12h", &seconds) && seconds == 12 * 3600 &&
+                  parse_order_interval("2w", &seconds) && seconds == 14 * 86400 &&
+                  parse_order_interval("3", &seconds) && seconds == 3 * 86400 &&
+                  !parse_order_interval("1x", &seconds) && !parse_order_interval("0d", &seconds) &&
+                  !parse_order_interval("1dd", &seconds);
+    
+    // The heap hands out positions by due time, ties in position order
+    struct standing_order keyed[50];
+    unsigned int items[50];
+    struct order_heap heap = {items, 0, keyed};
+    unsigned int seed = 777;
+    for (unsigned int i = 0; i < 50; i++) {
+        seed = seed * 1103515245u + 12345u;
+        keyed[i].next_due = seed % 20;
+        order_heap_push(&heap, i);
+    }
+    unsigned int previous = order_heap_pop(&heap);
+    while (correct && heap.count > 0) {
+        unsigned int next = order_heap_pop(&heap);
+        correct = !order_due_first(keyed, next, previous);
+        previous = next;
+    }
+    
+    remove("test_orders.dat.orders");
+    remove("test_orders.dat.flags");
+    remove("test_orders_history.dat");
+    double balances[10] = {500.00, 0, 100.00, 0, 1000.00, 0, 50.00, 0, 10.00, 1000.00};
+    struct client_data accounts[10];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 10; i++) initialize_client(&accounts[i], i + 1, "Order", "Test", balances[i]);
+    if (!write_test_data_file("test_orders.dat", accounts, 10)) {
+        printf("FAILED - Could not create data file\n");
+        return 0;
+    }
+    
+    // Account 7 may not be overdrawn, so its order is refused
+    struct account_flags* flags = account_flags_open("test_orders.dat", 1);
+    unsigned int no_overdraft[] = {7};
+    correct = correct && flags != NULL && account_flags_set(flags, ACCOUNT_OVERDRAFT, no_overdraft, 1, 0) == 1;
+    if (flags != NULL) account_flags_close(flags);
+    
+    long long now = 1700000000;
+    struct standing_order orders[] = {
+        {.from_acct = 1, .to_acct = 2, .cents = 1000, .interval = 86400, .next_due = now - 10, .remaining = -1},
+        {.from_acct = 3, .to_acct = 4, .cents = 500, .interval = 86400, .next_due = now + 100, .remaining = -1},
+        {.from_acct = 5, .to_acct = 6, .cents = 10000, .interval = 7 * 86400, .next_due = now - 3 * 86400, .remaining = 2},
+        {.from_acct = 7, .to_acct = 8, .cents = 100000, .interval = 86400, .next_due = now, .remaining = 2},
+        {.from_acct = 9, .to_acct = 1, .cents = 100, .interval = 3600, .next_due = now - 1, .remaining = 1},
+    };
+    correct = correct && add_standing_orders("test_orders.dat", orders, 5) == 1;
+    
+    // Four orders are due; the one that missed three days is made once
+    struct order_summary summary;
+    correct = correct && run_standing_orders("test_orders.dat", "test_orders_history.dat", now, NULL, NULL, &summary) == 3 &&
+              summary.orders == 5 && summary.due == 4 && summary.refused == 1 && summary.batches == 1 &&
+              summary.cents == 1000 + 10000 + 100 && summary.next_due == now + 100;
+    correct = correct && run_standing_orders("test_orders.dat", "test_orders_history.dat", now, NULL, NULL, &summary) == 0 &&
+              summary.due == 0;
+    
+    struct order_file file;
+    correct = correct && order_file_open(&file, "test_orders.dat", 0);
+    if (correct) {
+        correct = file.count == 5 && file.orders[0].next_due == now - 10 + 86400 &&
+                  file.orders[2].next_due == now + 4 * 86400 && file.orders[2].remaining == 1 &&
+                  file.orders[3].refused == 1 && file.orders[3].last_status == COMMAND_NO_OVERDRAFT &&
+                  file.orders[3].remaining == 2 &&  // A refused payment is not used up
+                  file.orders[4].remaining == 0 && file.orders[4].executed == 1 && file.orders[1].last_status == -1;
+        order_file_close(&file);
+    }
+    
+    // A cancelled order no longer runs; the next day makes order 2 and refuses order 4 again
+    correct = correct && cancel_standing_order("test_orders.dat", 1) && !cancel_standing_order("test_orders.dat", 1) &&
+              !cancel_standing_order("test_orders.dat", 99);
+    correct = correct && run_standing_orders("test_orders.dat", "test_orders_history.dat", now + 86400, NULL, NULL,
+                                             &summary) == 1 &&
+              summary.orders == 3 && summary.due == 2 && summary.refused == 1 && summary.cents == 500;
+    
+    long long expected[10] = {49100, 1000, 9500, 500, 90000, 10000, 5000, 0, 900, 100000};
+    struct client_data client;
+    FILE* file_ptr = fopen("test_orders.dat", "rb");
+    for (int i = 0; correct && file_ptr != NULL && i < 10; i++) {
+        correct = read_client_from_file(file_ptr, &client, i) && balance_to_cents(client.balance) == expected[i] &&
+                  client.version == (i == 6 || i == 7 || i == 9 ? 0 : 1);
+    }
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    long entries;
+    struct transaction_record* history = load_history("test_orders_history.dat", &entries);
+    free(history);
+    correct = correct && entries == 8;
+    
+    // Tens of thousands of due orders go through in a few batches
+    remove("test_orders.dat.orders");
+    long many = 20000;
+    struct standing_order* bulk = calloc(many, sizeof(*bulk));
+    for (long i = 0; bulk != NULL && i < many; i++) {
+        bulk[i] = (struct standing_order){.from_acct = 10, .to_acct = 3, .cents = 1, .interval = 86400,
+                                          .next_due = now - i % 5000, .remaining = -1};
+    }
+    correct = correct && bulk != NULL && add_standing_orders("test_orders.dat", bulk, many) == 1;
+    free(bulk);
+    correct = correct && run_standing_orders("test_orders.dat", "test_orders_history.dat", now, NULL, NULL, &summary) == many &&
+              summary.batches == (many + ORDER_BATCH - 1) / ORDER_BATCH && summary.cents == many;
+    
+    file_ptr = fopen("test_orders.dat", "rb");
+    correct = correct && file_ptr != NULL && read_client_from_file(file_ptr, &client, 9) &&
+              balance_to_cents(client.balance) == 100000 - many && read_client_from_file(file_ptr, &client, 2) &&
+              balance_to_cents(client.balance) == 9500 + many;
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    remove("test_orders.dat");
+    remove("test_orders.dat.orders");
+    remove("test_orders.dat.flags");
+    remove("test_orders_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Standing orders were not made as scheduled\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+int test_velocity_checks(void) {
+    printf("Test 27: Velocity Checks... ");
+    
+    // At most 3 debits and $100.00 per account per hour
+    remove("test_velocity.dat.velocity");
+    remove("test_velocity.dat.debits");
+    remove("test_velocity.dat.orders");
+    struct velocity_rules rules = {VELOCITY_MAGIC, 3, 10000};
+    struct velocity_rules read_back;
+    int correct = !velocity_rules_read("test_velocity.dat", &read_back) &&
+                  velocity_tracker_open("test_velocity.dat") == NULL &&
+                  velocity_rules_write("test_velocity.dat", &rules) && velocity_rules_read("test_velocity.dat", &read_back) &&
+                  read_back.max_debits == 3 && read_back.max_cents == 10000;
+    struct velocity_tracker* tracker = correct ? velocity_tracker_open("test_velocity.dat") : NULL;
+    if (tracker == NULL) {
+        printf("FAILED - Could not open tracker\n");
+        remove("test_velocity.dat.velocity");
+        remove("test_velocity.dat.debits");
+        return 0;
+    }
+    
+    char detail[80];
+    long long start = 1000020;  // The start of a minute
+    for (int i = 0; i < 3; i++) {
+        correct = correct && velocity_check(tracker, 1, 1, 1000, start + 30, detail, sizeof(detail)) == COMMAND_OK;
+        velocity_record(tracker, 1, 1000, start + 30);
+    }
+    correct = correct && velocity_check(tracker, 1, 1, 1000, start + 30, detail, sizeof(detail)) == COMMAND_VELOCITY &&
+              velocity_check(tracker, 2, 1, 10000, start, detail, sizeof(detail)) == COMMAND_OK &&
+              velocity_check(tracker, 2, 1, 10001, start, detail, sizeof(detail)) == COMMAND_VELOCITY;
+    
+    // The debits count until their minute leaves the hour
+    correct = correct && velocity_check(tracker, 1, 1, 1000, start + 3599, detail, sizeof(detail)) == COMMAND_VELOCITY &&
+              velocity_check(tracker, 1, 1, 1000, start + 3600, detail, sizeof(detail)) == COMMAND_OK;
+    
+    // Amounts: $95.00 now and $4.00 half an hour later leave $1.00 until the first one expires
+    long long later = start + 3600;
+    velocity_record(tracker, 2, 9500, later);
+    velocity_record(tracker, 2, 400, later + 1800);
+    correct = correct && velocity_check(tracker, 2, 1, 101, later + 1800, detail, sizeof(detail)) == COMMAND_VELOCITY &&
+              velocity_check(tracker, 2, 1, 100, later + 1800, detail, sizeof(detail)) == COMMAND_OK &&
+              velocity_check(tracker, 2, 1, 9600, later + 3600, detail, sizeof(detail)) == COMMAND_OK &&
+              velocity_check(tracker, 2, 1, 9601, later + 3600, detail, sizeof(detail)) == COMMAND_VELOCITY;
+    
+    // A bucket reused an hour later starts empty
+    velocity_record(tracker, 1, 500, start + 3630);
+    correct = correct && velocity_check(tracker, 1, 2, 9500, start + 3630, detail, sizeof(detail)) == COMMAND_OK &&
+              velocity_check(tracker, 1, 2, 9501, start + 3630, detail, sizeof(detail)) == COMMAND_VELOCITY;
+    
+    // The debits are shared with every other tracker of the data file, in this process or another
+    struct velocity_tracker* other = velocity_tracker_open("test_velocity.dat");
+    correct = correct && other != NULL && other->shared != tracker->shared &&
+              velocity_check(other, 2, 1, 101, later + 1800, detail, sizeof(detail)) == COMMAND_VELOCITY &&
+              velocity_check(other, 2, 1, 100, later + 1800, detail, sizeof(detail)) == COMMAND_OK;
+    if (other != NULL) velocity_tracker_close(other);
+    velocity_tracker_close(tracker);
+    
+    // Sessions read the limits with the data file and check every debit
+    remove("test_velocity.dat.debits");
+    struct client_data accounts[3];
+    memset(accounts, 0, sizeof(accounts));
+    for (int i = 0; i < 3; i++) initialize_client(&accounts[i], i + 1, "Velocity", "Test", 1000.00);
+    if (!write_test_data_file("test_velocity.dat", accounts, 3)) {
+        printf("FAILED - Could not create data file\n");
+        remove("test_velocity.dat.velocity");
+        return 0;
+    }
+    
+    
+    struct {
+        const char* line;
+        int status;
+    } cases[] = {
+        {"update 1 -10.00", COMMAND_OK},
+        {"update 1 -10.00", COMMAND_OK},
+        {"update 1 +500.00", COMMAND_OK},
+        {"transfer 1 2 10.00", COMMAND_OK},
+        {"update 1 -10.00", COMMAND_VELOCITY},
+        {"transfer 1 3 1.00", COMMAND_VELOCITY},
+        {"transfer 2 3 60.00", COMMAND_OK},
+        {"transfer 2 3 50.00", COMMAND_VELOCITY},
+        {"update 2 -40.00", COMMAND_OK},
+        {"update 3 -100.01", COMMAND_VELOCITY},
+    };
+    FILE* output_ptr = tmpfile();
+    struct command_session session;
+    int opened = correct && output_ptr != NULL &&
+                 command_session_open(&session, "test_velocity.dat", "test_velocity_history.dat", output_ptr);
+    correct = correct && opened && session.velocity != NULL;
+    for (size_t i = 0; correct && i < sizeof(cases) / sizeof(cases[0]); i++) {
+        correct = execute_command_line(&session, cases[i].line, strlen(cases[i].line)) == cases[i].status;
+    }
+    correct = correct && session.velocity->refusals == 4;
+    if (opened) command_session_close(&session);
+    if (output_ptr != NULL) fclose(output_ptr);
+    
+    // Refused debits were not made
+    struct client_data client;
+    FILE* file_ptr = fopen("test_velocity.dat", "rb");
+    correct = correct && file_ptr != NULL && read_client_from_file(file_ptr, &client, 0) &&
+              balance_to_cents(client.balance) == 147000 && read_client_from_file(file_ptr, &client, 1) &&
+              balance_to_cents(client.balance) == 91000;
+    if (file_ptr != NULL) fclose(file_ptr);
+    
+    // Standing orders are checked against the same debits, made by the session that has closed:
+    // account 2 has no room left, and account 3's payment leaves it $95.00
+    long long now = (long long)time(NULL);
+    struct standing_order orders[] = {
+        {.from_acct = 2, .to_acct = 3, .cents = 100, .interval = 86400, .next_due = now, .remaining = 1},
+        {.from_acct = 3, .to_acct = 1, .cents = 500, .interval = 86400, .next_due = now, .remaining = 1},
+    };
+    struct order_summary summary;
+    correct = correct && add_standing_orders("test_velocity.dat", orders, 2) == 1 &&
+              run_standing_orders("test_velocity.dat", "test_velocity_history.dat", now, NULL, NULL, &summary) == 1 &&
+              summary.refused == 1;
+    tracker = velocity_tracker_open("test_velocity.dat");
+    correct = correct && tracker != NULL &&
+              velocity_check(tracker, 3, 1, 9500, velocity_now(), detail, sizeof(detail)) == COMMAND_OK &&
+              velocity_check(tracker, 3, 1, 9501, velocity_now(), detail, sizeof(detail)) == COMMAND_VELOCITY;
+    if (tracker != NULL) velocity_tracker_close(tracker);
+    
+    correct = correct && velocity_rules_write("test_velocity.dat", NULL) &&
+              !velocity_rules_read("test_velocity.dat", &read_back);
+    remove("test_velocity.dat");
+    remove("test_velocity.dat.debits");
+    remove("test_velocity.dat.orders");
+    remove("test_velocity_history.dat");
+    
+    if (!correct) {
+        printf("FAILED - Velocity limits were not enforced as expected\n");
+        return 0;
+    }
+    
+    printf("PASSED\n");
+    return 1;
+}
+
+void run_all_tests(void) {
+    int total_tests = 0;
+    int passed_tests = 0;
+    
+    total_tests++; passed_tests += test_crud_operations();
+    total_tests++; passed_tests += test_input_validation();
+    total_tests++; passed_tests += test_account_management();
+    total_tests++; passed_tests += test_statement_generation();
+    total_tests++; passed_tests += test_bulk_import();
+    total_tests++; passed_tests += test_store_builder();
+    total_tests++; passed_tests += test_name_normalization();
+    total_tests++; passed_tests += test_amount_parsing();
+    total_tests++; passed_tests += test_command_script();
+    total_tests++; passed_tests += test_ingest_pipeline();
+    total_tests++; passed_tests += test_work_pool();
+    total_tests++; passed_tests += test_hot_accounts();
+    total_tests++; passed_tests += test_optimistic_updates();
+    total_tests++; passed_tests += test_account_table();
+    total_tests++; passed_tests += test_shared_view();
+    total_tests++; passed_tests += test_async_client();
+    total_tests++; passed_tests += test_arena_allocator();
+    total_tests++; passed_tests += test_object_pools();
+    total_tests++; passed_tests += test_name_dictionary();
+    total_tests++; passed_tests += test_record_schema();
+    total_tests++; passed_tests += test_schema_evolution();
+    total_tests++; passed_tests += test_account_flags();
+    total_tests++; passed_tests += test_audit_trail();
+    total_tests++; passed_tests += test_interest_accrual();
+    total_tests++; passed_tests += test_overdraft_fees();
+    total_tests++; passed_tests += test_standing_orders();
+    total_tests++; passed_tests += test_velocity_checks();
+    
+    printf("\nTest Results: %d/%d tests passed\n", passed_tests, total_tests);
+    
+    if (passed_tests == total_tests) {
+        printf("✅ All CRUD tests passed! Ready for Version 04.\n");
+    } else {
+        printf("❌ Some tests failed. Review CRUD operations before proceeding.\n");
+    }
+}
+
+/*
+ * LEARNING EXERCISES FOR STUDENTS:
+ * 
+ * 1. Easy Level:
+ *    - Add a search function to find accounts by name
+ *    - Implement account number auto-generation
+ *    - Add input validation for minimum balance requirements
+ * 
+ * 2. Medium Level:
+ *    - Add transaction history logging
+ *    - Implement account transfer functionality
+ *    - Create batch operations (create multiple accounts from file)
+ * 
+ * 3. Advanced Level:
+ *    - Add account locking/unlocking features
+ *    - Implement data backup and restore
+ *    - Create audit trail for all operations
+ * 
+ * DEBUGGING TIPS:
+ * - Always validate input before processing
+ * - Check return values of all file operations
+ * - Use meaningful error messages for users
+ * - Test edge cases (empty names, zero balances, etc.)
+ * 
+ * NEXT VERSION PREVIEW:
+ * In Version 04, we'll learn:
+ * - Interactive menu systems
+ * - Program flow control
+ * - User experience design
+ * - Complete application integration
+ */
\ No newline at end of file